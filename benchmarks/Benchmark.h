@@ -0,0 +1,44 @@
+#ifndef INC_3DENGINE_BENCHMARK_H
+#define INC_3DENGINE_BENCHMARK_H
+
+#include <chrono>
+#include <cstdio>
+#include "Types.h"
+
+// Minimal timing helpers shared by the benchmark executables. Each kernel
+// runs once to warm up, then `runs` times; the fastest run is reported,
+// which is the least disturbed by the scheduler.
+
+// Stores a result where the optimizer can't prove it unused
+inline void Consume(float value) {
+    static volatile float sink;
+    sink = value;
+    (void)sink;
+}
+
+// Nanoseconds per item of the fastest run of function(), which processes
+// `items` items per call
+template<typename Function>
+double MeasureNanoseconds(uint64 items, Function function, uint32 runs = 7) {
+    function();
+    double best = 1e300;
+    for(uint32 run = 0; run < runs; run++) {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        best = elapsed < best ? elapsed : best;
+    }
+    return best / items;
+}
+
+// One result line, with the speedup over a baseline when there is one
+inline void PrintResult(const char *name, double nanoseconds, double baseline = 0.0) {
+    if(baseline > 0.0) {
+        printf("%-40s %10.2f ns %8.2fx\n", name, nanoseconds, baseline / nanoseconds);
+    } else {
+        printf("%-40s %10.2f ns\n", name, nanoseconds);
+    }
+}
+
+
+#endif //INC_3DENGINE_BENCHMARK_H
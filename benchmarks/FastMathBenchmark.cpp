@@ -0,0 +1,110 @@
+// FastMath.h against libm and the exact math3d.h paths: FastSinCos (scalar
+// and batched) against sinf/cosf, GetAxisAngleQuaternionFast against
+// GetAxisAngleQuaternion, and FastNormalize (single and batched) against
+// Vector3f::Normalize. Prints the largest error seen next to the
+// timings, so the documented bounds can be checked on the same data.
+
+#include <cstdlib>
+#include <vector>
+#include "Benchmark.h"
+#include "FastMath.h"
+
+const uint32 VALUE_COUNT = 65536;
+
+static float GetRandom(float low, float high) {
+    return low + rand() / (float)RAND_MAX * (high - low);
+}
+
+int main() {
+    srand(1);
+    std::vector<float> angles(VALUE_COUNT), sines(VALUE_COUNT), cosines(VALUE_COUNT);
+    for(uint32 i = 0; i < VALUE_COUNT; i++) {
+        angles[i] = GetRandom(-100.0f, 100.0f);
+    }
+
+    double libm = MeasureNanoseconds(VALUE_COUNT, [&] {
+        for(uint32 i = 0; i < VALUE_COUNT; i++) {
+            sines[i] = sinf(angles[i]);
+            cosines[i] = cosf(angles[i]);
+        }
+        Consume(sines[VALUE_COUNT - 1] + cosines[VALUE_COUNT - 1]);
+    });
+    PrintResult("sinf + cosf", libm);
+    PrintResult("FastSinCos", MeasureNanoseconds(VALUE_COUNT, [&] {
+        for(uint32 i = 0; i < VALUE_COUNT; i++) {
+            FastSinCos(angles[i], sines[i], cosines[i]);
+        }
+        Consume(sines[VALUE_COUNT - 1] + cosines[VALUE_COUNT - 1]);
+    }), libm);
+    PrintResult("FastSinCos batched", MeasureNanoseconds(VALUE_COUNT, [&] {
+        FastSinCos(angles.data(), sines.data(), cosines.data(), VALUE_COUNT);
+        Consume(sines[VALUE_COUNT - 1] + cosines[VALUE_COUNT - 1]);
+    }), libm);
+
+    double maxError = 0.0;
+    for(uint32 i = 0; i < VALUE_COUNT; i++) {
+        maxError = fmax(maxError, fabs(sines[i] - sin((double)angles[i])));
+        maxError = fmax(maxError, fabs(cosines[i] - cos((double)angles[i])));
+    }
+    printf("  max absolute error %.3g over [-100, 100]\n", maxError);
+
+    // The camera's per-frame rotations in main.cpp
+    std::vector<Quaternion> rotations(VALUE_COUNT);
+    double exactQuaternion = MeasureNanoseconds(VALUE_COUNT, [&] {
+        for(uint32 i = 0; i < VALUE_COUNT; i++) {
+            rotations[i] = GetAxisAngleQuaternion(Vector3f(0.0f, 1.0f, 0.0f), angles[i]);
+        }
+        Consume(rotations[VALUE_COUNT - 1].w);
+    });
+    PrintResult("GetAxisAngleQuaternion", exactQuaternion);
+    PrintResult("GetAxisAngleQuaternionFast", MeasureNanoseconds(VALUE_COUNT, [&] {
+        for(uint32 i = 0; i < VALUE_COUNT; i++) {
+            rotations[i] = GetAxisAngleQuaternionFast(Vector3f(0.0f, 1.0f, 0.0f), angles[i]);
+        }
+        Consume(rotations[VALUE_COUNT - 1].w);
+    }), exactQuaternion);
+
+    std::vector<Vector3f> vectors(VALUE_COUNT), normalized(VALUE_COUNT);
+    Vector3fStream stream;
+    stream.Resize(VALUE_COUNT);
+    for(uint32 i = 0; i < VALUE_COUNT; i++) {
+        vectors[i] = Vector3f(GetRandom(-10.0f, 10.0f), GetRandom(-10.0f, 10.0f), GetRandom(-10.0f, 10.0f));
+    }
+
+    double exact = MeasureNanoseconds(VALUE_COUNT, [&] {
+        for(uint32 i = 0; i < VALUE_COUNT; i++) {
+            normalized[i] = vectors[i].Normalize();
+        }
+        Consume(normalized[VALUE_COUNT - 1].x);
+    });
+    PrintResult("Vector3f::Normalize", exact);
+    PrintResult("FastNormalize", MeasureNanoseconds(VALUE_COUNT, [&] {
+        for(uint32 i = 0; i < VALUE_COUNT; i++) {
+            normalized[i] = FastNormalize(vectors[i]);
+        }
+        Consume(normalized[VALUE_COUNT - 1].x);
+    }), exact);
+    // Works in place, so after the first run it renormalizes unit vectors,
+    // which costs the same
+    for(uint32 i = 0; i < VALUE_COUNT; i++) {
+        stream.Set(i, vectors[i]);
+    }
+    PrintResult("FastNormalize batched", MeasureNanoseconds(VALUE_COUNT, [&] {
+        FastNormalize(stream.View(), stream.Size());
+        Consume(stream.x[VALUE_COUNT - 1]);
+    }), exact);
+
+    for(uint32 i = 0; i < VALUE_COUNT; i++) {
+        stream.Set(i, vectors[i]);
+    }
+    FastNormalize(stream.View(), stream.Size());
+    maxError = 0.0;
+    for(uint32 i = 0; i < VALUE_COUNT; i++) {
+        double length = sqrt((double)stream.x[i] * stream.x[i] + (double)stream.y[i] * stream.y[i] +
+                             (double)stream.z[i] * stream.z[i]);
+        maxError = fmax(maxError, fabs(length - 1.0));
+    }
+    printf("  max length error %.3g\n", maxError);
+
+    return 0;
+}
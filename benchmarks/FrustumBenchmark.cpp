@@ -0,0 +1,72 @@
+// Frustum::CullBoxes and CullSpheres against a scalar loop over the same
+// streams (IsBoxVisible / IsSphereVisible per entry), on 1M random bounds
+// scattered around a camera. Both sides write the compacted index list.
+
+#include <cstdlib>
+#include <vector>
+#include "Benchmark.h"
+#include "Frustum.h"
+
+const uint32 BOUNDS_COUNT = 1000000;
+
+static float GetRandom(float low, float high) {
+    return low + rand() / (float)RAND_MAX * (high - low);
+}
+
+int main() {
+    srand(1);
+    BoundingBoxStream boxes;
+    BoundingSphereStream spheres;
+    boxes.Resize(BOUNDS_COUNT);
+    spheres.Resize(BOUNDS_COUNT);
+    for(uint32 i = 0; i < BOUNDS_COUNT; i++) {
+        Vector3f center(GetRandom(-200.0f, 200.0f), GetRandom(-50.0f, 50.0f), GetRandom(-200.0f, 200.0f));
+        Vector3f extent(GetRandom(0.1f, 4.0f), GetRandom(0.1f, 4.0f), GetRandom(0.1f, 4.0f));
+        boxes.Set(i, center - extent, center + extent);
+        spheres.Set(i, center, GetRandom(0.1f, 4.0f));
+    }
+
+    Matrix4f projection = GetPerspectiveProjectionMatrix(16.0f / 9.0f, ToRadian(60.0f), 0.1f, 150.0f);
+    Matrix4f view = GetCameraTransformationMatrix(Vector3f(0.0f, 0.0f, 0.0f), Vector3f(0.3f, 0.0f, 1.0f), Vector3f(0.0f, 1.0f, 0.0f));
+    Frustum frustum;
+    frustum.Extract(projection * view);
+
+    std::vector<uint32> visibleIndices(BOUNDS_COUNT);
+    size_t scalarVisible = 0, simdVisible = 0;
+
+    double scalar = MeasureNanoseconds(BOUNDS_COUNT, [&] {
+        scalarVisible = 0;
+        for(uint32 i = 0; i < BOUNDS_COUNT; i++) {
+            if(frustum.IsBoxVisible(Vector3f(boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i]),
+                                    Vector3f(boxes.extentX[i], boxes.extentY[i], boxes.extentZ[i]))) {
+                visibleIndices[scalarVisible++] = i;
+            }
+        }
+        Consume((float)scalarVisible);
+    });
+    PrintResult("Boxes, scalar loop", scalar);
+    PrintResult("Frustum::CullBoxes", MeasureNanoseconds(BOUNDS_COUNT, [&] {
+        simdVisible = frustum.CullBoxes(boxes, visibleIndices.data());
+        Consume((float)simdVisible);
+    }), scalar);
+    printf("  %zu of %u boxes visible (scalar %zu)\n", simdVisible, BOUNDS_COUNT, scalarVisible);
+
+    scalar = MeasureNanoseconds(BOUNDS_COUNT, [&] {
+        scalarVisible = 0;
+        for(uint32 i = 0; i < BOUNDS_COUNT; i++) {
+            if(frustum.IsSphereVisible(Vector3f(spheres.centerX[i], spheres.centerY[i], spheres.centerZ[i]),
+                                       spheres.radius[i])) {
+                visibleIndices[scalarVisible++] = i;
+            }
+        }
+        Consume((float)scalarVisible);
+    });
+    PrintResult("Spheres, scalar loop", scalar);
+    PrintResult("Frustum::CullSpheres", MeasureNanoseconds(BOUNDS_COUNT, [&] {
+        simdVisible = frustum.CullSpheres(spheres, visibleIndices.data());
+        Consume((float)simdVisible);
+    }), scalar);
+    printf("  %zu of %u spheres visible (scalar %zu)\n", simdVisible, BOUNDS_COUNT, scalarVisible);
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+// Matrix4f kernels of math3d.h against their scalar references, then the
+// engine's per-frame transform workloads. Built once per ENGINE_MATH_BACKEND
+// (MathBenchmark_SIMD, _SCALAR, _GLM) to compare backends side by side.
+// Works on arrays of random matrices sized like a frame's worth of model
+// matrices, so the numbers include loads and stores and not just register
+// math.
+
+#include <cstdlib>
+#include <vector>
+#include "Benchmark.h"
+#include "math3d.h"
+
+const uint32 MATRIX_COUNT = 4096;
+const uint32 POINT_COUNT = 65536;
+
+static Matrix4f GetRandomMatrix() {
+    Matrix4f mat;
+    for(uint32 i = 0; i < 4; i++) {
+        for(uint32 j = 0; j < 4; j++) {
+            mat.m[i][j] = rand() / (float)RAND_MAX * 2.0f - 1.0f;
+        }
+        // Diagonally dominant, so every matrix is invertible
+        mat.m[i][i] += 4.0f;
+    }
+    return mat;
+}
+
+int main() {
+    srand(1);
+    std::vector<Matrix4f> left(MATRIX_COUNT), right(MATRIX_COUNT), out(MATRIX_COUNT);
+    std::vector<Vector4f> vectors(MATRIX_COUNT), transformed(MATRIX_COUNT);
+    for(uint32 i = 0; i < MATRIX_COUNT; i++) {
+        left[i] = GetRandomMatrix();
+        right[i] = GetRandomMatrix();
+        vectors[i] = Vector4f(rand() / (float)RAND_MAX, rand() / (float)RAND_MAX, rand() / (float)RAND_MAX, 1.0f);
+    }
+
+#if defined(ENGINE_MATH_GLM)
+    printf("Backend: GLM\n");
+#elif defined(MATH3D_AVX)
+    printf("Backend: SIMD (AVX)\n");
+#elif defined(MATH3D_SSE)
+    printf("Backend: SIMD (SSE)\n");
+#else
+    printf("Backend: SCALAR\n");
+#endif
+
+    double scalar = MeasureNanoseconds(MATRIX_COUNT, [&] {
+        for(uint32 i = 0; i < MATRIX_COUNT; i++) {
+            MultiplyMatrix4fScalar(left[i], right[i], out[i]);
+        }
+        Consume(out[MATRIX_COUNT - 1].m[3][3]);
+    });
+    PrintResult("MultiplyMatrix4fScalar", scalar);
+    PrintResult("MultiplyMatrix4f", MeasureNanoseconds(MATRIX_COUNT, [&] {
+        for(uint32 i = 0; i < MATRIX_COUNT; i++) {
+            MultiplyMatrix4f(left[i], right[i], out[i]);
+        }
+        Consume(out[MATRIX_COUNT - 1].m[3][3]);
+    }), scalar);
+
+    scalar = MeasureNanoseconds(MATRIX_COUNT, [&] {
+        for(uint32 i = 0; i < MATRIX_COUNT; i++) {
+            transformed[i] = TransformVector4fScalar(left[i], vectors[i]);
+        }
+        Consume(transformed[MATRIX_COUNT - 1].w);
+    });
+    PrintResult("TransformVector4fScalar", scalar);
+    PrintResult("TransformVector4f", MeasureNanoseconds(MATRIX_COUNT, [&] {
+        for(uint32 i = 0; i < MATRIX_COUNT; i++) {
+            transformed[i] = TransformVector4f(left[i], vectors[i]);
+        }
+        Consume(transformed[MATRIX_COUNT - 1].w);
+    }), scalar);
+
+    scalar = MeasureNanoseconds(MATRIX_COUNT, [&] {
+        for(uint32 i = 0; i < MATRIX_COUNT; i++) {
+            InverseMatrix4fScalar(left[i], out[i]);
+        }
+        Consume(out[MATRIX_COUNT - 1].m[3][3]);
+    });
+    PrintResult("InverseMatrix4fScalar", scalar);
+    PrintResult("InverseMatrix4f", MeasureNanoseconds(MATRIX_COUNT, [&] {
+        for(uint32 i = 0; i < MATRIX_COUNT; i++) {
+            InverseMatrix4f(left[i], out[i]);
+        }
+        Consume(out[MATRIX_COUNT - 1].m[3][3]);
+    }), scalar);
+
+    // Workloads: model-view-projection per object, full and affine models,
+    // and a vertex stream through one matrix
+    Matrix4f viewProjection = GetRandomMatrix();
+    std::vector<Matrix3x4> models(MATRIX_COUNT);
+    for(uint32 i = 0; i < MATRIX_COUNT; i++) {
+        models[i] = GetMatrix3x4(right[i]);
+    }
+    PrintResult("Object MVP, Matrix4f model", MeasureNanoseconds(MATRIX_COUNT, [&] {
+        for(uint32 i = 0; i < MATRIX_COUNT; i++) {
+            out[i] = viewProjection * right[i];
+        }
+        Consume(out[MATRIX_COUNT - 1].m[3][3]);
+    }));
+    PrintResult("Object MVP, Matrix3x4 model", MeasureNanoseconds(MATRIX_COUNT, [&] {
+        for(uint32 i = 0; i < MATRIX_COUNT; i++) {
+            out[i] = viewProjection * models[i];
+        }
+        Consume(out[MATRIX_COUNT - 1].m[3][3]);
+    }));
+
+    Vector3fStream points;
+    points.Resize(POINT_COUNT);
+    for(uint32 i = 0; i < POINT_COUNT; i++) {
+        points.Set(i, Vector3f(rand() / (float)RAND_MAX, rand() / (float)RAND_MAX, rand() / (float)RAND_MAX));
+    }
+    Vector3fStream transformedPoints = points;
+    PrintResult("TransformPoint per point", MeasureNanoseconds(POINT_COUNT, [&] {
+        for(uint32 i = 0; i < POINT_COUNT; i++) {
+            transformedPoints.Set(i, TransformPoint(viewProjection, points.Get(i)));
+        }
+        Consume(transformedPoints.x[POINT_COUNT - 1]);
+    }));
+    PrintResult("TransformPoints batched", MeasureNanoseconds(POINT_COUNT, [&] {
+        TransformPoints(viewProjection, points.View(), transformedPoints.View(), points.Size());
+        Consume(transformedPoints.x[POINT_COUNT - 1]);
+    }));
+
+    // Quaternion products, one at a time and batched
+    std::vector<Quaternion> leftQ(MATRIX_COUNT), rightQ(MATRIX_COUNT), outQ(MATRIX_COUNT);
+    for(uint32 i = 0; i < MATRIX_COUNT; i++) {
+        leftQ[i] = GetEulerQuaternion(rand() % 360, rand() % 360, rand() % 360);
+        rightQ[i] = GetEulerQuaternion(rand() % 360, rand() % 360, rand() % 360);
+    }
+    double single = MeasureNanoseconds(MATRIX_COUNT, [&] {
+        for(uint32 i = 0; i < MATRIX_COUNT; i++) {
+            outQ[i] = leftQ[i] * rightQ[i];
+        }
+        Consume(outQ[MATRIX_COUNT - 1].w);
+    });
+    PrintResult("Quaternion product", single);
+    PrintResult("ComposeQuaternions batched", MeasureNanoseconds(MATRIX_COUNT, [&] {
+        ComposeQuaternions(leftQ.data(), rightQ.data(), outQ.data(), MATRIX_COUNT);
+        Consume(outQ[MATRIX_COUNT - 1].w);
+    }), single);
+
+    return 0;
+}
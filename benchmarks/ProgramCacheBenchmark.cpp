@@ -0,0 +1,117 @@
+// Startup cost of many programs on a real GL context: a cold start against
+// an empty ProgramBinaryCache directory, which compiles, links and saves
+// every program, then a warm start that loads them all back from disk.
+// Driver-side shader caches speed up the cold start after the first launch,
+// run with MESA_SHADER_CACHE_DISABLE=true or __GL_SHADER_DISK_CACHE=0 to
+// keep them out. Needs a display or an EGL capable SDL video driver.
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <SDL.h>
+#include "Benchmark.h"
+#include "GLExtensions.h"
+#include "Shader.h"
+#include "ProgramBinaryCache.h"
+
+const uint32 PROGRAM_COUNT = 200;
+const char *CACHE_DIRECTORY = "ProgramCacheBenchmark.cache";
+
+static const char *vertexShader = R"(
+#version 330
+layout (location = 0) in vec3 Position;
+layout (location = 1) in vec2 TexCoord;
+uniform mat4 modelViewProjection;
+out vec2 TexCoord0;
+void main()
+{
+    gl_Position = modelViewProjection * vec4(Position, 1.0);
+    TexCoord0 = TexCoord;
+}
+)";
+
+// Each variant is a different program as far as the driver is concerned
+static std::string GetFragmentShader(uint32 variant) {
+    return "#version 330\n"
+           "in vec2 TexCoord0;\n"
+           "out vec4 FragColor;\n"
+           "uniform sampler2D gSampler;\n"
+           "void main()\n"
+           "{\n"
+           "    vec4 color = vec4(0.0);\n"
+           "    for(int i = 0; i < " + std::to_string(variant % 16 + 1) + "; i++) {\n"
+           "        color += texture(gSampler, TexCoord0 * float(i + " + std::to_string(variant) + "));\n"
+           "    }\n"
+           "    FragColor = color;\n"
+           "}\n";
+}
+
+// Nanoseconds per program to create and finish all of them
+static double BuildPrograms(ProgramBinaryCache& cache) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::unique_ptr<Shader>> shaders;
+    for(uint32 i = 0; i < PROGRAM_COUNT; i++) {
+        shaders.emplace_back(new Shader(vertexShader, GetFragmentShader(i).c_str(), &cache));
+    }
+    for(const auto& shader : shaders) {
+        shader->Finalize();
+    }
+    glFinish();
+    double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return elapsed / PROGRAM_COUNT;
+}
+
+static void RemoveCacheEntries(ProgramBinaryCache& cache) {
+    for(uint32 i = 0; i < PROGRAM_COUNT; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "%016llx.bin", cache.GetKey(vertexShader, GetFragmentShader(i).c_str()));
+        remove((std::string(CACHE_DIRECTORY) + "/" + name).c_str());
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if(SDL_Init(SDL_INIT_VIDEO) < 0) {
+        printf("Error initializing SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+    SDL_Window *window = SDL_CreateWindow("ProgramCacheBenchmark", 0, 0, 64, 64, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+    SDL_GLContext context = window ? SDL_GL_CreateContext(window) : nullptr;
+    if(!context) {
+        printf("Error creating OpenGL context: %s\n", SDL_GetError());
+        return 1;
+    }
+    gladLoadGLLoader((GLADloadproc)SDL_GL_GetProcAddress);
+    LoadGLExtensions((GLADloadproc)SDL_GL_GetProcAddress);
+    printf("GL renderer: %s\n", glGetString(GL_RENDERER));
+
+    double cold, warm;
+    {
+        ProgramBinaryCache cache(CACHE_DIRECTORY);
+        if(!cache.IsSupported()) {
+            printf("No program binary formats, nothing to measure\n");
+            return 1;
+        }
+        RemoveCacheEntries(cache);
+        cold = BuildPrograms(cache);
+        cache.PrintStats();
+    }
+    {
+        // A fresh cache object, as on the next launch
+        ProgramBinaryCache cache(CACHE_DIRECTORY);
+        warm = BuildPrograms(cache);
+        cache.PrintStats();
+        RemoveCacheEntries(cache);
+    }
+
+    printf("%u programs, per program:\n", PROGRAM_COUNT);
+    PrintResult("Cold start, compile and save", cold);
+    PrintResult("Warm start, load binaries", warm, cold);
+
+    SDL_GL_DeleteContext(context);
+    SDL_Quit();
+    return 0;
+}
@@ -0,0 +1,130 @@
+// Cost of setting a draw's worth of uniforms on a real GL context: a
+// glGetUniformLocation per call (what the engine did before the uniform
+// table), Shader's name overloads, interning the name on every call, and
+// cached UniformHandles. Values change every draw so the redundant upload
+// filter stays out of the way, except in the last line which measures it.
+// Needs a display or an EGL capable SDL video driver.
+
+#include <SDL.h>
+#include "Benchmark.h"
+#include "GLExtensions.h"
+#include "Shader.h"
+
+const uint32 DRAW_COUNT = 10000;
+const uint32 UNIFORM_COUNT = 8;
+
+static const char *vertexShader = R"(
+#version 330
+layout (location = 0) in vec3 Position;
+uniform mat4 modelViewProjection;
+void main()
+{
+    gl_Position = modelViewProjection * vec4(Position, 1.0);
+}
+)";
+
+static const char *fragmentShader = R"(
+#version 330
+uniform vec4 color0;
+uniform vec4 color1;
+uniform vec4 color2;
+uniform vec4 color3;
+uniform vec4 color4;
+uniform vec4 color5;
+uniform vec4 color6;
+out vec4 FragColor;
+void main()
+{
+    FragColor = color0 + color1 + color2 + color3 + color4 + color5 + color6;
+}
+)";
+
+static const char *uniformNames[UNIFORM_COUNT] = {
+    "modelViewProjection", "color0", "color1", "color2", "color3", "color4", "color5", "color6"
+};
+
+int main(int argc, char *argv[]) {
+    if(SDL_Init(SDL_INIT_VIDEO) < 0) {
+        printf("Error initializing SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
+    SDL_Window *window = SDL_CreateWindow("UniformBenchmark", 0, 0, 64, 64, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+    SDL_GLContext context = window ? SDL_GL_CreateContext(window) : nullptr;
+    if(!context) {
+        printf("Error creating OpenGL context: %s\n", SDL_GetError());
+        return 1;
+    }
+    gladLoadGLLoader((GLADloadproc)SDL_GL_GetProcAddress);
+    LoadGLExtensions((GLADloadproc)SDL_GL_GetProcAddress);
+    printf("GL renderer: %s\n", glGetString(GL_RENDERER));
+
+    Shader shader(vertexShader, fragmentShader);
+    shader.UseShader();
+    UniformHandle handles[UNIFORM_COUNT];
+    for(uint32 i = 0; i < UNIFORM_COUNT; i++) {
+        handles[i] = shader.GetUniform(uniformNames[i]);
+    }
+
+    // Per draw: the matrix, then the colors
+    float frame = 0.0f;
+    double locations = MeasureNanoseconds(DRAW_COUNT, [&] {
+        for(uint32 draw = 0; draw < DRAW_COUNT; draw++) {
+            Matrix4f mvp = GetTranslationMatrix(frame++, 0.0f, 0.0f);
+            glUniformMatrix4fv(glGetUniformLocation(shader.ID, uniformNames[0]), 1, GL_TRUE, &mvp.m[0][0]);
+            for(uint32 i = 1; i < UNIFORM_COUNT; i++) {
+                Vector4f color(frame, (float)i, 0.0f, 1.0f);
+                glUniform4fv(glGetUniformLocation(shader.ID, uniformNames[i]), 1, &color.x);
+            }
+        }
+        glFinish();
+    });
+    PrintResult("glGetUniformLocation per call", locations);
+
+    PrintResult("InternString per call", MeasureNanoseconds(DRAW_COUNT, [&] {
+        for(uint32 draw = 0; draw < DRAW_COUNT; draw++) {
+            shader.SetMatrix4f(shader.GetUniform(InternString(uniformNames[0])), GetTranslationMatrix(frame++, 0.0f, 0.0f));
+            for(uint32 i = 1; i < UNIFORM_COUNT; i++) {
+                shader.SetVector4f(shader.GetUniform(InternString(uniformNames[i])), Vector4f(frame, (float)i, 0.0f, 1.0f));
+            }
+        }
+        glFinish();
+    }), locations);
+
+    PrintResult("Shader name overloads", MeasureNanoseconds(DRAW_COUNT, [&] {
+        for(uint32 draw = 0; draw < DRAW_COUNT; draw++) {
+            shader.SetMatrix4f(uniformNames[0], GetTranslationMatrix(frame++, 0.0f, 0.0f));
+            for(uint32 i = 1; i < UNIFORM_COUNT; i++) {
+                shader.SetVector4f(uniformNames[i], Vector4f(frame, (float)i, 0.0f, 1.0f));
+            }
+        }
+        glFinish();
+    }), locations);
+
+    PrintResult("Cached UniformHandles", MeasureNanoseconds(DRAW_COUNT, [&] {
+        for(uint32 draw = 0; draw < DRAW_COUNT; draw++) {
+            shader.SetMatrix4f(handles[0], GetTranslationMatrix(frame++, 0.0f, 0.0f));
+            for(uint32 i = 1; i < UNIFORM_COUNT; i++) {
+                shader.SetVector4f(handles[i], Vector4f(frame, (float)i, 0.0f, 1.0f));
+            }
+        }
+        glFinish();
+    }), locations);
+
+    PrintResult("Cached UniformHandles, unchanged", MeasureNanoseconds(DRAW_COUNT, [&] {
+        for(uint32 draw = 0; draw < DRAW_COUNT; draw++) {
+            shader.SetMatrix4f(handles[0], GetIdentityMatrix4f());
+            for(uint32 i = 1; i < UNIFORM_COUNT; i++) {
+                shader.SetVector4f(handles[i], Vector4f(1.0f, (float)i, 0.0f, 1.0f));
+            }
+        }
+        glFinish();
+    }), locations);
+
+    SDL_GL_DeleteContext(context);
+    SDL_Quit();
+    return 0;
+}
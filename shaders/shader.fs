@@ -2,11 +2,11 @@
 
 in vec2 TexCoord0;
 
-out vec4 FragColor;
+layout (location = 0) out vec4 FragColor;
 
 uniform sampler2D gSampler;
 
 void main()
 {
-    FragColor = texture2D(gSampler, TexCoord0.st);
+    FragColor = texture(gSampler, TexCoord0.st);
 }
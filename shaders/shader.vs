@@ -5,10 +5,25 @@ layout (location = 1) in vec2 TexCoord;
 
 out vec2 TexCoord0;
 
-uniform mat4 worldMat;
+// Must match PerFrameData / PerObjectData in UniformBuffer.h
+layout (std140, row_major) uniform PerFrame
+{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    vec4 cameraPos;
+    float time;
+    float deltaTime;
+};
+
+layout (std140, row_major) uniform PerObject
+{
+    mat4 model;
+    mat4 modelViewProjection;
+};
 
 void main()
 {
-    gl_Position = worldMat * vec4(Position, 1.0);
+    gl_Position = modelViewProjection * vec4(Position, 1.0);
     TexCoord0 = TexCoord;
 }
\ No newline at end of file
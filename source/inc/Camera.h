@@ -0,0 +1,70 @@
+#ifndef INC_3DENGINE_CAMERA_H
+#define INC_3DENGINE_CAMERA_H
+
+#include "Types.h"
+#include "math3d.h"
+
+// Caches the projection and view matrices and only rebuilds them when one of
+// their inputs actually changed. Setters can be called every frame.
+class Camera {
+public:
+    Camera();
+
+    // fov is in radians
+    void SetPerspective(float aspectRatio, float fov, float nearZ, float farZ);
+    void SetAspectRatio(float aspectRatio);
+    // Switches to an infinite far plane with reversed depth, farZ is then
+    // ignored. The caller owns the matching GL state (clear depth 0,
+    // GL_GREATER and, when zeroToOneClip is set, glClipControl).
+    void SetReverseZ(bool enabled, bool zeroToOneClip);
+    void SetPosition(const Vector3f& pos);
+    // target is the viewing direction, see GetCameraTransformationMatrix
+    void SetOrientation(const Vector3f& target, const Vector3f& up);
+
+    const Vector3f& GetPosition() const { return pos; }
+    const Vector3f& GetTarget() const { return target; }
+    const Vector3f& GetUp() const { return up; }
+    bool IsReverseZ() const { return reverseZ; }
+
+    const Matrix4f& GetProjectionMatrix();
+    const Matrix4f& GetViewMatrix();
+    const Matrix4f& GetViewProjectionMatrix();
+    const Matrix4f& GetInverseProjectionMatrix();
+    const Matrix4f& GetInverseViewMatrix();
+    const Matrix4f& GetInverseViewProjectionMatrix();
+
+    // Incremented whenever any camera parameter changes. Dependent systems
+    // (culling, shadow cascades) store it and skip work while it is unchanged.
+    uint32 GetVersion() const { return version; }
+    // How many times the matrices were rebuilt, at most once per version
+    uint32 GetMatrixUpdates() const { return matrixUpdates; }
+
+private:
+    void UpdateMatrices();
+
+    float aspectRatio;
+    float fov;
+    float nearZ;
+    float farZ;
+    bool reverseZ;
+    bool zeroToOneClip;
+
+    Vector3f pos;
+    Vector3f target;
+    Vector3f up;
+
+    Matrix4f projectionMat;
+    Matrix4f viewMat;
+    Matrix4f viewProjectionMat;
+    Matrix4f invProjectionMat;
+    Matrix4f invViewMat;
+    Matrix4f invViewProjectionMat;
+
+    bool projectionDirty;
+    bool viewDirty;
+    uint32 version;
+    uint32 matrixUpdates;
+};
+
+
+#endif //INC_3DENGINE_CAMERA_H
@@ -0,0 +1,242 @@
+#ifndef INC_3DENGINE_FASTMATH_H
+#define INC_3DENGINE_FASTMATH_H
+
+// Opt-in approximations for hot paths. Everything here trades a bounded,
+// documented error for speed; use the math3d.h / libm versions when exact
+// results matter. Error bounds were measured over the stated input ranges,
+// tests/FastMathTests.cpp holds every backend to them.
+
+#include "Types.h"
+#include "math3d.h"
+
+// 1/sqrt(x) for x > 0. Hardware estimate (12 bits) refined by one
+// Newton-Raphson step: max relative error 2.5e-7 on SSE. The scalar path
+// is 1.0f / sqrtf(x), within the two float roundings (~1.2e-7).
+inline float FastRsqrt(float x)
+{
+#if defined(MATH3D_SSE)
+    __m128 v = _mm_set_ss(x);
+    __m128 y = _mm_rsqrt_ss(v);
+    // y * (1.5 - 0.5 * x * y * y)
+    __m128 yy = _mm_mul_ss(y, y);
+    y = _mm_mul_ss(y, _mm_sub_ss(_mm_set_ss(1.5f), _mm_mul_ss(_mm_mul_ss(_mm_set_ss(0.5f), v), yy)));
+    return _mm_cvtss_f32(y);
+#else
+    return 1.0f / sqrtf(x);
+#endif
+}
+
+// Same contract as Vector3f::Normalize, a zero vector stays zero. The
+// result's length is within 4e-7 of 1.
+inline Vector3f FastNormalize(const Vector3f& v)
+{
+    float lengthSq = v.x*v.x + v.y*v.y + v.z*v.z;
+    if(lengthSq == 0) {
+        return Vector3f();
+    }
+
+    return v * FastRsqrt(lengthSq);
+}
+
+// Normalizes a position stream in place, 4 vectors per iteration.
+inline void FastNormalize(const Vector3fSoA& v, size_t count)
+{
+    size_t i = 0;
+#if defined(MATH3D_SSE)
+    __m128 half = _mm_set1_ps(0.5f);
+    __m128 threeHalves = _mm_set1_ps(1.5f);
+    __m128 zero = _mm_setzero_ps();
+
+    for(; i+4 <= count; i+=4) {
+        __m128 x = _mm_loadu_ps(v.x + i);
+        __m128 y = _mm_loadu_ps(v.y + i);
+        __m128 z = _mm_loadu_ps(v.z + i);
+
+        __m128 lengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+        __m128 r = _mm_rsqrt_ps(lengthSq);
+        r = _mm_mul_ps(r, _mm_sub_ps(threeHalves, _mm_mul_ps(_mm_mul_ps(half, lengthSq), _mm_mul_ps(r, r))));
+        // Zero length gives inf * 0 = NaN, keep those vectors at zero
+        r = _mm_and_ps(r, _mm_cmpneq_ps(lengthSq, zero));
+
+        _mm_storeu_ps(v.x + i, _mm_mul_ps(x, r));
+        _mm_storeu_ps(v.y + i, _mm_mul_ps(y, r));
+        _mm_storeu_ps(v.z + i, _mm_mul_ps(z, r));
+    }
+#endif
+    for(; i < count; ++i) {
+        Vector3f n = FastNormalize(Vector3f(v.x[i], v.y[i], v.z[i]));
+        v.x[i] = n.x;
+        v.y[i] = n.y;
+        v.z[i] = n.z;
+    }
+}
+
+// Cody-Waite split of pi/2 for the range reduction
+#define FASTMATH_PIO2_HI 1.5703125f
+#define FASTMATH_PIO2_MID 4.837512969970703125e-4f
+#define FASTMATH_PIO2_LO 7.54978995489188216e-8f
+#define FASTMATH_2_OVER_PI 0.636619772367581343f
+
+// Minimax polynomials (Cephes) on [-pi/4, pi/4]
+constexpr float FastSinPoly(float r, float r2)
+{
+    return r + r*r2*(-1.6666654611e-1f + r2*(8.3321608736e-3f + r2*(-1.9515295891e-4f)));
+}
+
+constexpr float FastCosPoly(float r2)
+{
+    return 1.0f - 0.5f*r2 + r2*r2*(4.166664568298827e-2f + r2*(-1.388731625493765e-3f + r2*2.443315711809948e-5f));
+}
+
+// Nearest integer, halves away from zero on the scalar path. A plain
+// conversion instead of floorf, which is a libm call without SSE4.1.
+inline int FastRoundToInt(float x)
+{
+#if defined(MATH3D_SSE)
+    return _mm_cvtss_si32(_mm_set_ss(x));
+#else
+    return (int)(x < 0.0f ? x - 0.5f : x + 0.5f);
+#endif
+}
+
+// sin and cos of x (radians) in one go. Max absolute error 2e-7 for
+// |x| <= 8192, accuracy degrades beyond that as the reduction loses bits.
+inline void FastSinCos(float x, float& outSin, float& outCos)
+{
+    // Quadrant and remainder in [-pi/4, pi/4]
+    int j = FastRoundToInt(x * FASTMATH_2_OVER_PI);
+    float fj = (float)j;
+    float r = ((x - fj*FASTMATH_PIO2_HI) - fj*FASTMATH_PIO2_MID) - fj*FASTMATH_PIO2_LO;
+    float r2 = r*r;
+
+    float s = FastSinPoly(r, r2);
+    float c = FastCosPoly(r2);
+
+    // Odd quadrants swap sin and cos, the quadrant bits then pick the
+    // signs. Done on the bits, a switch mispredicts on varied angles.
+    uint32 sBits, cBits;
+    memcpy(&sBits, &s, sizeof(s));
+    memcpy(&cBits, &c, sizeof(c));
+    uint32 swap = 0u - (uint32)(j & 1);
+    uint32 sinBits = ((cBits & swap) | (sBits & ~swap)) ^ ((uint32)(j & 2) << 30);
+    uint32 cosBits = ((sBits & swap) | (cBits & ~swap)) ^ ((uint32)((j + 1) & 2) << 30);
+    memcpy(&outSin, &sinBits, sizeof(outSin));
+    memcpy(&outCos, &cosBits, sizeof(outCos));
+}
+
+inline float FastSin(float x)
+{
+    float s, c;
+    FastSinCos(x, s, c);
+    return s;
+}
+
+inline float FastCos(float x)
+{
+    float s, c;
+    FastSinCos(x, s, c);
+    return c;
+}
+
+// Batched FastSinCos, same error bound, 4 angles per iteration.
+inline void FastSinCos(const float* x, float* outSin, float* outCos, size_t count)
+{
+    size_t i = 0;
+#if defined(MATH3D_SSE)
+    for(; i+4 <= count; i+=4) {
+        __m128 v = _mm_loadu_ps(x + i);
+
+        // Round to nearest quadrant, the default MXCSR mode
+        __m128i ji = _mm_cvtps_epi32(_mm_mul_ps(v, _mm_set1_ps(FASTMATH_2_OVER_PI)));
+        __m128 j = _mm_cvtepi32_ps(ji);
+        __m128 r = _mm_sub_ps(v, _mm_mul_ps(j, _mm_set1_ps(FASTMATH_PIO2_HI)));
+        r = _mm_sub_ps(r, _mm_mul_ps(j, _mm_set1_ps(FASTMATH_PIO2_MID)));
+        r = _mm_sub_ps(r, _mm_mul_ps(j, _mm_set1_ps(FASTMATH_PIO2_LO)));
+        __m128 r2 = _mm_mul_ps(r, r);
+
+        __m128 s = _mm_add_ps(_mm_set1_ps(8.3321608736e-3f), _mm_mul_ps(r2, _mm_set1_ps(-1.9515295891e-4f)));
+        s = _mm_add_ps(_mm_set1_ps(-1.6666654611e-1f), _mm_mul_ps(r2, s));
+        s = _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), s));
+
+        __m128 c = _mm_add_ps(_mm_set1_ps(-1.388731625493765e-3f), _mm_mul_ps(r2, _mm_set1_ps(2.443315711809948e-5f)));
+        c = _mm_add_ps(_mm_set1_ps(4.166664568298827e-2f), _mm_mul_ps(r2, c));
+        c = _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(_mm_set1_ps(0.5f), r2)), _mm_mul_ps(_mm_mul_ps(r2, r2), c));
+
+        // Odd quadrants swap sin and cos, the quadrant bits then pick the signs
+        __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(ji, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+        __m128 sinRes = _mm_or_ps(_mm_and_ps(swap, c), _mm_andnot_ps(swap, s));
+        __m128 cosRes = _mm_or_ps(_mm_and_ps(swap, s), _mm_andnot_ps(swap, c));
+
+        __m128 sinSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(ji, _mm_set1_epi32(2)), 30));
+        __m128 cosSign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(ji, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30));
+
+        _mm_storeu_ps(outSin + i, _mm_xor_ps(sinRes, sinSign));
+        _mm_storeu_ps(outCos + i, _mm_xor_ps(cosRes, cosSign));
+    }
+#endif
+    for(; i < count; ++i) {
+        FastSinCos(x[i], outSin[i], outCos[i]);
+    }
+}
+
+// sin(x + quadrant * pi/2) for constant expressions: the FastSinCos
+// reduction with the scalar rounding, same error bound.
+constexpr float ConstexprSinQuadrant(float x, int quadrant)
+{
+    float q = x * FASTMATH_2_OVER_PI;
+    long j = (long)(q < 0.0f ? q - 0.5f : q + 0.5f);
+    float fj = (float)j;
+    float r = ((x - fj*FASTMATH_PIO2_HI) - fj*FASTMATH_PIO2_MID) - fj*FASTMATH_PIO2_LO;
+    float r2 = r*r;
+
+    switch((j + quadrant) & 3) {
+        case 0: return FastSinPoly(r, r2);
+        case 1: return FastCosPoly(r2);
+        case 2: return -FastSinPoly(r, r2);
+        default: return -FastCosPoly(r2);
+    }
+}
+
+constexpr float ConstexprSin(float x) { return ConstexprSinQuadrant(x, 0); }
+constexpr float ConstexprCos(float x) { return ConstexprSinQuadrant(x, 1); }
+
+// N evenly spaced samples of sin and cos over [0, 2*pi), built by the
+// compiler when declared constexpr:
+//     constexpr SinCosTable<256> table;
+template<int N>
+struct SinCosTable
+{
+    float sinValues[N];
+    float cosValues[N];
+
+    constexpr SinCosTable(): sinValues(), cosValues()
+    {
+        for(int i=0; i<N; ++i) {
+            float angle = 2.0f * PI * i / N;
+            sinValues[i] = ConstexprSin(angle);
+            cosValues[i] = ConstexprCos(angle);
+        }
+    }
+
+    // Nearest sample, angle in radians (any sign)
+    float Sin(float angle) const { return sinValues[Index(angle)]; }
+    float Cos(float angle) const { return cosValues[Index(angle)]; }
+
+private:
+    static int Index(float angle)
+    {
+        int i = (int)floorf(angle * (N / (2.0f * PI)) + 0.5f) % N;
+        return i < 0 ? i + N : i;
+    }
+};
+
+// GetAxisAngleQuaternion using FastSinCos.
+inline Quaternion GetAxisAngleQuaternionFast(const Vector3f& axis, float angle)
+{
+    float s, c;
+    FastSinCos(angle * 0.5f, s, c);
+    return Quaternion(axis.x * s, axis.y * s, axis.z * s, c);
+}
+
+
+#endif //INC_3DENGINE_FASTMATH_H
@@ -0,0 +1,58 @@
+#ifndef INC_3DENGINE_FRUSTUM_H
+#define INC_3DENGINE_FRUSTUM_H
+
+#include <vector>
+#include "Types.h"
+#include "math3d.h"
+
+// Axis aligned boxes in center/half-extent form, one array per component.
+struct BoundingBoxStream
+{
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> extentX, extentY, extentZ;
+
+    size_t Size() const { return centerX.size(); }
+
+    void Resize(size_t count);
+    void Set(size_t i, const Vector3f& boxMin, const Vector3f& boxMax);
+};
+
+struct BoundingSphereStream
+{
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> radius;
+
+    size_t Size() const { return centerX.size(); }
+
+    void Resize(size_t count);
+    void Set(size_t i, const Vector3f& center, float r);
+};
+
+struct Frustum
+{
+    // (nx, ny, nz, d) with normalized n pointing inside: left, right, bottom, top, near, far
+    Vector4f planes[6];
+
+    // Gribb/Hartmann extraction from a GL style (-w..w clip space) view-projection matrix.
+    // Pass a model-view-projection matrix to cull in object space instead.
+    // With a reverse-Z infinite projection (depth 1 at the near plane) the
+    // roles of planes 4 and 5 swap: 5 is the near plane, and for the
+    // [-1, 1] depth range Extract produces (0, 0, 0, w > 0) for 4, a zero
+    // normal and positive w, so it always passes. For the [0, 1] range
+    // (glClipControl) plane 4 is z >= -nearZ in view space, which passes
+    // everything in front of the camera.
+    void Extract(const Matrix4f& viewProjection);
+
+    bool IsBoxVisible(const Vector3f& center, const Vector3f& extent) const;
+    bool IsSphereVisible(const Vector3f& center, float radius) const;
+
+    // Test every entry against the six planes and write the indices of the
+    // visible ones to visibleIndices, which needs room for Size() entries.
+    // Returns the number of visible entries. Conservative: boxes crossing a
+    // frustum corner outside of every single plane are reported visible.
+    size_t CullBoxes(const BoundingBoxStream& boxes, uint32* visibleIndices) const;
+    size_t CullSpheres(const BoundingSphereStream& spheres, uint32* visibleIndices) const;
+};
+
+
+#endif //INC_3DENGINE_FRUSTUM_H
@@ -0,0 +1,119 @@
+#ifndef INC_3DENGINE_GLEXTENSIONS_H
+#define INC_3DENGINE_GLEXTENSIONS_H
+
+// Entry points above the GL 3.3 core profile that the bundled glad loader
+// was not generated with. Each block is skipped if glad already provides it,
+// and the GLEXT_* flags tell whether the running context supports it.
+
+#include <glad/glad.h>
+
+#ifndef GL_ARB_clip_control
+#define GL_ARB_clip_control 1
+#define GLEXT_LOADS_ARB_clip_control 1
+#define GL_NEGATIVE_ONE_TO_ONE 0x935E
+#define GL_ZERO_TO_ONE 0x935F
+typedef void (APIENTRYP PFNGLCLIPCONTROLPROC)(GLenum origin, GLenum depth);
+extern PFNGLCLIPCONTROLPROC glext_glClipControl;
+#define glClipControl glext_glClipControl
+#endif
+
+#ifndef GL_ARB_buffer_storage
+#define GL_ARB_buffer_storage 1
+#define GLEXT_LOADS_ARB_buffer_storage 1
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#define GL_DYNAMIC_STORAGE_BIT 0x0100
+#define GL_CLIENT_STORAGE_BIT 0x0200
+typedef void (APIENTRYP PFNGLBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void *data, GLbitfield flags);
+extern PFNGLBUFFERSTORAGEPROC glext_glBufferStorage;
+#define glBufferStorage glext_glBufferStorage
+#endif
+
+#ifndef GL_KHR_parallel_shader_compile
+#define GL_KHR_parallel_shader_compile 1
+#define GLEXT_LOADS_KHR_parallel_shader_compile 1
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+typedef void (APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)(GLuint count);
+extern PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glext_glMaxShaderCompilerThreadsKHR;
+#define glMaxShaderCompilerThreadsKHR glext_glMaxShaderCompilerThreadsKHR
+#endif
+
+#ifndef GL_ARB_separate_shader_objects
+#define GL_ARB_separate_shader_objects 1
+#define GLEXT_LOADS_ARB_separate_shader_objects 1
+#define GL_VERTEX_SHADER_BIT 0x00000001
+#define GL_FRAGMENT_SHADER_BIT 0x00000002
+#define GL_ALL_SHADER_BITS 0xFFFFFFFF
+#define GL_PROGRAM_SEPARABLE 0x8258
+#define GL_ACTIVE_PROGRAM 0x8259
+#define GL_PROGRAM_PIPELINE_BINDING 0x825A
+typedef void (APIENTRYP PFNGLUSEPROGRAMSTAGESPROC)(GLuint pipeline, GLbitfield stages, GLuint program);
+typedef void (APIENTRYP PFNGLACTIVESHADERPROGRAMPROC)(GLuint pipeline, GLuint program);
+typedef void (APIENTRYP PFNGLBINDPROGRAMPIPELINEPROC)(GLuint pipeline);
+typedef void (APIENTRYP PFNGLDELETEPROGRAMPIPELINESPROC)(GLsizei n, const GLuint *pipelines);
+typedef void (APIENTRYP PFNGLGENPROGRAMPIPELINESPROC)(GLsizei n, GLuint *pipelines);
+typedef void (APIENTRYP PFNGLVALIDATEPROGRAMPIPELINEPROC)(GLuint pipeline);
+typedef void (APIENTRYP PFNGLGETPROGRAMPIPELINEIVPROC)(GLuint pipeline, GLenum pname, GLint *params);
+typedef void (APIENTRYP PFNGLGETPROGRAMPIPELINEINFOLOGPROC)(GLuint pipeline, GLsizei bufSize, GLsizei *length, GLchar *infoLog);
+extern PFNGLUSEPROGRAMSTAGESPROC glext_glUseProgramStages;
+extern PFNGLACTIVESHADERPROGRAMPROC glext_glActiveShaderProgram;
+extern PFNGLBINDPROGRAMPIPELINEPROC glext_glBindProgramPipeline;
+extern PFNGLDELETEPROGRAMPIPELINESPROC glext_glDeleteProgramPipelines;
+extern PFNGLGENPROGRAMPIPELINESPROC glext_glGenProgramPipelines;
+extern PFNGLVALIDATEPROGRAMPIPELINEPROC glext_glValidateProgramPipeline;
+extern PFNGLGETPROGRAMPIPELINEIVPROC glext_glGetProgramPipelineiv;
+extern PFNGLGETPROGRAMPIPELINEINFOLOGPROC glext_glGetProgramPipelineInfoLog;
+#define glUseProgramStages glext_glUseProgramStages
+#define glActiveShaderProgram glext_glActiveShaderProgram
+#define glBindProgramPipeline glext_glBindProgramPipeline
+#define glDeleteProgramPipelines glext_glDeleteProgramPipelines
+#define glGenProgramPipelines glext_glGenProgramPipelines
+#define glValidateProgramPipeline glext_glValidateProgramPipeline
+#define glGetProgramPipelineiv glext_glGetProgramPipelineiv
+#define glGetProgramPipelineInfoLog glext_glGetProgramPipelineInfoLog
+#endif
+
+// Compressed texture formats, glCompressedTexImage2D itself is core
+#ifndef GL_EXT_texture_compression_s3tc
+#define GL_EXT_texture_compression_s3tc 1
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_SRGB_S3TC_DXT1_EXT 0x8C4C
+#define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT 0x8C4F
+#endif
+#ifndef GL_ARB_texture_compression_bptc
+#define GL_ARB_texture_compression_bptc 1
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#define GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM 0x8E8D
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#define GL_COMPRESSED_SRGB8_ETC2 0x9275
+#endif
+
+// glGetProgramBinary, glProgramBinary and glProgramParameteri are declared
+// by glad for GLES 3.0 but only loaded for GLES contexts, LoadGLExtensions
+// fills them in on desktop GL 4.1+ or with ARB_get_program_binary.
+// glProgramParameteri is also part of ARB_separate_shader_objects.
+
+extern int GLEXT_ARB_clip_control;
+extern int GLEXT_ARB_buffer_storage;
+extern int GLEXT_ARB_get_program_binary;
+extern int GLEXT_ARB_separate_shader_objects;
+extern int GLEXT_EXT_texture_compression_s3tc;
+extern int GLEXT_ARB_texture_compression_bptc;
+// ETC2 sampling, GL 4.3 or ARB_ES3_compatibility
+extern int GLEXT_ARB_ES3_compatibility;
+// Also set for the equivalent ARB_parallel_shader_compile
+extern int GLEXT_KHR_parallel_shader_compile;
+
+// Call once after gladLoadGLLoader, with the same loader.
+void LoadGLExtensions(GLADloadproc load);
+bool HasGLExtension(const char *name);
+bool HasGLVersion(int major, int minor);
+
+
+#endif //INC_3DENGINE_GLEXTENSIONS_H
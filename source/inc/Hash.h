@@ -0,0 +1,30 @@
+#ifndef INC_3DENGINE_HASH_H
+#define INC_3DENGINE_HASH_H
+
+#include <cstddef>
+#include <cstring>
+#include "Types.h"
+
+const uint64 FNV1A_64_OFFSET = 14695981039346656037ULL;
+const uint64 FNV1A_64_PRIME  = 1099511628211ULL;
+
+// 64-bit FNV-1a. Pass the previous result as hash to chain several inputs.
+inline uint64 HashBytes(const void *data, size_t size, uint64 hash = FNV1A_64_OFFSET)
+{
+    const uint8 *bytes = (const uint8 *)data;
+    for(size_t i=0; i<size; ++i) {
+        hash ^= bytes[i];
+        hash *= FNV1A_64_PRIME;
+    }
+
+    return hash;
+}
+
+inline uint64 HashString(const char *str, uint64 hash = FNV1A_64_OFFSET)
+{
+    // Include the terminator so ("ab", "c") and ("a", "bc") differ when chained
+    return HashBytes(str, strlen(str) + 1, hash);
+}
+
+
+#endif //INC_3DENGINE_HASH_H
@@ -0,0 +1,33 @@
+#ifndef INC_3DENGINE_MIPGENERATOR_H
+#define INC_3DENGINE_MIPGENERATOR_H
+
+#include <vector>
+#include "Types.h"
+
+// CPU mip chain generation, replacing glGenerateMipmap so the filter is the
+// same on every driver and the work can run off the GL thread. Levels are
+// filtered in linear light: sRGB colour channels are decoded through a
+// table before filtering and encoded again after, alpha is always linear.
+// The filtering itself works on four floats per texel, with SSE2 where
+// available.
+
+enum MipFilter : uint32 {
+    // 2x2 average, cheapest
+    MIP_FILTER_BOX,
+    // 8-tap Kaiser windowed sinc, sharper and with less aliasing
+    MIP_FILTER_KAISER,
+};
+
+struct MipLevel {
+    uint32 width;
+    uint32 height;
+    std::vector<uint8> pixels;   // tightly packed, same channel count as the source
+};
+
+// Returns the whole chain down to 1x1, largest first. Level 0 is a copy of
+// pixels, which are tightly packed RGB (channels 3) or RGBA (channels 4).
+std::vector<MipLevel> GenerateMipChain(const uint8 *pixels, uint32 width, uint32 height, uint32 channels, bool srgb,
+                                       MipFilter filter = MIP_FILTER_KAISER);
+
+
+#endif //INC_3DENGINE_MIPGENERATOR_H
@@ -0,0 +1,35 @@
+#ifndef INC_3DENGINE_PIXELUPLOADRING_H
+#define INC_3DENGINE_PIXELUPLOADRING_H
+
+#include "Types.h"
+#include "SegmentedBuffer.h"
+
+// Streams texture data through a pixel unpack buffer split into a segment
+// per frame in flight (see SegmentedBuffer), like UniformBufferRing. Pixels
+// are copied into the buffer and glTexSubImage2D sources them from there, so
+// the driver copies asynchronously instead of stalling on client memory.
+class PixelUploadRing {
+public:
+    // frameSize should cover the bytes uploaded per frame, e.g. the
+    // TextureLoader budget. Rows that don't fit go up from client memory.
+    PixelUploadRing(uint32 frameSize, uint32 framesInFlight = 3);
+
+    // Waits for the segment about to be reused and resets the allocator
+    void BeginFrame() { segments.BeginFrame(); }
+    // Fences the current segment, call after the frame's last upload
+    void EndFrame() { segments.EndFrame(); }
+
+    // Fills a whole level of the bound GL_TEXTURE_2D, whose storage must
+    // exist. pixels are tightly packed rows of bytesPerPixel bytes in
+    // format (GL_RGB, GL_RGBA...) with GL_UNSIGNED_BYTE components.
+    void Upload(int32 level, int32 width, int32 height, uint32 format, uint32 bytesPerPixel, const uint8 *pixels);
+
+    uint64 streamedBytes;   // went through the buffer
+    uint64 directBytes;     // didn't fit the segment and went up from client memory
+
+private:
+    SegmentedBuffer segments;
+};
+
+
+#endif //INC_3DENGINE_PIXELUPLOADRING_H
@@ -0,0 +1,42 @@
+#ifndef INC_3DENGINE_PROGRAMBINARYCACHE_H
+#define INC_3DENGINE_PROGRAMBINARYCACHE_H
+
+#include <string>
+#include "Types.h"
+
+// On-disk cache of linked program binaries (glGetProgramBinary). Entries are
+// keyed by the shader sources and the driver's vendor/renderer/version
+// strings, so a driver update simply misses and falls back to compiling.
+class ProgramBinaryCache {
+public:
+    explicit ProgramBinaryCache(const std::string& directory);
+
+    // False when the context exposes no binary formats, Load then always misses
+    bool IsSupported() const { return supported; }
+
+    uint64 GetKey(const char *vertexShader, const char *fragmentShader) const;
+
+    // Restores program from the cache, returns false on a miss or if the
+    // driver rejects the binary. program must be a fresh glCreateProgram.
+    bool Load(uint64 key, uint32 program);
+    // program must be linked and created with GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+    void Save(uint64 key, uint32 program);
+
+    // Startup statistics: programs loaded from disk vs. compiled, and the
+    // time spent creating each kind
+    uint32 hits;
+    uint32 misses;
+    double hitMilliseconds;
+    double missMilliseconds;
+    void PrintStats() const;
+
+private:
+    std::string GetPath(uint64 key) const;
+
+    std::string directory;
+    uint64 driverHash;
+    bool supported;
+};
+
+
+#endif //INC_3DENGINE_PROGRAMBINARYCACHE_H
@@ -0,0 +1,83 @@
+#ifndef INC_3DENGINE_PROGRAMPIPELINE_H
+#define INC_3DENGINE_PROGRAMPIPELINE_H
+
+#include <unordered_map>
+#include "Types.h"
+
+class Shader;
+class ShaderCompileQueue;
+class ProgramBinaryCache;
+
+// A GL program pipeline (ARB_separate_shader_objects) combining separable
+// single-stage Shaders. Stages are swapped independently, so N vertex and M
+// fragment stages need N + M links instead of N * M, and changing the
+// material only rebinds the stage that differs.
+class ProgramPipeline {
+public:
+    ProgramPipeline();
+    ~ProgramPipeline();
+
+    ProgramPipeline(const ProgramPipeline&) = delete;
+    ProgramPipeline& operator= (const ProgramPipeline&) = delete;
+
+    uint32 ID;
+
+    // No-ops when the stage already holds the program. Blocks if the stage
+    // is still compiling (counted as a stall), exits if it failed like
+    // Shader::UseShader.
+    void SetVertexStage(Shader *stage);
+    void SetFragmentStage(Shader *stage);
+
+    // Makes the pipeline current. Any program bound with glUseProgram would
+    // take precedence, so that is cleared. Stages whose Shader swapped in a
+    // new program since they were set (hot reload) are attached again.
+    void Bind();
+
+    // The Shader setters use glUniform*, which a bound pipeline routes to
+    // its active program. Call before setting uniforms of stage.
+    void SetActiveStage(Shader *stage);
+
+    // Checks that the stages' interfaces match, logs on failure
+    bool Validate();
+
+    // Number of glUseProgramStages calls actually issued
+    uint32 stageChanges;
+
+private:
+    struct Stage {
+        uint32 bit;
+        Shader *shader;
+        uint32 version;    // the Shader's GetVersion when it was attached
+    };
+
+    void SetStage(Stage& stage, Shader *shader);
+    void AttachStage(Stage& stage, Shader *shader);
+
+    Stage vertexStage;
+    Stage fragmentStage;
+    Shader *activeStage;
+    uint32 activeVersion;
+};
+
+// Separable stage programs shared by every pipeline, one per stage and
+// source text. Each is compiled and linked once however many pipelines
+// combine it.
+class ShaderStageCache {
+public:
+    explicit ShaderStageCache(ProgramBinaryCache *binaryCache = nullptr, ShaderCompileQueue *compileQueue = nullptr);
+    ~ShaderStageCache();
+
+    // stage is GL_VERTEX_SHADER or GL_FRAGMENT_SHADER, source is complete
+    // (already preprocessed)
+    Shader *GetStage(uint32 stage, const char *source);
+
+    uint32 GetStageCount() const { return (uint32)stages.size(); }
+
+private:
+    ProgramBinaryCache *binaryCache;
+    ShaderCompileQueue *compileQueue;
+    std::unordered_map<uint64, Shader*> stages;
+};
+
+
+#endif //INC_3DENGINE_PROGRAMPIPELINE_H
@@ -0,0 +1,52 @@
+#ifndef INC_3DENGINE_SEGMENTEDBUFFER_H
+#define INC_3DENGINE_SEGMENTEDBUFFER_H
+
+#include <vector>
+#include <glad/glad.h>
+#include "Types.h"
+
+// A buffer object split into a segment per frame in flight, the storage
+// behind UniformBufferRing and PixelUploadRing. Data is sub-allocated
+// linearly within the current frame's segment, persistently mapped with
+// ARB_buffer_storage and through unsynchronized glMapBufferRange otherwise.
+// Segments are fenced at the end of their frame and only reused once the
+// GPU is done with them.
+class SegmentedBuffer {
+public:
+    // target is the binding the buffer is created and mapped through.
+    // frameSize is rounded up to alignment, which every allocation starts on.
+    SegmentedBuffer(uint32 target, uint32 frameSize, uint32 framesInFlight, uint32 alignment);
+    ~SegmentedBuffer();
+
+    SegmentedBuffer(const SegmentedBuffer&) = delete;
+    SegmentedBuffer& operator= (const SegmentedBuffer&) = delete;
+
+    // Waits for the segment about to be reused and resets the allocator
+    void BeginFrame();
+    // Fences the current segment, call after the frame's last use of it
+    void EndFrame();
+
+    // Copies size bytes into the current segment and returns their buffer
+    // offset, or -1 if the segment is full. Without a persistent mapping
+    // the buffer is bound to target for the copy and unbound after.
+    int64 Allocate(const void *data, uint32 size);
+
+    uint32 GetBuffer() const { return buffer; }
+    // Left in the current segment, the next allocation may lose some of it
+    // to alignment
+    uint32 GetFreeBytes() const { return offset < frameSize ? frameSize - offset : 0; }
+
+private:
+    uint32 target;
+    uint32 buffer;
+    uint8 *mapped;          // persistent mapping of the whole buffer, if supported
+    uint32 alignment;
+    uint32 frameSize;
+    uint32 framesInFlight;
+    uint32 frameIndex;
+    uint32 offset;          // next free byte in the current segment
+    std::vector<GLsync> fences;
+};
+
+
+#endif //INC_3DENGINE_SEGMENTEDBUFFER_H
@@ -1,18 +1,148 @@
 #ifndef INC_3DENGINE_SHADER_H
 #define INC_3DENGINE_SHADER_H
 
+#include <unordered_map>
+#include <vector>
 #include "Types.h"
+#include "StringId.h"
+#include "math3d.h"
+
+class ProgramBinaryCache;
+
+// Index into a Shader's uniform table. Resolve it once and reuse it per draw.
+using UniformHandle = int32;
+const UniformHandle INVALID_UNIFORM = -1;
+
+enum ShaderState : uint32 {
+    SHADER_COMPILING,   // compile and link issued, status not queried yet
+    SHADER_READY,
+    SHADER_FAILED,
+};
+
+struct ShaderCompileStats {
+    uint32 programs;            // programs created
+    uint32 cacheHits;           // of which restored from a ProgramBinaryCache
+    uint32 stalls;              // programs needed before the driver had finished them
+    double stallMilliseconds;   // time spent blocked in those stalls
+};
+const ShaderCompileStats& GetShaderCompileStats();
+
+struct UniformInfo {
+    StringId name;   // arrays are stored without the "[0]" suffix
+    const char *nameText;   // interned text of name
+    int32 location;
+    uint32 type;     // GL_FLOAT_VEC3, GL_SAMPLER_2D, ...
+    int32 size;      // array length, 1 for non-arrays
+
+    // Last uploaded value, see Shader::SetUniformData
+    uint32 shadowOffset;
+    uint32 shadowSize;
+    bool shadowValid;
+};
 
 class Shader {
 public:
     uint32 ID;
 
-    Shader(const char *vertexShader, const char *fragmentShader);
+    // Issues the compile and link without waiting for them; the status is
+    // only queried once the program is needed (UseShader, GetUniform) or
+    // when IsReady sees the driver is done. With a cache the linked program
+    // is restored from disk when the sources and driver match, and stored
+    // there after compiling otherwise.
+    Shader(const char *vertexShader, const char *fragmentShader, ProgramBinaryCache *cache = nullptr);
+    // A separable single-stage program (GL_VERTEX_SHADER or
+    // GL_FRAGMENT_SHADER) for a ProgramPipeline, needs
+    // GLEXT_ARB_separate_shader_objects. Vertex stages must redeclare
+    // "out gl_PerVertex { vec4 gl_Position; };" for core profiles.
+    Shader(uint32 stage, const char *source, ProgramBinaryCache *cache = nullptr);
+    ~Shader();
+
+    // Owns the GL program
+    Shader(const Shader&) = delete;
+    Shader& operator= (const Shader&) = delete;
 
+    ShaderState GetState() const { return state; }
+    bool IsSeparable() const { return separable; }
+    // Non-blocking with KHR_parallel_shader_compile: finishes the program if
+    // the driver is done with it. Without the extension it finishes (and
+    // may block) right away.
+    bool IsReady();
+    // Blocks until the program is compiled and linked. Logs the info log
+    // and returns false on failure.
+    bool Finalize();
+    // Finalize for a program that is needed now. Counted as a stall unless
+    // KHR_parallel_shader_compile reports the driver already finished it.
+    bool EnsureReady();
+
+    // Exchanges the programs and uniform tables of two shaders, used to
+    // swap in a rebuilt program while everyone keeps pointing at this one.
+    // UniformHandles must be resolved again when GetVersion changes.
+    void Swap(Shader& other);
+    uint32 GetVersion() const { return version; }
+
+    // Exits if the program failed to build, like a failed compile always has
     void UseShader();
+
+    // Assigns a uniform block to a binding point, ignored if the program
+    // has no such block. The engine blocks are bound after linking.
+    void BindUniformBlock(const char *blockName, uint32 binding);
+
+    // The name lookup takes no locks: it is cached per name pointer and
+    // checked with a strcmp, so string literals resolve in one hash lookup.
+    UniformHandle GetUniform(const char *name);
+    UniformHandle GetUniform(StringId name);
+    const std::vector<UniformInfo>& GetUniforms() const { return uniforms; }
+
+    void SetBool(UniformHandle uniform, bool value);
+    void SetInt(UniformHandle uniform, int32 value);
+    void SetFloat(UniformHandle uniform, float value);
+    void SetVector2f(UniformHandle uniform, float x, float y);
+    void SetVector3f(UniformHandle uniform, const Vector3f& value);
+    void SetVector4f(UniformHandle uniform, const Vector4f& value);
+    // values is a row-major 3x3 matrix
+    void SetMatrix3f(UniformHandle uniform, const float *values);
+    void SetMatrix4f(UniformHandle uniform, const Matrix4f& value);
+
+    void SetIntArray(UniformHandle uniform, const int32 *values, int32 count);
+    void SetFloatArray(UniformHandle uniform, const float *values, int32 count);
+    void SetVector3fArray(UniformHandle uniform, const Vector3f *values, int32 count);
+    void SetVector4fArray(UniformHandle uniform, const Vector4f *values, int32 count);
+    void SetMatrix4fArray(UniformHandle uniform, const Matrix4f *values, int32 count);
+
+    // Convenience overloads, resolved through GetUniform(const char *)
     void SetBool(const char *name, bool value);
     void SetInt(const char *name, int32 value);
     void SetFloat(const char *name, float value);
+    void SetVector3f(const char *name, const Vector3f& value);
+    void SetVector4f(const char *name, const Vector4f& value);
+    void SetMatrix4f(const char *name, const Matrix4f& value);
+
+private:
+    // Issues the compile and link, a null source skips that stage
+    void Build(const char *vertexShader, const char *fragmentShader);
+    // Fills the uniform table from GL_ACTIVE_UNIFORMS, once after linking
+    void LoadUniforms();
+    // Binds every uniform block in shaders/ the program uses to its binding
+    // point from ShaderReflection.h
+    void BindUniformBlocks();
+    // Compares data with the last upload of the uniform and records it.
+    // Returns false when the GL call can be skipped. Values set behind the
+    // Shader's back (raw glUniform* calls) are not seen by the shadow.
+    bool SetUniformData(UniformHandle uniform, const void *data, uint32 bytes);
+
+    ShaderState state;
+    uint32 version;
+    bool separable;
+    uint32 vertex;
+    uint32 fragment;
+    ProgramBinaryCache *cache;
+    uint64 cacheKey;
+    double buildMilliseconds;   // time spent in our own GL calls, not in the driver's threads
+
+    std::vector<UniformInfo> uniforms;
+    std::vector<uint8> shadowData;
+    std::unordered_map<StringId, UniformHandle> uniformLookup;
+    std::unordered_map<const char *, UniformHandle> namePointerLookup;
 };
 
 
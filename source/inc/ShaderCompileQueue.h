@@ -0,0 +1,33 @@
+#ifndef INC_3DENGINE_SHADERCOMPILEQUEUE_H
+#define INC_3DENGINE_SHADERCOMPILEQUEUE_H
+
+#include <vector>
+#include "Types.h"
+
+class Shader;
+
+// Tracks shaders whose compile and link have been issued but not finished.
+// Create every program at startup, Add them here and Poll once a frame;
+// programs the driver is done with are finalized without blocking. A
+// program used before that is finalized on the spot and counted as a stall
+// in GetShaderCompileStats.
+class ShaderCompileQueue {
+public:
+    // Lets the driver use all its compiler threads (KHR_parallel_shader_compile)
+    ShaderCompileQueue();
+
+    // The queue does not own shader, it must outlive its time in the queue
+    void Add(Shader *shader);
+    // Finalizes the shaders that are done, returns how many are still pending
+    uint32 Poll();
+    // Blocks until every queued shader is finalized
+    void FinishAll();
+
+    uint32 GetPendingCount() const { return (uint32)pending.size(); }
+
+private:
+    std::vector<Shader*> pending;
+};
+
+
+#endif //INC_3DENGINE_SHADERCOMPILEQUEUE_H
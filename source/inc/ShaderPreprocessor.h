@@ -0,0 +1,61 @@
+#ifndef INC_3DENGINE_SHADERPREPROCESSOR_H
+#define INC_3DENGINE_SHADERPREPROCESSOR_H
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "Types.h"
+
+struct PreprocessedShader {
+    std::string source;
+    // Every file read, the root first. #line directives number the source
+    // strings by this index, so "2(14)" in a driver log is line 14 of
+    // dependencies[2].
+    std::vector<std::string> dependencies;
+};
+
+// Engine-side GLSL pass run before the driver sees a shader: expands
+// #include "file" / #include <file>, honours #pragma once and injects
+// defines right after the root file's #version line. File contents are
+// cached until UpdateFile replaces them.
+// Directives inside /* */ comments are left alone, but #if / #ifdef are
+// not evaluated: an #include in an inactive block is still expanded, so
+// the file must exist and becomes a dependency.
+class ShaderPreprocessor {
+public:
+    // Searched for <file>, and for "file" when it is not next to the includer
+    void AddIncludePath(const std::string& directory);
+    // Injected into every shader, e.g. SetDefine("MAX_LIGHTS", "8")
+    void SetDefine(const std::string& name, const std::string& value = "1");
+
+    // extraDefines are "#define NAME VALUE" lines added after the global
+    // ones. Returns false and logs on a missing file, an include cycle or a
+    // #version outside the root file.
+    bool Preprocess(const std::string& path, const std::string& extraDefines, PreprocessedShader& out);
+
+    // Replaces the cached contents of a file, for hot reload
+    void UpdateFile(const std::string& path, const std::string& source);
+
+    // Collapses "." and ".." so every file has a single name
+    static std::string NormalizePath(const std::string& path);
+
+private:
+    struct Context {
+        PreprocessedShader *out;
+        std::vector<std::string> stack;
+        std::unordered_set<std::string> onceFiles;
+    };
+
+    const std::string *GetFile(const std::string& path);
+    bool ResolveInclude(const std::string& includer, const std::string& name, bool quoted, std::string& outPath);
+    bool Expand(const std::string& path, uint32 sourceIndex, const std::string& defines, Context& context);
+
+    std::vector<std::string> includePaths;
+    std::vector<std::pair<std::string, std::string>> defines;
+    std::unordered_map<std::string, std::string> files;
+};
+
+
+#endif //INC_3DENGINE_SHADERPREPROCESSOR_H
@@ -0,0 +1,59 @@
+#ifndef INC_3DENGINE_SHADERVARIANTCACHE_H
+#define INC_3DENGINE_SHADERVARIANTCACHE_H
+
+#include <string>
+#include <unordered_map>
+#include "Types.h"
+
+class Shader;
+class ShaderCompileQueue;
+class ShaderPreprocessor;
+class ProgramBinaryCache;
+class ShaderWatcher;
+
+// Optional features compiled into a shader variant. Each set bit becomes a
+// "#define <NAME> 1" injected by the preprocessor, shaders test them with
+// #ifdef instead of branching at runtime.
+enum ShaderFeature : uint32 {
+    SHADER_FEATURE_SKINNING   = 1 << 0,
+    SHADER_FEATURE_NORMAL_MAP = 1 << 1,
+    SHADER_FEATURE_INSTANCING = 1 << 2,
+    SHADER_FEATURE_COUNT      = 3,
+};
+typedef uint32 ShaderFeatures;
+
+// Builds shader variants lazily from a vertex/fragment source file pair and
+// a feature mask. Variants are shared: every material asking for the same
+// files and features gets the same Shader. The cache owns the variants,
+// finish its compile queue before destroying it.
+class ShaderVariantCache {
+public:
+    // Sources go through preprocessor. The rest is optional: new variants
+    // go through the binary cache, are handed to the compile queue instead
+    // of being finished on first use and are registered with the watcher
+    // for hot reload.
+    explicit ShaderVariantCache(ShaderPreprocessor *preprocessor, ProgramBinaryCache *binaryCache = nullptr,
+                                ShaderCompileQueue *compileQueue = nullptr, ShaderWatcher *watcher = nullptr);
+    ~ShaderVariantCache();
+
+    // Returns the variant, building it on the first request. Exits if the
+    // sources fail to preprocess.
+    Shader *GetVariant(const char *vertexPath, const char *fragmentPath, ShaderFeatures features);
+
+    uint32 GetVariantCount() const { return (uint32)variants.size(); }
+
+    static uint64 GetVariantKey(const char *vertexPath, const char *fragmentPath, ShaderFeatures features);
+    static const char *GetFeatureName(uint32 featureIndex);
+    // The "#define" lines for a feature mask
+    static std::string GetFeatureDefines(ShaderFeatures features);
+
+private:
+    ShaderPreprocessor *preprocessor;
+    ProgramBinaryCache *binaryCache;
+    ShaderCompileQueue *compileQueue;
+    ShaderWatcher *watcher;
+    std::unordered_map<uint64, Shader*> variants;
+};
+
+
+#endif //INC_3DENGINE_SHADERVARIANTCACHE_H
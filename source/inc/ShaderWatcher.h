@@ -0,0 +1,84 @@
+#ifndef INC_3DENGINE_SHADERWATCHER_H
+#define INC_3DENGINE_SHADERWATCHER_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Types.h"
+#include "ShaderVariantCache.h"
+
+class Shader;
+class ProgramBinaryCache;
+class ShaderPreprocessor;
+
+// Hot reload for shaders built from files. A background thread waits on
+// inotify for writes to any file a program depends on (its sources and
+// everything they #include) and reads the new contents; Update hands them
+// to the preprocessor, rebuilds only the programs that depend on a changed
+// file and swaps each finished program into the live Shader at the frame
+// boundary. A rebuild that fails to compile or
+// link is logged and the previous program stays in use.
+// Only available on Linux, elsewhere Watch just records the program.
+class ShaderWatcher {
+public:
+    // preprocessor must be the one the watched shaders were built with
+    explicit ShaderWatcher(ShaderPreprocessor *preprocessor, ProgramBinaryCache *binaryCache = nullptr);
+    ~ShaderWatcher();
+
+    ShaderWatcher(const ShaderWatcher&) = delete;
+    ShaderWatcher& operator= (const ShaderWatcher&) = delete;
+
+    bool IsSupported() const { return inotifyFd >= 0; }
+
+    // shader must have been built from these files with these features and
+    // must stay alive until Unwatch
+    void Watch(Shader *shader, const std::string& vertexPath, const std::string& fragmentPath, ShaderFeatures features = 0);
+    void Unwatch(Shader *shader);
+
+    // Call on the GL thread between frames. Starts rebuilds for changed
+    // files and swaps in those that finished, returns how many were swapped.
+    uint32 Update();
+
+    uint32 reloads;          // rebuilds started for changed files
+    uint32 failedReloads;    // rebuilds that kept the previous program
+
+private:
+    struct Program {
+        Shader *shader;
+        std::string vertexPath;
+        std::string fragmentPath;
+        ShaderFeatures features;
+        std::vector<std::string> dependencies;
+        Shader *candidate;   // rebuild in flight, nullptr if none
+    };
+
+    void AddWatch(const std::string& path);
+    void RemoveWatch(const std::string& path);
+    // Watches the new dependencies before releasing the old ones
+    void SetDependencies(Program& program, const std::vector<std::string>& dependencies);
+    void WatchThread();
+
+    ShaderPreprocessor *preprocessor;
+    ProgramBinaryCache *binaryCache;
+    std::vector<Program> programs;
+
+    int inotifyFd;
+    std::thread thread;
+    std::atomic<bool> running;
+
+    // Shared with the watch thread
+    std::mutex mutex;
+    std::unordered_map<int, std::string> directories;     // watch descriptor -> resolved directory with a trailing '/'
+    std::unordered_map<std::string, uint32> watchedFiles; // path -> number of programs using it
+    // Resolved path -> the paths as written that name it. inotify hands out
+    // one descriptor per directory however it was spelled ("shaders/",
+    // "./shaders", an absolute path), so events are matched on resolved paths.
+    std::unordered_map<std::string, std::vector<std::string>> spellings;
+    std::unordered_map<std::string, std::string> changedSources;
+};
+
+
+#endif //INC_3DENGINE_SHADERWATCHER_H
@@ -0,0 +1,15 @@
+#ifndef INC_3DENGINE_STRINGID_H
+#define INC_3DENGINE_STRINGID_H
+
+#include "Types.h"
+
+// Interned string handle. Equal strings always map to the same id, so lookups
+// keyed by StringId hash and compare a single integer instead of text.
+using StringId = uint32;
+
+StringId InternString(const char *str);
+// The returned pointer stays valid for the lifetime of the program.
+const char *GetInternedString(StringId id);
+
+
+#endif //INC_3DENGINE_STRINGID_H
@@ -1,8 +1,12 @@
 #ifndef INC_3DENGINE_TEXTURE_H
 #define INC_3DENGINE_TEXTURE_H
 
+#include <vector>
 #include <glad/glad.h>
 #include "Types.h"
+#include "MipGenerator.h"
+
+class PixelUploadRing;
 
 struct Texture {
 
@@ -12,9 +16,27 @@ struct Texture {
     int32 wrapMode_t = GL_REPEAT;
     int32 minFilter  = GL_LINEAR;
     int32 maxFilter  = GL_LINEAR;
+    // Colour is sRGB encoded, sampled through an sRGB format and mipmapped in linear space
+    bool srgb = false;
+    // Used by TextureLoader. LoadTexture filters on the calling thread and
+    // always uses MIP_FILTER_BOX, load through a TextureLoader for Kaiser.
+    MipFilter mipFilter = MIP_FILTER_KAISER;
+    // False while a TextureLoader still has the image, a placeholder is bound until then
+    bool ready = false;
 
     void LoadTexture(bool alpha);
+    // Loads a file cooked by tools/TextureCooker. The file is memory mapped
+    // and its precomputed mip levels go to GL as they are, with no decoding
+    // or mip generation. Returns false if it is not a valid container.
+    bool LoadCookedTexture();
     void BindTexture();
+
+    // Creates the texture object with the wrap and filter modes and leaves it bound
+    void CreateTexture();
+    // Replaces the bound texture's levels with a chain from GenerateMipChain,
+    // RGB, or RGBA with alpha. With a ring the pixels are streamed through
+    // its pixel buffer instead of client memory.
+    void UploadMipChain(const std::vector<MipLevel>& levels, bool alpha, PixelUploadRing *ring = nullptr);
 };
 
 
@@ -0,0 +1,39 @@
+#ifndef INC_3DENGINE_TEXTURECOMPRESSION_H
+#define INC_3DENGINE_TEXTURECOMPRESSION_H
+
+#include <vector>
+#include "Types.h"
+#include "TextureContainer.h"
+
+// CPU block compression used by the texture cooker. Blocks are 4x4 texels
+// of RGBA8, 64 bytes row by row. The encoders aim for speed over the last
+// fraction of a dB:
+//  BC1   8 bytes, RGB565 endpoints along the principal axis, no alpha
+//  BC3  16 bytes, BC1 colour plus an 8-value alpha block
+//  BC7  16 bytes, mode 6 only (one RGBA subset, 4-bit indices)
+//  ETC2  8 bytes, RGB using the ETC1-compatible individual and
+//        differential modes
+// The decoders cover what the encoders produce. They feed the cooker's
+// quality benchmark and let Texture fall back to RGBA8 on GPUs that can't
+// sample a format.
+
+void EncodeBC1Block(const uint8 *rgba, uint8 *block);
+void EncodeBC3Block(const uint8 *rgba, uint8 *block);
+void EncodeBC7Block(const uint8 *rgba, uint8 *block);
+void EncodeETC2Block(const uint8 *rgba, uint8 *block);
+
+void DecodeBC1Block(const uint8 *block, uint8 *rgba);
+void DecodeBC3Block(const uint8 *block, uint8 *rgba);
+// Returns false for modes other than 6
+bool DecodeBC7Block(const uint8 *block, uint8 *rgba);
+void DecodeETC2Block(const uint8 *block, uint8 *rgba);
+
+// Compresses a tightly packed RGBA8 image, blocks past the right and
+// bottom edge repeat the edge texels
+std::vector<uint8> CompressImage(TextureContainerFormat format, const uint8 *rgba, uint32 width, uint32 height);
+// Back to tightly packed RGBA8, false on blocks the decoders don't handle
+bool DecompressImage(TextureContainerFormat format, const uint8 *blocks, uint32 width, uint32 height,
+                     std::vector<uint8>& rgba);
+
+
+#endif //INC_3DENGINE_TEXTURECOMPRESSION_H
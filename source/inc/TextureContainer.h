@@ -0,0 +1,103 @@
+#ifndef INC_3DENGINE_TEXTURECONTAINER_H
+#define INC_3DENGINE_TEXTURECONTAINER_H
+
+#include <cstddef>
+#include <string>
+#include "Types.h"
+#include "GLExtensions.h"
+
+// Cooked texture file written by tools/TextureCooker and read by
+// Texture::LoadCookedTexture. A TextureContainerHeader is followed by
+// mipCount TextureContainerMip entries, largest level first, and the level
+// data at their offsets. Everything is little endian and ready to hand to
+// GL straight out of a memory mapping: rows are tightly packed (unpack
+// alignment 1) and bottom row first, as GL expects. Compressed levels are
+// 4x4 blocks, a row of blocks at a time, partial blocks padded.
+
+const uint32 TEXTURE_CONTAINER_MAGIC = 0x58455443; // "CTEX"
+const uint32 TEXTURE_CONTAINER_VERSION = 1;
+// Level data offsets are multiples of this
+const uint32 TEXTURE_CONTAINER_ALIGNMENT = 16;
+
+enum TextureContainerFormat : uint32 {
+    TEXTURE_FORMAT_RGB8,
+    TEXTURE_FORMAT_RGBA8,
+    TEXTURE_FORMAT_SRGB8,
+    TEXTURE_FORMAT_SRGB8_ALPHA8,
+    TEXTURE_FORMAT_BC1,
+    TEXTURE_FORMAT_BC1_SRGB,
+    TEXTURE_FORMAT_BC3,
+    TEXTURE_FORMAT_BC3_SRGB,
+    TEXTURE_FORMAT_BC7,
+    TEXTURE_FORMAT_BC7_SRGB,
+    TEXTURE_FORMAT_ETC2_RGB8,
+    TEXTURE_FORMAT_ETC2_SRGB8,
+    TEXTURE_FORMAT_COUNT,
+};
+
+struct TextureContainerHeader {
+    uint32 magic;
+    uint32 version;
+    uint32 format;      // TextureContainerFormat
+    uint32 width;
+    uint32 height;
+    uint32 mipCount;
+};
+
+struct TextureContainerMip {
+    uint32 width;
+    uint32 height;
+    uint64 offset;      // from the start of the file
+    uint64 size;
+};
+
+struct TextureFormatInfo {
+    const char *name;
+    uint32 internalFormat;
+    uint32 format;          // 0 for compressed formats
+    uint32 type;
+    uint32 bytesPerPixel;   // 0 for compressed formats
+    uint32 blockBytes;      // bytes per 4x4 block, 0 if uncompressed
+    bool srgb;
+};
+
+inline TextureFormatInfo GetTextureFormatInfo(TextureContainerFormat format) {
+    static const TextureFormatInfo INFO[TEXTURE_FORMAT_COUNT] = {
+        { "rgb8",         GL_RGB8,                                 GL_RGB,  GL_UNSIGNED_BYTE, 3, 0,  false },
+        { "rgba8",        GL_RGBA8,                                GL_RGBA, GL_UNSIGNED_BYTE, 4, 0,  false },
+        { "srgb8",        GL_SRGB8,                                GL_RGB,  GL_UNSIGNED_BYTE, 3, 0,  true },
+        { "srgb8_alpha8", GL_SRGB8_ALPHA8,                         GL_RGBA, GL_UNSIGNED_BYTE, 4, 0,  true },
+        { "bc1",          GL_COMPRESSED_RGB_S3TC_DXT1_EXT,         0,       0,                0, 8,  false },
+        { "bc1_srgb",     GL_COMPRESSED_SRGB_S3TC_DXT1_EXT,        0,       0,                0, 8,  true },
+        { "bc3",          GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,        0,       0,                0, 16, false },
+        { "bc3_srgb",     GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT,  0,       0,                0, 16, true },
+        { "bc7",          GL_COMPRESSED_RGBA_BPTC_UNORM,           0,       0,                0, 16, false },
+        { "bc7_srgb",     GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM,     0,       0,                0, 16, true },
+        { "etc2",         GL_COMPRESSED_RGB8_ETC2,                 0,       0,                0, 8,  false },
+        { "etc2_srgb",    GL_COMPRESSED_SRGB8_ETC2,                0,       0,                0, 8,  true },
+    };
+    return INFO[format];
+}
+
+inline uint64 GetTextureLevelSize(TextureContainerFormat format, uint32 width, uint32 height) {
+    TextureFormatInfo info = GetTextureFormatInfo(format);
+    if(info.blockBytes) {
+        return (uint64)((width + 3) / 4) * ((height + 3) / 4) * info.blockBytes;
+    }
+    return (uint64)width * height * info.bytesPerPixel;
+}
+
+// A container checked by ParseTextureContainer, pointing into its data
+struct TextureContainerView {
+    const TextureContainerHeader *header;
+    const TextureContainerMip *mips;    // header->mipCount entries
+    TextureContainerFormat format;
+};
+
+// Checks that data, a whole file, is a container of this version whose
+// levels have the sizes of a mip chain and lie inside the file. Returns
+// false with the reason in error otherwise.
+bool ParseTextureContainer(const uint8 *data, size_t size, TextureContainerView& view, std::string& error);
+
+
+#endif //INC_3DENGINE_TEXTURECONTAINER_H
@@ -0,0 +1,81 @@
+#ifndef INC_3DENGINE_TEXTURELOADER_H
+#define INC_3DENGINE_TEXTURELOADER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Types.h"
+#include "MipGenerator.h"
+
+struct Texture;
+class PixelUploadRing;
+
+// Loads textures without blocking the frame. Files are decoded and their
+// mip chains generated (see MipGenerator.h) on a pool of worker threads,
+// which hand the levels back through a lock-free list; the
+// GL thread uploads at most uploadBudget bytes of them per frame in Update.
+// Until its upload a texture is bound to a 1x1 grey placeholder. With a
+// PixelUploadRing the uploads stream through its pixel buffer; Update must
+// then run between the ring's BeginFrame and EndFrame.
+class TextureLoader {
+public:
+    // workerCount 0 uses one thread less than the hardware has, at least one
+    explicit TextureLoader(uint32 workerCount = 0, uint32 uploadBudget = 8 * 1024 * 1024,
+                           PixelUploadRing *uploadRing = nullptr);
+    ~TextureLoader();
+
+    TextureLoader(const TextureLoader&) = delete;
+    TextureLoader& operator= (const TextureLoader&) = delete;
+
+    // GL thread. Creates texture->textureID right away, bound to the
+    // placeholder, and queues the decode. texture must outlive the load.
+    void Load(Texture *texture, bool alpha);
+
+    // GL thread, once per frame. Uploads decoded images until the budget
+    // is spent (always at least one) and returns how many became ready.
+    uint32 Update();
+
+    // Requested and not uploaded yet
+    uint32 GetPendingCount() const { return pending; }
+
+    uint64 uploadedBytes;
+    uint32 failedLoads;
+
+private:
+    struct Job {
+        Texture *texture;
+        std::string fileName;
+        bool alpha;
+        bool srgb;
+        MipFilter mipFilter;
+        std::vector<MipLevel> levels;   // empty if the decode failed
+        const char *failure; // stb_image's reason, it is only readable on the decoding thread
+        int32 width;
+        int32 height;
+        Job *next;           // link in the completed list
+    };
+
+    void WorkerThread();
+
+    uint32 uploadBudget;
+    PixelUploadRing *uploadRing;
+    uint32 pending;
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Job*> jobs;
+    bool stopping;
+
+    // Decoded jobs, pushed by the workers and taken all at once by Update
+    std::atomic<Job*> completed;
+    // Taken from completed but over this frame's budget
+    std::deque<Job*> uploads;
+};
+
+
+#endif //INC_3DENGINE_TEXTURELOADER_H
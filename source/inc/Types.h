@@ -1,10 +1,12 @@
 #ifndef INC_3DENGINE_TYPES_H
 #define INC_3DENGINE_TYPES_H
 
+using uint64 = unsigned long long;
 using uint32 = unsigned int;
 using uint16 = unsigned short;
 using uint8  = unsigned char;
 
+using int64  = long long;
 using int32  = int;
 using int16  = short;
 using int8   = char;
@@ -0,0 +1,71 @@
+#ifndef INC_3DENGINE_UNIFORMBUFFER_H
+#define INC_3DENGINE_UNIFORMBUFFER_H
+
+#include "Types.h"
+#include "math3d.h"
+#include "SegmentedBuffer.h"
+
+// Binding points shared by every program, assigned in Shader::BindUniformBlocks
+// from ShaderReflection.h, which UniformBuffer.cpp checks these against
+enum UniformBlockBinding : uint32 {
+    PER_FRAME_BLOCK_BINDING = 0,
+    PER_OBJECT_BLOCK_BINDING = 1,
+};
+
+// std140 mirrors of the uniform blocks in shaders/. The blocks are declared
+// row_major so Matrix4f uploads as is; vec3 members take 16 bytes.
+struct alignas(16) PerFrameData {
+    Matrix4f view;
+    Matrix4f projection;
+    Matrix4f viewProjection;
+    Vector4f cameraPos;
+    float time;
+    float deltaTime;
+    float padding[2];
+};
+static_assert(sizeof(PerFrameData) == 224, "PerFrameData does not match the std140 PerFrame block");
+
+struct alignas(16) PerObjectData {
+    Matrix4f model;
+    Matrix4f modelViewProjection;
+};
+static_assert(sizeof(PerObjectData) == 128, "PerObjectData does not match the std140 PerObject block");
+
+struct UniformBufferRange {
+    uint32 buffer;
+    uint32 offset;
+    uint32 size;
+};
+
+// One large uniform buffer split into a segment per frame in flight (see
+// SegmentedBuffer). Data is sub-allocated linearly within the current
+// frame's segment and bound with glBindBufferRange, so a whole frame of
+// uniforms costs one buffer and no per-draw buffer orphaning.
+class UniformBufferRing {
+public:
+    UniformBufferRing(uint32 frameSize, uint32 framesInFlight = 3);
+
+    // Waits for the segment about to be reused and resets the allocator
+    void BeginFrame() { segments.BeginFrame(); }
+    // Fences the current segment, call after the frame's last draw
+    void EndFrame() { segments.EndFrame(); }
+
+    // Copies data into the current segment. The range stays valid until the
+    // end of the frame. Returns a range with buffer 0 when the segment is
+    // full, counted in overflows; Bind ignores such ranges.
+    UniformBufferRange Push(const void *data, uint32 size);
+
+    template<typename T>
+    UniformBufferRange Push(const T& data) { return Push(&data, sizeof(T)); }
+
+    static void Bind(uint32 binding, const UniformBufferRange& range);
+
+    uint64 pushedBytes;   // copied into the buffer
+    uint32 overflows;     // pushes dropped because the segment was full
+
+private:
+    SegmentedBuffer segments;   // aligned to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+};
+
+
+#endif //INC_3DENGINE_UNIFORMBUFFER_H
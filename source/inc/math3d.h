@@ -1,10 +1,36 @@
 #ifndef MATH_H
 #define MATH_H
 
-#define ToRadian(x) (float)(((x) * M_PI / 180.0f))
-#define ToDegree(x) (float)(((x) * 180.0f / M_PI))
+#include <cmath>
+#include <cstdio>
+#include <cstddef>
+#include <cstring>
+#include <vector>
 
-#include <glm/vec3.hpp>
+constexpr float PI = 3.14159265358979323846f;
+
+constexpr float ToRadian(float x) { return x * PI / 180.0f; }
+constexpr float ToDegree(float x) { return x * 180.0f / PI; }
+
+// Backend selection, set by ENGINE_MATH_BACKEND at configure time:
+//   SIMD   - SSE everywhere, AVX when the compiler may emit it (-mavx, see ENGINE_USE_AVX)
+//   SCALAR - MATH3D_NO_SIMD, the scalar reference implementation
+//   GLM    - ENGINE_MATH_GLM, the core 4x4 kernels forward to glm
+#if defined(ENGINE_MATH_GLM)
+    #include <glm/mat4x4.hpp>
+    #include <glm/matrix.hpp>
+    #include <glm/gtc/type_ptr.hpp>
+#endif
+#if !defined(MATH3D_NO_SIMD)
+    #if defined(__AVX__)
+        #define MATH3D_AVX 1
+        #include <immintrin.h>
+    #endif
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define MATH3D_SSE 1
+        #include <emmintrin.h>
+    #endif
+#endif
 
 struct Vector3f
 {
@@ -12,22 +38,29 @@ struct Vector3f
     float y;
     float z;
 
-    Vector3f() {}
-    Vector3f(float _x, float _y, float _z): x(_x), y(_y), z(_z) {}
-    Vector3f(const Vector3f& copy): x(copy.x), y(copy.y), z(copy.z) {}
+    constexpr Vector3f(): x(0.0f), y(0.0f), z(0.0f) {}
+    constexpr Vector3f(float _x, float _y, float _z): x(_x), y(_y), z(_z) {}
+    constexpr Vector3f(const Vector3f& copy): x(copy.x), y(copy.y), z(copy.z) {}
+    Vector3f& operator= (const Vector3f& copy) = default;
 
-    Vector3f operator- (const Vector3f& rv) {
-        Vector3f ret;
+    constexpr Vector3f operator+ (const Vector3f& rv) const {
+        return Vector3f(x + rv.x, y + rv.y, z + rv.z);
+    };
 
-        ret.x = rv.x - x;
-        ret.y = rv.y - y;
-        ret.z = rv.z - z;
+    constexpr Vector3f operator- (const Vector3f& rv) const {
+        return Vector3f(x - rv.x, y - rv.y, z - rv.z);
+    };
 
-        return ret;
+    constexpr Vector3f operator* (float s) const {
+        return Vector3f(x * s, y * s, z * s);
+    };
+
+    constexpr float Dot(const Vector3f& rv) const {
+        return x*rv.x + y*rv.y + z*rv.z;
     };
 
-    Vector3f Normalize() {
-        Vector3f ret = {};
+    Vector3f Normalize() const {
+        Vector3f ret;
         float length = sqrtf(x*x + y*y + z*z);
         if(length != 0) {
             ret.x = x/length;
@@ -37,41 +70,634 @@ struct Vector3f
         return ret;
     };
 
-    Vector3f CrossProduct(const Vector3f& rv) {
-        Vector3f ret;
-        ret.x = y*rv.z - rv.y*z;
-        ret.y = x*rv.z - rv.x*z;
-        ret.z = x*rv.y - rv.x*y;
-
-        return ret;
+    constexpr Vector3f CrossProduct(const Vector3f& rv) const {
+        return Vector3f(y*rv.z - rv.y*z,
+                        z*rv.x - rv.z*x,
+                        x*rv.y - rv.x*y);
     };
 
-    void printValues()
+    void printValues() const
     {
         printf("x: %f, y: %f, z: %f\n", x, y, z);
     };
 };
 
-struct Matrix4f
+struct alignas(16) Vector4f
+{
+    float x;
+    float y;
+    float z;
+    float w;
+
+    Vector4f() {}
+    constexpr Vector4f(float _x, float _y, float _z, float _w): x(_x), y(_y), z(_z), w(_w) {}
+    constexpr Vector4f(const Vector3f& v, float _w): x(v.x), y(v.y), z(v.z), w(_w) {}
+};
+
+// Row-major, column vectors: m[row][col], translation lives in m[0..2][3].
+// Rows are 16 byte aligned so the SIMD paths can load them directly.
+struct alignas(16) Matrix4f
 {
     float m[4][4];
 
-    Matrix4f operator* (const Matrix4f& rm) {
-        Matrix4f mat;
-        for(int i=0; i<4; ++i) {
-            for(int j=0; j<4; ++j) {
-                mat.m[i][j] = m[i][0] * rm.m[0][j] +
-                              m[i][1] * rm.m[1][j] +
-                              m[i][2] * rm.m[2][j] +
-                              m[i][3] * rm.m[3][j];
-            }
+    Matrix4f operator* (const Matrix4f& rm) const;
+    Vector4f operator* (const Vector4f& v) const;
+
+    Matrix4f Inverse() const;
+};
+
+// Reference implementation, also used when no SIMD path is available.
+inline void MultiplyMatrix4fScalar(const Matrix4f& lm, const Matrix4f& rm, Matrix4f& out)
+{
+    for(int i=0; i<4; ++i) {
+        for(int j=0; j<4; ++j) {
+            out.m[i][j] = lm.m[i][0] * rm.m[0][j] +
+                          lm.m[i][1] * rm.m[1][j] +
+                          lm.m[i][2] * rm.m[2][j] +
+                          lm.m[i][3] * rm.m[3][j];
         }
+    }
+}
 
-        return mat;    
-    };
+// Returning form of the reference, usable in constant expressions to fold
+// static transform chains at compile time.
+constexpr Matrix4f MultiplyMatrix4fScalar(const Matrix4f& lm, const Matrix4f& rm)
+{
+    Matrix4f mat = {};
+    for(int i=0; i<4; ++i) {
+        for(int j=0; j<4; ++j) {
+            mat.m[i][j] = lm.m[i][0] * rm.m[0][j] +
+                          lm.m[i][1] * rm.m[1][j] +
+                          lm.m[i][2] * rm.m[2][j] +
+                          lm.m[i][3] * rm.m[3][j];
+        }
+    }
+
+    return mat;
+}
+
+// out must not alias lm or rm.
+inline void MultiplyMatrix4f(const Matrix4f& lm, const Matrix4f& rm, Matrix4f& out)
+{
+#if defined(ENGINE_MATH_GLM)
+    // glm is column-major, so it sees every Matrix4f transposed: (L R)^T = R^T L^T
+    glm::mat4 res = glm::make_mat4(&rm.m[0][0]) * glm::make_mat4(&lm.m[0][0]);
+    memcpy(out.m, glm::value_ptr(res), sizeof(out.m));
+#elif defined(MATH3D_AVX)
+    // Two result rows per iteration: each lane half broadcasts one element of
+    // its row of lm and scales the matching row of rm.
+    __m256 r0 = _mm256_broadcast_ps((const __m128*)rm.m[0]);
+    __m256 r1 = _mm256_broadcast_ps((const __m128*)rm.m[1]);
+    __m256 r2 = _mm256_broadcast_ps((const __m128*)rm.m[2]);
+    __m256 r3 = _mm256_broadcast_ps((const __m128*)rm.m[3]);
+
+    for(int i=0; i<4; i+=2) {
+        __m256 l = _mm256_loadu_ps(lm.m[i]);
+        __m256 res = _mm256_mul_ps(_mm256_shuffle_ps(l, l, 0x00), r0);
+        res = _mm256_add_ps(res, _mm256_mul_ps(_mm256_shuffle_ps(l, l, 0x55), r1));
+        res = _mm256_add_ps(res, _mm256_mul_ps(_mm256_shuffle_ps(l, l, 0xAA), r2));
+        res = _mm256_add_ps(res, _mm256_mul_ps(_mm256_shuffle_ps(l, l, 0xFF), r3));
+        _mm256_storeu_ps(out.m[i], res);
+    }
+#elif defined(MATH3D_SSE)
+    __m128 r0 = _mm_load_ps(rm.m[0]);
+    __m128 r1 = _mm_load_ps(rm.m[1]);
+    __m128 r2 = _mm_load_ps(rm.m[2]);
+    __m128 r3 = _mm_load_ps(rm.m[3]);
+
+    for(int i=0; i<4; ++i) {
+        __m128 res = _mm_mul_ps(_mm_set1_ps(lm.m[i][0]), r0);
+        res = _mm_add_ps(res, _mm_mul_ps(_mm_set1_ps(lm.m[i][1]), r1));
+        res = _mm_add_ps(res, _mm_mul_ps(_mm_set1_ps(lm.m[i][2]), r2));
+        res = _mm_add_ps(res, _mm_mul_ps(_mm_set1_ps(lm.m[i][3]), r3));
+        _mm_store_ps(out.m[i], res);
+    }
+#else
+    MultiplyMatrix4fScalar(lm, rm, out);
+#endif
+}
+
+// Reference implementation of TransformVector4f.
+inline Vector4f TransformVector4fScalar(const Matrix4f& mat, const Vector4f& v)
+{
+    return Vector4f(mat.m[0][0]*v.x + mat.m[0][1]*v.y + mat.m[0][2]*v.z + mat.m[0][3]*v.w,
+                    mat.m[1][0]*v.x + mat.m[1][1]*v.y + mat.m[1][2]*v.z + mat.m[1][3]*v.w,
+                    mat.m[2][0]*v.x + mat.m[2][1]*v.y + mat.m[2][2]*v.z + mat.m[2][3]*v.w,
+                    mat.m[3][0]*v.x + mat.m[3][1]*v.y + mat.m[3][2]*v.z + mat.m[3][3]*v.w);
+}
+
+inline Vector4f TransformVector4f(const Matrix4f& mat, const Vector4f& v)
+{
+    Vector4f ret;
+#if defined(ENGINE_MATH_GLM)
+    // Row vector times the transposed matrix
+    glm::vec4 res = glm::vec4(v.x, v.y, v.z, v.w) * glm::make_mat4(&mat.m[0][0]);
+    ret = Vector4f(res.x, res.y, res.z, res.w);
+#elif defined(MATH3D_SSE)
+    __m128 vec = _mm_load_ps(&v.x);
+    __m128 p0 = _mm_mul_ps(_mm_load_ps(mat.m[0]), vec);
+    __m128 p1 = _mm_mul_ps(_mm_load_ps(mat.m[1]), vec);
+    __m128 p2 = _mm_mul_ps(_mm_load_ps(mat.m[2]), vec);
+    __m128 p3 = _mm_mul_ps(_mm_load_ps(mat.m[3]), vec);
+
+    // After the transpose each register holds one term of every dot product
+    _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+    _mm_store_ps(&ret.x, _mm_add_ps(_mm_add_ps(p0, p1), _mm_add_ps(p2, p3)));
+#else
+    ret = TransformVector4fScalar(mat, v);
+#endif
+    return ret;
+}
+
+// Transforms a point (w = 1). No perspective divide is done. Scalar in every
+// backend: packing one Vector3f into a register and unpacking the result
+// costs far more than the 9 multiplies, use TransformPoints for streams.
+inline Vector3f TransformPoint(const Matrix4f& mat, const Vector3f& p)
+{
+    return Vector3f(mat.m[0][0]*p.x + mat.m[0][1]*p.y + mat.m[0][2]*p.z + mat.m[0][3],
+                    mat.m[1][0]*p.x + mat.m[1][1]*p.y + mat.m[1][2]*p.z + mat.m[1][3],
+                    mat.m[2][0]*p.x + mat.m[2][1]*p.y + mat.m[2][2]*p.z + mat.m[2][3]);
+}
+
+// Transforms a direction (w = 0), ignoring the translation. Scalar like
+// TransformPoint.
+inline Vector3f TransformDirection(const Matrix4f& mat, const Vector3f& d)
+{
+    return Vector3f(mat.m[0][0]*d.x + mat.m[0][1]*d.y + mat.m[0][2]*d.z,
+                    mat.m[1][0]*d.x + mat.m[1][1]*d.y + mat.m[1][2]*d.z,
+                    mat.m[2][0]*d.x + mat.m[2][1]*d.y + mat.m[2][2]*d.z);
+}
+
+// Cofactor expansion, the reference for the SIMD version below.
+inline bool InverseMatrix4fScalar(const Matrix4f& mat, Matrix4f& out)
+{
+    const float* a = &mat.m[0][0];
+    float inv[16];
+
+    inv[0]  =  a[5]*a[10]*a[15] - a[5]*a[11]*a[14] - a[9]*a[6]*a[15] + a[9]*a[7]*a[14] + a[13]*a[6]*a[11] - a[13]*a[7]*a[10];
+    inv[4]  = -a[4]*a[10]*a[15] + a[4]*a[11]*a[14] + a[8]*a[6]*a[15] - a[8]*a[7]*a[14] - a[12]*a[6]*a[11] + a[12]*a[7]*a[10];
+    inv[8]  =  a[4]*a[9]*a[15]  - a[4]*a[11]*a[13] - a[8]*a[5]*a[15] + a[8]*a[7]*a[13] + a[12]*a[5]*a[11] - a[12]*a[7]*a[9];
+    inv[12] = -a[4]*a[9]*a[14]  + a[4]*a[10]*a[13] + a[8]*a[5]*a[14] - a[8]*a[6]*a[13] - a[12]*a[5]*a[10] + a[12]*a[6]*a[9];
+    inv[1]  = -a[1]*a[10]*a[15] + a[1]*a[11]*a[14] + a[9]*a[2]*a[15] - a[9]*a[3]*a[14] - a[13]*a[2]*a[11] + a[13]*a[3]*a[10];
+    inv[5]  =  a[0]*a[10]*a[15] - a[0]*a[11]*a[14] - a[8]*a[2]*a[15] + a[8]*a[3]*a[14] + a[12]*a[2]*a[11] - a[12]*a[3]*a[10];
+    inv[9]  = -a[0]*a[9]*a[15]  + a[0]*a[11]*a[13] + a[8]*a[1]*a[15] - a[8]*a[3]*a[13] - a[12]*a[1]*a[11] + a[12]*a[3]*a[9];
+    inv[13] =  a[0]*a[9]*a[14]  - a[0]*a[10]*a[13] - a[8]*a[1]*a[14] + a[8]*a[2]*a[13] + a[12]*a[1]*a[10] - a[12]*a[2]*a[9];
+    inv[2]  =  a[1]*a[6]*a[15]  - a[1]*a[7]*a[14]  - a[5]*a[2]*a[15] + a[5]*a[3]*a[14] + a[13]*a[2]*a[7]  - a[13]*a[3]*a[6];
+    inv[6]  = -a[0]*a[6]*a[15]  + a[0]*a[7]*a[14]  + a[4]*a[2]*a[15] - a[4]*a[3]*a[14] - a[12]*a[2]*a[7]  + a[12]*a[3]*a[6];
+    inv[10] =  a[0]*a[5]*a[15]  - a[0]*a[7]*a[13]  - a[4]*a[1]*a[15] + a[4]*a[3]*a[13] + a[12]*a[1]*a[7]  - a[12]*a[3]*a[5];
+    inv[14] = -a[0]*a[5]*a[14]  + a[0]*a[6]*a[13]  + a[4]*a[1]*a[14] - a[4]*a[2]*a[13] - a[12]*a[1]*a[6]  + a[12]*a[2]*a[5];
+    inv[3]  = -a[1]*a[6]*a[11]  + a[1]*a[7]*a[10]  + a[5]*a[2]*a[11] - a[5]*a[3]*a[10] - a[9]*a[2]*a[7]   + a[9]*a[3]*a[6];
+    inv[7]  =  a[0]*a[6]*a[11]  - a[0]*a[7]*a[10]  - a[4]*a[2]*a[11] + a[4]*a[3]*a[10] + a[8]*a[2]*a[7]   - a[8]*a[3]*a[6];
+    inv[11] = -a[0]*a[5]*a[11]  + a[0]*a[7]*a[9]   + a[4]*a[1]*a[11] - a[4]*a[3]*a[9]  - a[8]*a[1]*a[7]   + a[8]*a[3]*a[5];
+    inv[15] =  a[0]*a[5]*a[10]  - a[0]*a[6]*a[9]   - a[4]*a[1]*a[10] + a[4]*a[2]*a[9]  + a[8]*a[1]*a[6]   - a[8]*a[2]*a[5];
+
+    float det = a[0]*inv[0] + a[1]*inv[4] + a[2]*inv[8] + a[3]*inv[12];
+    if(det == 0.0f) {
+        return false;
+    }
+
+    float invDet = 1.0f / det;
+    float* o = &out.m[0][0];
+    for(int i=0; i<16; ++i) {
+        o[i] = inv[i] * invDet;
+    }
+
+    return true;
+}
+
+#if defined(MATH3D_SSE)
+// Helpers for the 2x2 block inverse. A 2x2 matrix is packed in one register
+// as (m00, m01, m10, m11).
+#define MATH3D_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+#define MATH3D_SWIZZLE(v, x, y, z, w) MATH3D_SHUFFLE(v, v, x, y, z, w)
+
+// A * B
+inline __m128 Mat2Mul(__m128 a, __m128 b)
+{
+    return _mm_add_ps(_mm_mul_ps(a, MATH3D_SWIZZLE(b, 0,3,0,3)),
+                      _mm_mul_ps(MATH3D_SWIZZLE(a, 1,0,3,2), MATH3D_SWIZZLE(b, 2,1,2,1)));
+}
+
+// adj(A) * B
+inline __m128 Mat2AdjMul(__m128 a, __m128 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(MATH3D_SWIZZLE(a, 3,3,0,0), b),
+                      _mm_mul_ps(MATH3D_SWIZZLE(a, 1,1,2,2), MATH3D_SWIZZLE(b, 2,3,0,1)));
+}
+
+// A * adj(B)
+inline __m128 Mat2MulAdj(__m128 a, __m128 b)
+{
+    return _mm_sub_ps(_mm_mul_ps(a, MATH3D_SWIZZLE(b, 3,0,3,0)),
+                      _mm_mul_ps(MATH3D_SWIZZLE(a, 1,0,3,2), MATH3D_SWIZZLE(b, 2,1,2,1)));
+}
+#endif
+
+// Returns false and leaves out untouched if mat is singular.
+inline bool InverseMatrix4f(const Matrix4f& mat, Matrix4f& out)
+{
+#if defined(ENGINE_MATH_GLM)
+    // inverse(M^T) = inverse(M)^T, so the result needs no transpose either
+    glm::mat4 transposed = glm::make_mat4(&mat.m[0][0]);
+    if(glm::determinant(transposed) == 0.0f) {
+        return false;
+    }
+    memcpy(out.m, glm::value_ptr(glm::inverse(transposed)), sizeof(out.m));
+    return true;
+#elif defined(MATH3D_SSE)
+    // Block inverse: M = | A B |, split into four 2x2 sub matrices.
+    //                    | C D |
+    __m128 row0 = _mm_load_ps(mat.m[0]);
+    __m128 row1 = _mm_load_ps(mat.m[1]);
+    __m128 row2 = _mm_load_ps(mat.m[2]);
+    __m128 row3 = _mm_load_ps(mat.m[3]);
+
+    __m128 A = _mm_movelh_ps(row0, row1);
+    __m128 B = _mm_movehl_ps(row1, row0);
+    __m128 C = _mm_movelh_ps(row2, row3);
+    __m128 D = _mm_movehl_ps(row3, row2);
+
+    // (|A|, |B|, |C|, |D|)
+    __m128 detSub = _mm_sub_ps(
+        _mm_mul_ps(MATH3D_SHUFFLE(row0, row2, 0,2,0,2), MATH3D_SHUFFLE(row1, row3, 1,3,1,3)),
+        _mm_mul_ps(MATH3D_SHUFFLE(row0, row2, 1,3,1,3), MATH3D_SHUFFLE(row1, row3, 0,2,0,2)));
+    __m128 detA = MATH3D_SWIZZLE(detSub, 0,0,0,0);
+    __m128 detB = MATH3D_SWIZZLE(detSub, 1,1,1,1);
+    __m128 detC = MATH3D_SWIZZLE(detSub, 2,2,2,2);
+    __m128 detD = MATH3D_SWIZZLE(detSub, 3,3,3,3);
+
+    __m128 D_C = Mat2AdjMul(D, C);
+    __m128 A_B = Mat2AdjMul(A, B);
+
+    // Adjugates of the blocks of the inverse
+    __m128 X_ = _mm_sub_ps(_mm_mul_ps(detD, A), Mat2Mul(B, D_C));
+    __m128 W_ = _mm_sub_ps(_mm_mul_ps(detA, D), Mat2Mul(C, A_B));
+    __m128 Y_ = _mm_sub_ps(_mm_mul_ps(detB, C), Mat2MulAdj(D, A_B));
+    __m128 Z_ = _mm_sub_ps(_mm_mul_ps(detC, B), Mat2MulAdj(A, D_C));
+
+    // |M| = |A||D| + |B||C| - tr(adj(A)B adj(D)C)
+    __m128 tr = _mm_mul_ps(A_B, MATH3D_SWIZZLE(D_C, 0,2,1,3));
+    tr = _mm_add_ps(tr, MATH3D_SWIZZLE(tr, 1,0,3,2));
+    tr = _mm_add_ps(tr, MATH3D_SWIZZLE(tr, 2,3,0,1));
+    __m128 detM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+
+    if(_mm_cvtss_f32(detM) == 0.0f) {
+        return false;
+    }
+
+    __m128 rDetM = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+    X_ = _mm_mul_ps(X_, rDetM);
+    Y_ = _mm_mul_ps(Y_, rDetM);
+    Z_ = _mm_mul_ps(Z_, rDetM);
+    W_ = _mm_mul_ps(W_, rDetM);
+
+    // Undo the adjugate and re-interleave the blocks into rows
+    _mm_store_ps(out.m[0], MATH3D_SHUFFLE(X_, Y_, 3,1,3,1));
+    _mm_store_ps(out.m[1], MATH3D_SHUFFLE(X_, Y_, 2,0,2,0));
+    _mm_store_ps(out.m[2], MATH3D_SHUFFLE(Z_, W_, 3,1,3,1));
+    _mm_store_ps(out.m[3], MATH3D_SHUFFLE(Z_, W_, 2,0,2,0));
+
+    return true;
+#else
+    return InverseMatrix4fScalar(mat, out);
+#endif
+}
+
+inline Matrix4f Matrix4f::operator* (const Matrix4f& rm) const
+{
+    Matrix4f mat;
+    MultiplyMatrix4f(*this, rm, mat);
+    return mat;
+}
+
+inline Vector4f Matrix4f::operator* (const Vector4f& v) const
+{
+    return TransformVector4f(*this, v);
+}
+
+// Affine transform, the implicit bottom row is (0, 0, 0, 1). Same layout as
+// the first three rows of Matrix4f, 48 bytes instead of 64.
+struct alignas(16) Matrix3x4
+{
+    float m[3][4];
+
+    Matrix3x4 operator* (const Matrix3x4& rm) const;
+
+    Matrix3x4 Inverse() const;
+    Matrix4f ToMatrix4f() const;
 };
 
-inline Matrix4f GetTranslationMatrix(float x, float y, float z)
+// Drops the projective row of mat, which must be affine.
+constexpr Matrix3x4 GetMatrix3x4(const Matrix4f& mat)
+{
+    Matrix3x4 ret = {};
+    for(int i=0; i<3; ++i) {
+        for(int j=0; j<4; ++j) {
+            ret.m[i][j] = mat.m[i][j];
+        }
+    }
+
+    return ret;
+}
+
+inline Matrix4f Matrix3x4::ToMatrix4f() const
+{
+    Matrix4f mat = {};
+    for(int i=0; i<3; ++i) {
+        for(int j=0; j<4; ++j) {
+            mat.m[i][j] = m[i][j];
+        }
+    }
+    mat.m[3][3] = 1.0f;
+
+    return mat;
+}
+
+// out must not alias lm or rm.
+inline void MultiplyMatrix3x4(const Matrix3x4& lm, const Matrix3x4& rm, Matrix3x4& out)
+{
+#if defined(MATH3D_SSE)
+    __m128 r0 = _mm_load_ps(rm.m[0]);
+    __m128 r1 = _mm_load_ps(rm.m[1]);
+    __m128 r2 = _mm_load_ps(rm.m[2]);
+    // The implicit last row of rm only contributes lm's translation
+    __m128 wMask = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+
+    for(int i=0; i<3; ++i) {
+        __m128 l = _mm_load_ps(lm.m[i]);
+        __m128 res = _mm_and_ps(l, wMask);
+        res = _mm_add_ps(res, _mm_mul_ps(MATH3D_SWIZZLE(l, 0,0,0,0), r0));
+        res = _mm_add_ps(res, _mm_mul_ps(MATH3D_SWIZZLE(l, 1,1,1,1), r1));
+        res = _mm_add_ps(res, _mm_mul_ps(MATH3D_SWIZZLE(l, 2,2,2,2), r2));
+        _mm_store_ps(out.m[i], res);
+    }
+#else
+    // Same shape as MultiplyMatrix4f3x4, so it vectorizes the same way
+    const float w[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    for(int i=0; i<3; ++i) {
+        for(int j=0; j<4; ++j) {
+            out.m[i][j] = lm.m[i][0] * rm.m[0][j] +
+                          lm.m[i][1] * rm.m[1][j] +
+                          lm.m[i][2] * rm.m[2][j] +
+                          lm.m[i][3] * w[j];
+        }
+    }
+#endif
+}
+
+// Full 4x4 times affine, e.g. view-projection * model. out must not alias lm.
+inline void MultiplyMatrix4f3x4(const Matrix4f& lm, const Matrix3x4& rm, Matrix4f& out)
+{
+#if defined(MATH3D_SSE)
+    __m128 r0 = _mm_load_ps(rm.m[0]);
+    __m128 r1 = _mm_load_ps(rm.m[1]);
+    __m128 r2 = _mm_load_ps(rm.m[2]);
+    __m128 wMask = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+
+    for(int i=0; i<4; ++i) {
+        __m128 l = _mm_load_ps(lm.m[i]);
+        __m128 res = _mm_and_ps(l, wMask);
+        res = _mm_add_ps(res, _mm_mul_ps(MATH3D_SWIZZLE(l, 0,0,0,0), r0));
+        res = _mm_add_ps(res, _mm_mul_ps(MATH3D_SWIZZLE(l, 1,1,1,1), r1));
+        res = _mm_add_ps(res, _mm_mul_ps(MATH3D_SWIZZLE(l, 2,2,2,2), r2));
+        _mm_store_ps(out.m[i], res);
+    }
+#else
+    // Written like MultiplyMatrix4fScalar with the implicit row spelled out.
+    // Adding lm's translation to out afterwards reads back a store that may
+    // alias rm and keeps compilers from vectorizing the rows, 4x slower.
+    const float w[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    for(int i=0; i<4; ++i) {
+        for(int j=0; j<4; ++j) {
+            out.m[i][j] = lm.m[i][0] * rm.m[0][j] +
+                          lm.m[i][1] * rm.m[1][j] +
+                          lm.m[i][2] * rm.m[2][j] +
+                          lm.m[i][3] * w[j];
+        }
+    }
+#endif
+}
+
+// Inverts the 3x3 part and rotates the negated translation back.
+// Returns false and leaves out untouched if mat is singular.
+inline bool InverseMatrix3x4(const Matrix3x4& mat, Matrix3x4& out)
+{
+    const float (*a)[4] = mat.m;
+
+    float c00 = a[1][1]*a[2][2] - a[1][2]*a[2][1];
+    float c01 = a[1][2]*a[2][0] - a[1][0]*a[2][2];
+    float c02 = a[1][0]*a[2][1] - a[1][1]*a[2][0];
+
+    float det = a[0][0]*c00 + a[0][1]*c01 + a[0][2]*c02;
+    if(det == 0.0f) {
+        return false;
+    }
+    float invDet = 1.0f / det;
+
+    Matrix3x4 ret;
+    ret.m[0][0] = c00 * invDet;
+    ret.m[0][1] = (a[0][2]*a[2][1] - a[0][1]*a[2][2]) * invDet;
+    ret.m[0][2] = (a[0][1]*a[1][2] - a[0][2]*a[1][1]) * invDet;
+    ret.m[1][0] = c01 * invDet;
+    ret.m[1][1] = (a[0][0]*a[2][2] - a[0][2]*a[2][0]) * invDet;
+    ret.m[1][2] = (a[0][2]*a[1][0] - a[0][0]*a[1][2]) * invDet;
+    ret.m[2][0] = c02 * invDet;
+    ret.m[2][1] = (a[0][1]*a[2][0] - a[0][0]*a[2][1]) * invDet;
+    ret.m[2][2] = (a[0][0]*a[1][1] - a[0][1]*a[1][0]) * invDet;
+
+    for(int i=0; i<3; ++i) {
+        ret.m[i][3] = -(ret.m[i][0]*a[0][3] + ret.m[i][1]*a[1][3] + ret.m[i][2]*a[2][3]);
+    }
+
+    out = ret;
+    return true;
+}
+
+inline Matrix3x4 Matrix3x4::operator* (const Matrix3x4& rm) const
+{
+    Matrix3x4 mat;
+    MultiplyMatrix3x4(*this, rm, mat);
+    return mat;
+}
+
+// Falls back to identity for a singular matrix.
+inline Matrix3x4 Matrix3x4::Inverse() const
+{
+    Matrix3x4 mat = {};
+    if(!InverseMatrix3x4(*this, mat)) {
+        mat.m[0][0] = 1.0f;
+        mat.m[1][1] = 1.0f;
+        mat.m[2][2] = 1.0f;
+    }
+
+    return mat;
+}
+
+inline Matrix4f operator* (const Matrix4f& lm, const Matrix3x4& rm)
+{
+    Matrix4f mat;
+    MultiplyMatrix4f3x4(lm, rm, mat);
+    return mat;
+}
+
+inline Vector3f TransformPoint(const Matrix3x4& mat, const Vector3f& p)
+{
+    return Vector3f(mat.m[0][0]*p.x + mat.m[0][1]*p.y + mat.m[0][2]*p.z + mat.m[0][3],
+                    mat.m[1][0]*p.x + mat.m[1][1]*p.y + mat.m[1][2]*p.z + mat.m[1][3],
+                    mat.m[2][0]*p.x + mat.m[2][1]*p.y + mat.m[2][2]*p.z + mat.m[2][3]);
+}
+
+inline Vector3f TransformDirection(const Matrix3x4& mat, const Vector3f& d)
+{
+    return Vector3f(mat.m[0][0]*d.x + mat.m[0][1]*d.y + mat.m[0][2]*d.z,
+                    mat.m[1][0]*d.x + mat.m[1][1]*d.y + mat.m[1][2]*d.z,
+                    mat.m[2][0]*d.x + mat.m[2][1]*d.y + mat.m[2][2]*d.z);
+}
+
+// Corners of the [-1, 1] cube, bit 0 selects x, bit 1 y and bit 2 z.
+constexpr Vector3f UNIT_CUBE_CORNERS[8] = {
+    Vector3f(-1.0f, -1.0f, -1.0f), Vector3f( 1.0f, -1.0f, -1.0f),
+    Vector3f(-1.0f,  1.0f, -1.0f), Vector3f( 1.0f,  1.0f, -1.0f),
+    Vector3f(-1.0f, -1.0f,  1.0f), Vector3f( 1.0f, -1.0f,  1.0f),
+    Vector3f(-1.0f,  1.0f,  1.0f), Vector3f( 1.0f,  1.0f,  1.0f),
+};
+
+// Structure-of-arrays view over a stream of positions, one array per component.
+// Lets the batched kernels below process 4 (SSE) or 8 (AVX) points per iteration.
+struct Vector3fSoA
+{
+    float* x;
+    float* y;
+    float* z;
+};
+
+// Owning storage for a position stream.
+struct Vector3fStream
+{
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+
+    size_t Size() const { return x.size(); }
+
+    void Resize(size_t count)
+    {
+        x.resize(count);
+        y.resize(count);
+        z.resize(count);
+    }
+
+    void Set(size_t i, const Vector3f& v)
+    {
+        x[i] = v.x;
+        y[i] = v.y;
+        z[i] = v.z;
+    }
+
+    Vector3f Get(size_t i) const { return Vector3f(x[i], y[i], z[i]); }
+
+    Vector3fSoA View()
+    {
+        Vector3fSoA view = { x.data(), y.data(), z.data() };
+        return view;
+    }
+};
+
+// out[i] = mat * (in[i], 1). in and out may be the same stream.
+inline void TransformPoints(const Matrix4f& mat, const Vector3fSoA& in, const Vector3fSoA& out, size_t count)
+{
+    size_t i = 0;
+#if defined(MATH3D_AVX)
+    {
+        __m256 m00 = _mm256_set1_ps(mat.m[0][0]), m01 = _mm256_set1_ps(mat.m[0][1]), m02 = _mm256_set1_ps(mat.m[0][2]), m03 = _mm256_set1_ps(mat.m[0][3]);
+        __m256 m10 = _mm256_set1_ps(mat.m[1][0]), m11 = _mm256_set1_ps(mat.m[1][1]), m12 = _mm256_set1_ps(mat.m[1][2]), m13 = _mm256_set1_ps(mat.m[1][3]);
+        __m256 m20 = _mm256_set1_ps(mat.m[2][0]), m21 = _mm256_set1_ps(mat.m[2][1]), m22 = _mm256_set1_ps(mat.m[2][2]), m23 = _mm256_set1_ps(mat.m[2][3]);
+
+        for(; i+8 <= count; i+=8) {
+            __m256 x = _mm256_loadu_ps(in.x + i);
+            __m256 y = _mm256_loadu_ps(in.y + i);
+            __m256 z = _mm256_loadu_ps(in.z + i);
+
+            __m256 rx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m00, x), _mm256_mul_ps(m01, y)), _mm256_add_ps(_mm256_mul_ps(m02, z), m03));
+            __m256 ry = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m10, x), _mm256_mul_ps(m11, y)), _mm256_add_ps(_mm256_mul_ps(m12, z), m13));
+            __m256 rz = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m20, x), _mm256_mul_ps(m21, y)), _mm256_add_ps(_mm256_mul_ps(m22, z), m23));
+
+            _mm256_storeu_ps(out.x + i, rx);
+            _mm256_storeu_ps(out.y + i, ry);
+            _mm256_storeu_ps(out.z + i, rz);
+        }
+    }
+#endif
+#if defined(MATH3D_SSE)
+    {
+        __m128 m00 = _mm_set1_ps(mat.m[0][0]), m01 = _mm_set1_ps(mat.m[0][1]), m02 = _mm_set1_ps(mat.m[0][2]), m03 = _mm_set1_ps(mat.m[0][3]);
+        __m128 m10 = _mm_set1_ps(mat.m[1][0]), m11 = _mm_set1_ps(mat.m[1][1]), m12 = _mm_set1_ps(mat.m[1][2]), m13 = _mm_set1_ps(mat.m[1][3]);
+        __m128 m20 = _mm_set1_ps(mat.m[2][0]), m21 = _mm_set1_ps(mat.m[2][1]), m22 = _mm_set1_ps(mat.m[2][2]), m23 = _mm_set1_ps(mat.m[2][3]);
+
+        for(; i+4 <= count; i+=4) {
+            __m128 x = _mm_loadu_ps(in.x + i);
+            __m128 y = _mm_loadu_ps(in.y + i);
+            __m128 z = _mm_loadu_ps(in.z + i);
+
+            __m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m01, y)), _mm_add_ps(_mm_mul_ps(m02, z), m03));
+            __m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m10, x), _mm_mul_ps(m11, y)), _mm_add_ps(_mm_mul_ps(m12, z), m13));
+            __m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m20, x), _mm_mul_ps(m21, y)), _mm_add_ps(_mm_mul_ps(m22, z), m23));
+
+            _mm_storeu_ps(out.x + i, rx);
+            _mm_storeu_ps(out.y + i, ry);
+            _mm_storeu_ps(out.z + i, rz);
+        }
+    }
+#endif
+    for(; i < count; ++i) {
+        float x = in.x[i], y = in.y[i], z = in.z[i];
+        out.x[i] = mat.m[0][0]*x + mat.m[0][1]*y + mat.m[0][2]*z + mat.m[0][3];
+        out.y[i] = mat.m[1][0]*x + mat.m[1][1]*y + mat.m[1][2]*z + mat.m[1][3];
+        out.z[i] = mat.m[2][0]*x + mat.m[2][1]*y + mat.m[2][2]*z + mat.m[2][3];
+    }
+}
+
+// Axis aligned bounds of a position stream. count must be > 0.
+inline void ComputeBounds(const Vector3fSoA& in, size_t count, Vector3f& outMin, Vector3f& outMax)
+{
+    float minX = in.x[0], minY = in.y[0], minZ = in.z[0];
+    float maxX = minX,    maxY = minY,    maxZ = minZ;
+    size_t i = 0;
+#if defined(MATH3D_SSE)
+    if(count >= 4) {
+        __m128 vMinX = _mm_loadu_ps(in.x), vMaxX = vMinX;
+        __m128 vMinY = _mm_loadu_ps(in.y), vMaxY = vMinY;
+        __m128 vMinZ = _mm_loadu_ps(in.z), vMaxZ = vMinZ;
+
+        for(i = 4; i+4 <= count; i+=4) {
+            __m128 x = _mm_loadu_ps(in.x + i);
+            __m128 y = _mm_loadu_ps(in.y + i);
+            __m128 z = _mm_loadu_ps(in.z + i);
+            vMinX = _mm_min_ps(vMinX, x); vMaxX = _mm_max_ps(vMaxX, x);
+            vMinY = _mm_min_ps(vMinY, y); vMaxY = _mm_max_ps(vMaxY, y);
+            vMinZ = _mm_min_ps(vMinZ, z); vMaxZ = _mm_max_ps(vMaxZ, z);
+        }
+
+        alignas(16) float lanes[6][4];
+        _mm_store_ps(lanes[0], vMinX); _mm_store_ps(lanes[1], vMinY); _mm_store_ps(lanes[2], vMinZ);
+        _mm_store_ps(lanes[3], vMaxX); _mm_store_ps(lanes[4], vMaxY); _mm_store_ps(lanes[5], vMaxZ);
+        for(int l=0; l<4; ++l) {
+            minX = fminf(minX, lanes[0][l]); minY = fminf(minY, lanes[1][l]); minZ = fminf(minZ, lanes[2][l]);
+            maxX = fmaxf(maxX, lanes[3][l]); maxY = fmaxf(maxY, lanes[4][l]); maxZ = fmaxf(maxZ, lanes[5][l]);
+        }
+    }
+#endif
+    for(; i < count; ++i) {
+        minX = fminf(minX, in.x[i]); maxX = fmaxf(maxX, in.x[i]);
+        minY = fminf(minY, in.y[i]); maxY = fmaxf(maxY, in.y[i]);
+        minZ = fminf(minZ, in.z[i]); maxZ = fmaxf(maxZ, in.z[i]);
+    }
+
+    outMin = Vector3f(minX, minY, minZ);
+    outMax = Vector3f(maxX, maxY, maxZ);
+}
+
+constexpr Matrix4f GetTranslationMatrix(float x, float y, float z)
 {
     Matrix4f mat = {};
     mat.m[0][0] = 1.0f; mat.m[0][3] = x;
@@ -82,24 +708,250 @@ inline Matrix4f GetTranslationMatrix(float x, float y, float z)
     return mat;
 }
 
-inline void InitIdentityMatrix4f(Matrix4f& mat)
+constexpr Matrix4f GetIdentityMatrix4f()
 {
+    Matrix4f mat = {};
     mat.m[0][0] = 1.0f;
     mat.m[1][1] = 1.0f;
     mat.m[2][2] = 1.0f;
     mat.m[3][3] = 1.0f;
+
+    return mat;
 }
 
-inline Matrix4f GetRotationMatrix(float x, float y, float z)
+constexpr void InitIdentityMatrix4f(Matrix4f& mat)
+{
+    mat.m[0][0] = 1.0f;
+    mat.m[1][1] = 1.0f;
+    mat.m[2][2] = 1.0f;
+    mat.m[3][3] = 1.0f;
+}
+
+// Falls back to identity for a singular matrix, use InverseMatrix4f to detect that case.
+inline Matrix4f Matrix4f::Inverse() const
 {
-    // TODO: Quaternions
     Matrix4f mat = {};
-    InitIdentityMatrix4f(mat);
+    if(!InverseMatrix4f(*this, mat)) {
+        InitIdentityMatrix4f(mat);
+    }
 
     return mat;
 }
 
-inline Matrix4f GetScaleMatrix(float x, float y, float z)
+// Unit quaternion rotation, 16 bytes instead of a 64 byte matrix.
+struct alignas(16) Quaternion
+{
+    float x;
+    float y;
+    float z;
+    float w;
+
+    constexpr Quaternion(): x(0.0f), y(0.0f), z(0.0f), w(1.0f) {}
+    constexpr Quaternion(float _x, float _y, float _z, float _w): x(_x), y(_y), z(_z), w(_w) {}
+
+    // Hamilton product, (a * b) applies b first and then a.
+    Quaternion operator* (const Quaternion& rq) const;
+
+    constexpr Quaternion Conjugate() const { return Quaternion(-x, -y, -z, w); }
+    Quaternion Normalize() const;
+    Vector3f Rotate(const Vector3f& v) const;
+    Matrix4f ToMatrix() const;
+};
+
+inline Quaternion Quaternion::operator* (const Quaternion& rq) const
+{
+    Quaternion ret;
+#if defined(MATH3D_SSE)
+    __m128 a = _mm_load_ps(&x);
+    __m128 b = _mm_load_ps(&rq.x);
+
+    __m128 bWZYX = _mm_mul_ps(MATH3D_SWIZZLE(b, 3,2,1,0), _mm_setr_ps( 1.0f, -1.0f,  1.0f, -1.0f));
+    __m128 bZWXY = _mm_mul_ps(MATH3D_SWIZZLE(b, 2,3,0,1), _mm_setr_ps( 1.0f,  1.0f, -1.0f, -1.0f));
+    __m128 bYXWZ = _mm_mul_ps(MATH3D_SWIZZLE(b, 1,0,3,2), _mm_setr_ps(-1.0f,  1.0f,  1.0f, -1.0f));
+
+    __m128 res = _mm_mul_ps(MATH3D_SWIZZLE(a, 3,3,3,3), b);
+    res = _mm_add_ps(res, _mm_mul_ps(MATH3D_SWIZZLE(a, 0,0,0,0), bWZYX));
+    res = _mm_add_ps(res, _mm_mul_ps(MATH3D_SWIZZLE(a, 1,1,1,1), bZWXY));
+    res = _mm_add_ps(res, _mm_mul_ps(MATH3D_SWIZZLE(a, 2,2,2,2), bYXWZ));
+    _mm_store_ps(&ret.x, res);
+#else
+    ret.x = w*rq.x + x*rq.w + y*rq.z - z*rq.y;
+    ret.y = w*rq.y - x*rq.z + y*rq.w + z*rq.x;
+    ret.z = w*rq.z + x*rq.y - y*rq.x + z*rq.w;
+    ret.w = w*rq.w - x*rq.x - y*rq.y - z*rq.z;
+#endif
+    return ret;
+}
+
+inline Quaternion Quaternion::Normalize() const
+{
+    float length = sqrtf(x*x + y*y + z*z + w*w);
+    if(length == 0) {
+        return Quaternion();
+    }
+
+    return Quaternion(x/length, y/length, z/length, w/length);
+}
+
+inline Vector3f Quaternion::Rotate(const Vector3f& v) const
+{
+    // v' = v + w*t + u x t, with t = 2 * (u x v)
+    float tx = 2.0f * (y*v.z - z*v.y);
+    float ty = 2.0f * (z*v.x - x*v.z);
+    float tz = 2.0f * (x*v.y - y*v.x);
+
+    return Vector3f(v.x + w*tx + (y*tz - z*ty),
+                    v.y + w*ty + (z*tx - x*tz),
+                    v.z + w*tz + (x*ty - y*tx));
+}
+
+// Scalar in every backend, the products share too few lanes to gain from SSE.
+inline Matrix4f Quaternion::ToMatrix() const
+{
+    float xx = x*x, yy = y*y, zz = z*z;
+    float xy = x*y, xz = x*z, yz = y*z;
+    float wx = w*x, wy = w*y, wz = w*z;
+
+    Matrix4f mat = {};
+    mat.m[0][0] = 1.0f - 2.0f*(yy + zz); mat.m[0][1] = 2.0f*(xy - wz);        mat.m[0][2] = 2.0f*(xz + wy);
+    mat.m[1][0] = 2.0f*(xy + wz);        mat.m[1][1] = 1.0f - 2.0f*(xx + zz); mat.m[1][2] = 2.0f*(yz - wx);
+    mat.m[2][0] = 2.0f*(xz - wy);        mat.m[2][1] = 2.0f*(yz + wx);        mat.m[2][2] = 1.0f - 2.0f*(xx + yy);
+    mat.m[3][3] = 1.0f;
+
+    return mat;
+}
+
+// axis must be normalized, angle is in radians.
+inline Quaternion GetAxisAngleQuaternion(const Vector3f& axis, float angle)
+{
+    float s = sinf(angle * 0.5f);
+    return Quaternion(axis.x * s, axis.y * s, axis.z * s, cosf(angle * 0.5f));
+}
+
+// Angles in degrees, applied in X, Y, Z order.
+inline Quaternion GetEulerQuaternion(float x, float y, float z)
+{
+    return GetAxisAngleQuaternion(Vector3f(0.0f, 0.0f, 1.0f), ToRadian(z)) *
+           GetAxisAngleQuaternion(Vector3f(0.0f, 1.0f, 0.0f), ToRadian(y)) *
+           GetAxisAngleQuaternion(Vector3f(1.0f, 0.0f, 0.0f), ToRadian(x));
+}
+
+constexpr float DotQuaternion(const Quaternion& a, const Quaternion& b)
+{
+    return a.x*b.x + a.y*b.y + a.z*b.z + a.w*b.w;
+}
+
+// Normalized linear interpolation along the shortest arc. Cheaper than Slerp
+// and good enough for small steps such as animation keys.
+inline Quaternion Nlerp(const Quaternion& a, const Quaternion& b, float t)
+{
+    Quaternion ret;
+    float wb = DotQuaternion(a, b) < 0.0f ? -t : t;
+#if defined(MATH3D_SSE)
+    __m128 res = _mm_add_ps(_mm_mul_ps(_mm_load_ps(&a.x), _mm_set1_ps(1.0f - t)),
+                            _mm_mul_ps(_mm_load_ps(&b.x), _mm_set1_ps(wb)));
+    __m128 sq = _mm_mul_ps(res, res);
+    sq = _mm_add_ps(sq, MATH3D_SWIZZLE(sq, 1,0,3,2));
+    sq = _mm_add_ps(sq, MATH3D_SWIZZLE(sq, 2,3,0,1));
+    _mm_store_ps(&ret.x, _mm_div_ps(res, _mm_sqrt_ps(sq)));
+#else
+    ret = Quaternion(a.x*(1.0f - t) + b.x*wb,
+                     a.y*(1.0f - t) + b.y*wb,
+                     a.z*(1.0f - t) + b.z*wb,
+                     a.w*(1.0f - t) + b.w*wb).Normalize();
+#endif
+    return ret;
+}
+
+// Constant angular velocity interpolation along the shortest arc.
+inline Quaternion Slerp(const Quaternion& a, const Quaternion& b, float t)
+{
+    float cosTheta = DotQuaternion(a, b);
+    float sign = 1.0f;
+    if(cosTheta < 0.0f) {
+        cosTheta = -cosTheta;
+        sign = -1.0f;
+    }
+
+    // Nearly parallel, the sine weights become unstable
+    if(cosTheta > 0.9995f) {
+        return Nlerp(a, b, t);
+    }
+
+    float theta = acosf(cosTheta);
+    float invSinTheta = 1.0f / sinf(theta);
+    float wa = sinf((1.0f - t) * theta) * invSinTheta;
+    float wb = sinf(t * theta) * invSinTheta * sign;
+
+    Quaternion ret;
+#if defined(MATH3D_SSE)
+    _mm_store_ps(&ret.x, _mm_add_ps(_mm_mul_ps(_mm_load_ps(&a.x), _mm_set1_ps(wa)),
+                                    _mm_mul_ps(_mm_load_ps(&b.x), _mm_set1_ps(wb))));
+#else
+    ret = Quaternion(a.x*wa + b.x*wb, a.y*wa + b.y*wb, a.z*wa + b.z*wb, a.w*wa + b.w*wb);
+#endif
+    return ret;
+}
+
+// Resolves world rotations of a hierarchy in one pass:
+// world[i] = world[parent[i]] * local[i], or local[i] for roots (parent < 0).
+// Parents must be stored before their children. Each entry depends on an
+// earlier one, so this is a convenience loop over operator* and not a batch.
+inline void ComposeQuaternionHierarchy(const int* parents, const Quaternion* local, Quaternion* world, size_t count)
+{
+    for(size_t i=0; i<count; ++i) {
+        world[i] = parents[i] < 0 ? local[i] : world[parents[i]] * local[i];
+    }
+}
+
+// out[i] = lq[i] * rq[i], out may be lq or rq. With SSE four products at a
+// time: transposed to x, y, z and w registers, the scalar formula on whole
+// registers, transposed back.
+inline void ComposeQuaternions(const Quaternion* lq, const Quaternion* rq, Quaternion* out, size_t count)
+{
+    size_t i = 0;
+#if defined(MATH3D_SSE)
+    for(; i + 4 <= count; i += 4) {
+        __m128 ax = _mm_load_ps(&lq[i].x), ay = _mm_load_ps(&lq[i + 1].x);
+        __m128 az = _mm_load_ps(&lq[i + 2].x), aw = _mm_load_ps(&lq[i + 3].x);
+        __m128 bx = _mm_load_ps(&rq[i].x), by = _mm_load_ps(&rq[i + 1].x);
+        __m128 bz = _mm_load_ps(&rq[i + 2].x), bw = _mm_load_ps(&rq[i + 3].x);
+        _MM_TRANSPOSE4_PS(ax, ay, az, aw);
+        _MM_TRANSPOSE4_PS(bx, by, bz, bw);
+
+        __m128 x = _mm_add_ps(_mm_add_ps(_mm_mul_ps(aw, bx), _mm_mul_ps(ax, bw)),
+                              _mm_sub_ps(_mm_mul_ps(ay, bz), _mm_mul_ps(az, by)));
+        __m128 y = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(aw, by), _mm_mul_ps(ax, bz)),
+                              _mm_add_ps(_mm_mul_ps(ay, bw), _mm_mul_ps(az, bx)));
+        __m128 z = _mm_add_ps(_mm_add_ps(_mm_mul_ps(aw, bz), _mm_mul_ps(ax, by)),
+                              _mm_sub_ps(_mm_mul_ps(az, bw), _mm_mul_ps(ay, bx)));
+        __m128 w = _mm_sub_ps(_mm_sub_ps(_mm_mul_ps(aw, bw), _mm_mul_ps(ax, bx)),
+                              _mm_add_ps(_mm_mul_ps(ay, by), _mm_mul_ps(az, bz)));
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+
+        _mm_store_ps(&out[i].x, x);
+        _mm_store_ps(&out[i + 1].x, y);
+        _mm_store_ps(&out[i + 2].x, z);
+        _mm_store_ps(&out[i + 3].x, w);
+    }
+#endif
+    for(; i<count; ++i) {
+        out[i] = lq[i] * rq[i];
+    }
+}
+
+inline Matrix4f GetRotationMatrix(const Quaternion& q)
+{
+    return q.ToMatrix();
+}
+
+// Angles in degrees, applied in X, Y, Z order.
+inline Matrix4f GetRotationMatrix(float x, float y, float z)
+{
+    return GetEulerQuaternion(x, y, z).ToMatrix();
+}
+
+constexpr Matrix4f GetScaleMatrix(float x, float y, float z)
 {
     Matrix4f mat = {};
     mat.m[0][0] = x;
@@ -128,13 +980,46 @@ inline Matrix4f GetPerspectiveProjectionMatrix(
     return mat;
 }
 
-/*
-inline Matrix4f GetCameraTransformationMatrix(CameraState& cameraState)
+// Reverse-Z projection with the far plane at infinity: depth is 1 at nearZ
+// and goes to 0 at infinity, so the depth test becomes GL_GREATER and the
+// depth buffer is cleared to 0. With a floating-point depth buffer
+// (GL_DEPTH_COMPONENT32F) its precision then tracks the 1/z distribution
+// instead of fighting it; a 24-bit UNORM buffer is evenly spaced and gains
+// next to nothing.
+// zeroToOne selects the clip space depth range: pass true when
+// glClipControl(GL_LOWER_LEFT, GL_ZERO_TO_ONE) is active (also needed for
+// the precision win), false for the default [-1, 1] range.
+inline Matrix4f GetReverseZInfinitePerspectiveMatrix(
+                        float aspectRatio,
+                        float fov,
+                        float nearZ,
+                        bool zeroToOne)
+{
+    Matrix4f mat = {};
+    float tanHalfFOV = tanf(fov/2.0f);
+
+    mat.m[0][0] = 1.0f / (aspectRatio * tanHalfFOV);
+    mat.m[1][1] = 1.0f / tanHalfFOV;
+    if(zeroToOne) {
+        // z_ndc = nearZ / z
+        mat.m[2][2] = 0.0f;
+        mat.m[2][3] = nearZ;
+    } else {
+        // z_ndc = 2 * nearZ / z - 1
+        mat.m[2][2] = -1.0f;
+        mat.m[2][3] = 2.0f*nearZ;
+    }
+    mat.m[3][2] = 1.0f;
+
+    return mat;
+}
+
+// target is the viewing direction, not a point.
+inline Matrix4f GetCameraTransformationMatrix(const Vector3f& pos, const Vector3f& target, const Vector3f& up)
 {
-    Vector3f pos = cameraState.pos;
-    Vector3f n = cameraState.target;
-    Vector3f u = cameraState.up.CrossProduct(n).Normalize(); // Left hand coordinate system
-    Vector3f v = u.CrossProduct(n).Normalize(); // Left hand coordination system!
+    Vector3f n = target.Normalize();
+    Vector3f u = up.CrossProduct(n).Normalize(); // Left hand coordinate system
+    Vector3f v = n.CrossProduct(u); // Left hand coordination system!
     
     Matrix4f cameraTranslationMatrix = {};
     InitIdentityMatrix4f(cameraTranslationMatrix);
@@ -152,6 +1037,5 @@ inline Matrix4f GetCameraTransformationMatrix(CameraState& cameraState)
     
     return camRotMat * cameraTranslationMatrix;
 }
-*/
 
 #endif
\ No newline at end of file
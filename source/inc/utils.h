@@ -4,7 +4,7 @@
 #include <string>
 #include <fstream>
 
-bool ReadFile(const std::string& fileName, std::string& outString)
+inline bool ReadFile(const std::string& fileName, std::string& outString)
 {
     std::ifstream file(fileName.c_str());
 
@@ -0,0 +1,118 @@
+#include "Camera.h"
+
+static bool Equal(const Vector3f& a, const Vector3f& b) {
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+Camera::Camera()
+    : aspectRatio(1.0f), fov(ToRadian(45.0f)), nearZ(0.1f), farZ(100.0f),
+      reverseZ(false), zeroToOneClip(false),
+      pos(0.0f, 0.0f, 0.0f), target(0.0f, 0.0f, 1.0f), up(0.0f, 1.0f, 0.0f),
+      projectionDirty(true), viewDirty(true), version(0), matrixUpdates(0) {
+}
+
+void Camera::SetPerspective(float aspectRatio, float fov, float nearZ, float farZ) {
+    if(this->aspectRatio == aspectRatio && this->fov == fov &&
+       this->nearZ == nearZ && this->farZ == farZ) {
+        return;
+    }
+
+    this->aspectRatio = aspectRatio;
+    this->fov = fov;
+    this->nearZ = nearZ;
+    this->farZ = farZ;
+    projectionDirty = true;
+    ++version;
+}
+
+void Camera::SetAspectRatio(float aspectRatio) {
+    SetPerspective(aspectRatio, fov, nearZ, farZ);
+}
+
+void Camera::SetReverseZ(bool enabled, bool zeroToOneClip) {
+    if(reverseZ == enabled && this->zeroToOneClip == zeroToOneClip) {
+        return;
+    }
+
+    reverseZ = enabled;
+    this->zeroToOneClip = zeroToOneClip;
+    projectionDirty = true;
+    ++version;
+}
+
+void Camera::SetPosition(const Vector3f& pos) {
+    if(Equal(this->pos, pos)) {
+        return;
+    }
+
+    this->pos = pos;
+    viewDirty = true;
+    ++version;
+}
+
+void Camera::SetOrientation(const Vector3f& target, const Vector3f& up) {
+    if(Equal(this->target, target) && Equal(this->up, up)) {
+        return;
+    }
+
+    this->target = target;
+    this->up = up;
+    viewDirty = true;
+    ++version;
+}
+
+const Matrix4f& Camera::GetProjectionMatrix() {
+    UpdateMatrices();
+    return projectionMat;
+}
+
+const Matrix4f& Camera::GetViewMatrix() {
+    UpdateMatrices();
+    return viewMat;
+}
+
+const Matrix4f& Camera::GetViewProjectionMatrix() {
+    UpdateMatrices();
+    return viewProjectionMat;
+}
+
+const Matrix4f& Camera::GetInverseProjectionMatrix() {
+    UpdateMatrices();
+    return invProjectionMat;
+}
+
+const Matrix4f& Camera::GetInverseViewMatrix() {
+    UpdateMatrices();
+    return invViewMat;
+}
+
+const Matrix4f& Camera::GetInverseViewProjectionMatrix() {
+    UpdateMatrices();
+    return invViewProjectionMat;
+}
+
+void Camera::UpdateMatrices() {
+    if(!projectionDirty && !viewDirty) {
+        return;
+    }
+
+    if(projectionDirty) {
+        if(reverseZ) {
+            projectionMat = GetReverseZInfinitePerspectiveMatrix(aspectRatio, fov, nearZ, zeroToOneClip);
+        } else {
+            projectionMat = GetPerspectiveProjectionMatrix(aspectRatio, fov, nearZ, farZ);
+        }
+        invProjectionMat = projectionMat.Inverse();
+    }
+    if(viewDirty) {
+        viewMat = GetCameraTransformationMatrix(pos, target, up);
+        invViewMat = viewMat.Inverse();
+    }
+
+    viewProjectionMat = projectionMat * viewMat;
+    invViewProjectionMat = invViewMat * invProjectionMat;
+
+    projectionDirty = false;
+    viewDirty = false;
+    ++matrixUpdates;
+}
@@ -0,0 +1,185 @@
+#include "Frustum.h"
+
+void BoundingBoxStream::Resize(size_t count) {
+    centerX.resize(count); centerY.resize(count); centerZ.resize(count);
+    extentX.resize(count); extentY.resize(count); extentZ.resize(count);
+}
+
+void BoundingBoxStream::Set(size_t i, const Vector3f& boxMin, const Vector3f& boxMax) {
+    centerX[i] = (boxMax.x + boxMin.x) * 0.5f;
+    centerY[i] = (boxMax.y + boxMin.y) * 0.5f;
+    centerZ[i] = (boxMax.z + boxMin.z) * 0.5f;
+    extentX[i] = (boxMax.x - boxMin.x) * 0.5f;
+    extentY[i] = (boxMax.y - boxMin.y) * 0.5f;
+    extentZ[i] = (boxMax.z - boxMin.z) * 0.5f;
+}
+
+void BoundingSphereStream::Resize(size_t count) {
+    centerX.resize(count); centerY.resize(count); centerZ.resize(count);
+    radius.resize(count);
+}
+
+void BoundingSphereStream::Set(size_t i, const Vector3f& center, float r) {
+    centerX[i] = center.x;
+    centerY[i] = center.y;
+    centerZ[i] = center.z;
+    radius[i] = r;
+}
+
+void Frustum::Extract(const Matrix4f& viewProjection) {
+    const float (*m)[4] = viewProjection.m;
+
+    for(int i=0; i<3; ++i) {
+        // row3 + row_i and row3 - row_i
+        planes[i*2]     = Vector4f(m[3][0] + m[i][0], m[3][1] + m[i][1], m[3][2] + m[i][2], m[3][3] + m[i][3]);
+        planes[i*2 + 1] = Vector4f(m[3][0] - m[i][0], m[3][1] - m[i][1], m[3][2] - m[i][2], m[3][3] - m[i][3]);
+    }
+
+    for(int i=0; i<6; ++i) {
+        Vector4f& p = planes[i];
+        float length = sqrtf(p.x*p.x + p.y*p.y + p.z*p.z);
+        if(length != 0) {
+            p = Vector4f(p.x/length, p.y/length, p.z/length, p.w/length);
+        }
+    }
+}
+
+bool Frustum::IsBoxVisible(const Vector3f& center, const Vector3f& extent) const {
+    for(int i=0; i<6; ++i) {
+        const Vector4f& p = planes[i];
+        float d = p.x*center.x + p.y*center.y + p.z*center.z + p.w;
+        float r = fabsf(p.x)*extent.x + fabsf(p.y)*extent.y + fabsf(p.z)*extent.z;
+        if(d + r < 0.0f) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Frustum::IsSphereVisible(const Vector3f& center, float radius) const {
+    for(int i=0; i<6; ++i) {
+        const Vector4f& p = planes[i];
+        if(p.x*center.x + p.y*center.y + p.z*center.z + p.w + radius < 0.0f) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Appends the lanes set in mask, branch free so that the compaction does not
+// depend on the (unpredictable) visibility pattern.
+static inline size_t CompactIndices(int mask, uint32 base, int lanes, uint32* out, size_t count) {
+    for(int lane=0; lane<lanes; ++lane) {
+        out[count] = base + lane;
+        count += (mask >> lane) & 1;
+    }
+    return count;
+}
+
+size_t Frustum::CullBoxes(const BoundingBoxStream& boxes, uint32* visibleIndices) const {
+    const size_t total = boxes.Size();
+    const float *cx = boxes.centerX.data(), *cy = boxes.centerY.data(), *cz = boxes.centerZ.data();
+    const float *ex = boxes.extentX.data(), *ey = boxes.extentY.data(), *ez = boxes.extentZ.data();
+    size_t visible = 0;
+    size_t i = 0;
+
+#if defined(MATH3D_AVX)
+    __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    for(; i+8 <= total; i+=8) {
+        __m256 x = _mm256_loadu_ps(cx + i), y = _mm256_loadu_ps(cy + i), z = _mm256_loadu_ps(cz + i);
+        __m256 hx = _mm256_loadu_ps(ex + i), hy = _mm256_loadu_ps(ey + i), hz = _mm256_loadu_ps(ez + i);
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+        for(int p=0; p<6; ++p) {
+            __m256 nx = _mm256_set1_ps(planes[p].x), ny = _mm256_set1_ps(planes[p].y), nz = _mm256_set1_ps(planes[p].z);
+            __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, x), _mm256_mul_ps(ny, y)),
+                                     _mm256_add_ps(_mm256_mul_ps(nz, z), _mm256_set1_ps(planes[p].w)));
+            __m256 r = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_and_ps(nx, absMask), hx),
+                                                   _mm256_mul_ps(_mm256_and_ps(ny, absMask), hy)),
+                                     _mm256_mul_ps(_mm256_and_ps(nz, absMask), hz));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(d, r), _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+
+        visible = CompactIndices(_mm256_movemask_ps(inside), (uint32)i, 8, visibleIndices, visible);
+    }
+#endif
+#if defined(MATH3D_SSE)
+    __m128 absMask4 = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    for(; i+4 <= total; i+=4) {
+        __m128 x = _mm_loadu_ps(cx + i), y = _mm_loadu_ps(cy + i), z = _mm_loadu_ps(cz + i);
+        __m128 hx = _mm_loadu_ps(ex + i), hy = _mm_loadu_ps(ey + i), hz = _mm_loadu_ps(ez + i);
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+        for(int p=0; p<6; ++p) {
+            __m128 nx = _mm_set1_ps(planes[p].x), ny = _mm_set1_ps(planes[p].y), nz = _mm_set1_ps(planes[p].z);
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, x), _mm_mul_ps(ny, y)),
+                                  _mm_add_ps(_mm_mul_ps(nz, z), _mm_set1_ps(planes[p].w)));
+            __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_and_ps(nx, absMask4), hx),
+                                             _mm_mul_ps(_mm_and_ps(ny, absMask4), hy)),
+                                  _mm_mul_ps(_mm_and_ps(nz, absMask4), hz));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(d, r), _mm_setzero_ps()));
+        }
+
+        visible = CompactIndices(_mm_movemask_ps(inside), (uint32)i, 4, visibleIndices, visible);
+    }
+#endif
+    for(; i < total; ++i) {
+        if(IsBoxVisible(Vector3f(cx[i], cy[i], cz[i]), Vector3f(ex[i], ey[i], ez[i]))) {
+            visibleIndices[visible++] = (uint32)i;
+        }
+    }
+
+    return visible;
+}
+
+size_t Frustum::CullSpheres(const BoundingSphereStream& spheres, uint32* visibleIndices) const {
+    const size_t total = spheres.Size();
+    const float *cx = spheres.centerX.data(), *cy = spheres.centerY.data(), *cz = spheres.centerZ.data();
+    const float *rad = spheres.radius.data();
+    size_t visible = 0;
+    size_t i = 0;
+
+#if defined(MATH3D_AVX)
+    for(; i+8 <= total; i+=8) {
+        __m256 x = _mm256_loadu_ps(cx + i), y = _mm256_loadu_ps(cy + i), z = _mm256_loadu_ps(cz + i);
+        __m256 r = _mm256_loadu_ps(rad + i);
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+        for(int p=0; p<6; ++p) {
+            __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(planes[p].x), x),
+                                                   _mm256_mul_ps(_mm256_set1_ps(planes[p].y), y)),
+                                     _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(planes[p].z), z),
+                                                   _mm256_set1_ps(planes[p].w)));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(d, r), _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+
+        visible = CompactIndices(_mm256_movemask_ps(inside), (uint32)i, 8, visibleIndices, visible);
+    }
+#endif
+#if defined(MATH3D_SSE)
+    for(; i+4 <= total; i+=4) {
+        __m128 x = _mm_loadu_ps(cx + i), y = _mm_loadu_ps(cy + i), z = _mm_loadu_ps(cz + i);
+        __m128 r = _mm_loadu_ps(rad + i);
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+        for(int p=0; p<6; ++p) {
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[p].x), x),
+                                             _mm_mul_ps(_mm_set1_ps(planes[p].y), y)),
+                                  _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[p].z), z),
+                                             _mm_set1_ps(planes[p].w)));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(d, r), _mm_setzero_ps()));
+        }
+
+        visible = CompactIndices(_mm_movemask_ps(inside), (uint32)i, 4, visibleIndices, visible);
+    }
+#endif
+    for(; i < total; ++i) {
+        if(IsSphereVisible(Vector3f(cx[i], cy[i], cz[i]), rad[i])) {
+            visibleIndices[visible++] = (uint32)i;
+        }
+    }
+
+    return visible;
+}
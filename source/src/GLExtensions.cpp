@@ -0,0 +1,98 @@
+#include <cstring>
+#include "GLExtensions.h"
+
+#ifdef GLEXT_LOADS_ARB_clip_control
+PFNGLCLIPCONTROLPROC glext_glClipControl = nullptr;
+#endif
+
+#ifdef GLEXT_LOADS_ARB_buffer_storage
+PFNGLBUFFERSTORAGEPROC glext_glBufferStorage = nullptr;
+#endif
+
+#ifdef GLEXT_LOADS_KHR_parallel_shader_compile
+PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glext_glMaxShaderCompilerThreadsKHR = nullptr;
+#endif
+
+#ifdef GLEXT_LOADS_ARB_separate_shader_objects
+PFNGLUSEPROGRAMSTAGESPROC glext_glUseProgramStages = nullptr;
+PFNGLACTIVESHADERPROGRAMPROC glext_glActiveShaderProgram = nullptr;
+PFNGLBINDPROGRAMPIPELINEPROC glext_glBindProgramPipeline = nullptr;
+PFNGLDELETEPROGRAMPIPELINESPROC glext_glDeleteProgramPipelines = nullptr;
+PFNGLGENPROGRAMPIPELINESPROC glext_glGenProgramPipelines = nullptr;
+PFNGLVALIDATEPROGRAMPIPELINEPROC glext_glValidateProgramPipeline = nullptr;
+PFNGLGETPROGRAMPIPELINEIVPROC glext_glGetProgramPipelineiv = nullptr;
+PFNGLGETPROGRAMPIPELINEINFOLOGPROC glext_glGetProgramPipelineInfoLog = nullptr;
+#endif
+
+int GLEXT_ARB_clip_control = 0;
+int GLEXT_ARB_buffer_storage = 0;
+int GLEXT_ARB_get_program_binary = 0;
+int GLEXT_ARB_separate_shader_objects = 0;
+int GLEXT_KHR_parallel_shader_compile = 0;
+int GLEXT_EXT_texture_compression_s3tc = 0;
+int GLEXT_ARB_texture_compression_bptc = 0;
+int GLEXT_ARB_ES3_compatibility = 0;
+
+bool HasGLExtension(const char *name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for(GLint i=0; i<count; ++i) {
+        const char *ext = (const char *)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+        if(ext && strcmp(ext, name) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool HasGLVersion(int major, int minor) {
+    GLint contextMajor = 0, contextMinor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &contextMajor);
+    glGetIntegerv(GL_MINOR_VERSION, &contextMinor);
+
+    return contextMajor > major || (contextMajor == major && contextMinor >= minor);
+}
+
+void LoadGLExtensions(GLADloadproc load) {
+    if(HasGLVersion(4, 5) || HasGLExtension("GL_ARB_clip_control")) {
+        glClipControl = (PFNGLCLIPCONTROLPROC)load("glClipControl");
+        GLEXT_ARB_clip_control = glClipControl != nullptr;
+    }
+    if(HasGLVersion(4, 4) || HasGLExtension("GL_ARB_buffer_storage")) {
+        glBufferStorage = (PFNGLBUFFERSTORAGEPROC)load("glBufferStorage");
+        GLEXT_ARB_buffer_storage = glBufferStorage != nullptr;
+    }
+    if(HasGLVersion(4, 1) || HasGLExtension("GL_ARB_get_program_binary")) {
+        glad_glGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC)load("glGetProgramBinary");
+        glad_glProgramBinary = (PFNGLPROGRAMBINARYPROC)load("glProgramBinary");
+        glad_glProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)load("glProgramParameteri");
+        GLEXT_ARB_get_program_binary = glGetProgramBinary && glProgramBinary && glProgramParameteri;
+    }
+    if(HasGLVersion(4, 1) || HasGLExtension("GL_ARB_separate_shader_objects")) {
+        glUseProgramStages = (PFNGLUSEPROGRAMSTAGESPROC)load("glUseProgramStages");
+        glActiveShaderProgram = (PFNGLACTIVESHADERPROGRAMPROC)load("glActiveShaderProgram");
+        glBindProgramPipeline = (PFNGLBINDPROGRAMPIPELINEPROC)load("glBindProgramPipeline");
+        glDeleteProgramPipelines = (PFNGLDELETEPROGRAMPIPELINESPROC)load("glDeleteProgramPipelines");
+        glGenProgramPipelines = (PFNGLGENPROGRAMPIPELINESPROC)load("glGenProgramPipelines");
+        glValidateProgramPipeline = (PFNGLVALIDATEPROGRAMPIPELINEPROC)load("glValidateProgramPipeline");
+        glGetProgramPipelineiv = (PFNGLGETPROGRAMPIPELINEIVPROC)load("glGetProgramPipelineiv");
+        glGetProgramPipelineInfoLog = (PFNGLGETPROGRAMPIPELINEINFOLOGPROC)load("glGetProgramPipelineInfoLog");
+        if(!glProgramParameteri) {
+            glad_glProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)load("glProgramParameteri");
+        }
+        GLEXT_ARB_separate_shader_objects = glUseProgramStages && glActiveShaderProgram && glBindProgramPipeline &&
+            glDeleteProgramPipelines && glGenProgramPipelines && glValidateProgramPipeline && glProgramParameteri;
+    }
+    if(HasGLExtension("GL_KHR_parallel_shader_compile")) {
+        glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsKHR");
+    } else if(HasGLExtension("GL_ARB_parallel_shader_compile")) {
+        glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC)load("glMaxShaderCompilerThreadsARB");
+    }
+    GLEXT_KHR_parallel_shader_compile = glMaxShaderCompilerThreadsKHR != nullptr;
+
+    // Format support only, no entry points to load
+    GLEXT_EXT_texture_compression_s3tc = HasGLExtension("GL_EXT_texture_compression_s3tc");
+    GLEXT_ARB_texture_compression_bptc = HasGLVersion(4, 2) || HasGLExtension("GL_ARB_texture_compression_bptc");
+    GLEXT_ARB_ES3_compatibility = HasGLVersion(4, 3) || HasGLExtension("GL_ARB_ES3_compatibility");
+}
@@ -0,0 +1,262 @@
+#include <cmath>
+#include <cstring>
+#include "MipGenerator.h"
+
+// MIPGENERATOR_NO_SIMD forces the scalar path, the tests build both
+#if !defined(MIPGENERATOR_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define MIPGENERATOR_SSE2 1
+#endif
+
+// One RGBA texel of the float working images
+#ifdef MIPGENERATOR_SSE2
+typedef __m128 Texel;
+
+static inline Texel LoadTexel(const float *texel) { return _mm_loadu_ps(texel); }
+static inline void StoreTexel(float *texel, Texel value) { _mm_storeu_ps(texel, value); }
+static inline Texel ZeroTexel() { return _mm_setzero_ps(); }
+static inline Texel AddTexels(Texel a, Texel b) { return _mm_add_ps(a, b); }
+static inline Texel ScaleTexel(Texel value, float scale) { return _mm_mul_ps(value, _mm_set1_ps(scale)); }
+#else
+struct Texel {
+    float value[4];
+};
+
+static inline Texel LoadTexel(const float *texel) { Texel result; memcpy(result.value, texel, sizeof(result.value)); return result; }
+static inline void StoreTexel(float *texel, Texel value) { memcpy(texel, value.value, sizeof(value.value)); }
+static inline Texel ZeroTexel() { return Texel {}; }
+static inline Texel AddTexels(Texel a, Texel b) {
+    for(uint32 c = 0; c < 4; c++) {
+        a.value[c] += b.value[c];
+    }
+    return a;
+}
+static inline Texel ScaleTexel(Texel value, float scale) {
+    for(uint32 c = 0; c < 4; c++) {
+        value.value[c] *= scale;
+    }
+    return value;
+}
+#endif
+
+// Linear values are quantized to this many steps on the way back to sRGB,
+// well below the 8-bit output precision even in the darks
+const uint32 SRGB_ENCODE_STEPS = 4096;
+
+struct ConversionTables {
+    float srgbToLinear[256];
+    float unormToFloat[256];
+    uint8 linearToSRGB[SRGB_ENCODE_STEPS];
+
+    ConversionTables() {
+        for(uint32 i = 0; i < 256; i++) {
+            float value = i / 255.0f;
+            srgbToLinear[i] = value <= 0.04045f ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+            unormToFloat[i] = value;
+        }
+        for(uint32 i = 0; i < SRGB_ENCODE_STEPS; i++) {
+            float value = i / (float)(SRGB_ENCODE_STEPS - 1);
+            value = value <= 0.0031308f ? value * 12.92f : 1.055f * powf(value, 1.0f / 2.4f) - 0.055f;
+            linearToSRGB[i] = (uint8)(value * 255.0f + 0.5f);
+        }
+    }
+};
+
+static const ConversionTables& GetConversionTables() {
+    static const ConversionTables tables;
+    return tables;
+}
+
+// Kaiser windowed sinc for a 2:1 reduction. Tap k of destination texel x
+// reads source texel 2x - 3 + k.
+const uint32 KAISER_TAPS = 8;
+
+static double BesselI0(double x) {
+    double sum = 1.0, term = 1.0;
+    for(uint32 k = 1; k < 32; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+struct KaiserWeights {
+    float weights[KAISER_TAPS];
+
+    KaiserWeights() {
+        const double PI = 3.14159265358979323846;
+        const double WIDTH = 2.0, ALPHA = 4.0;
+        double sum = 0.0;
+        double raw[KAISER_TAPS];
+        for(uint32 k = 0; k < KAISER_TAPS; k++) {
+            // Distance from the destination texel's centre, in destination texels
+            double d = (k - (KAISER_TAPS - 1) / 2.0) / 2.0;
+            double sinc = sin(PI * d) / (PI * d);
+            double ratio = d / WIDTH;
+            raw[k] = sinc * BesselI0(ALPHA * sqrt(1.0 - ratio * ratio)) / BesselI0(ALPHA);
+            sum += raw[k];
+        }
+        for(uint32 k = 0; k < KAISER_TAPS; k++) {
+            weights[k] = (float)(raw[k] / sum);
+        }
+    }
+};
+
+static const KaiserWeights& GetKaiserWeights() {
+    static const KaiserWeights weights;
+    return weights;
+}
+
+struct FloatImage {
+    uint32 width;
+    uint32 height;
+    std::vector<float> texels;   // RGBA
+
+    const float *GetTexel(uint32 x, uint32 y) const { return &texels[((size_t)y * width + x) * 4]; }
+    float *GetTexel(uint32 x, uint32 y) { return &texels[((size_t)y * width + x) * 4]; }
+};
+
+static FloatImage Decode(const uint8 *pixels, uint32 width, uint32 height, uint32 channels, bool srgb) {
+    const ConversionTables& tables = GetConversionTables();
+    const float *colorTable = srgb ? tables.srgbToLinear : tables.unormToFloat;
+
+    FloatImage image = { width, height, std::vector<float>((size_t)width * height * 4) };
+    for(size_t i = 0; i < (size_t)width * height; i++) {
+        const uint8 *source = pixels + i * channels;
+        float *texel = &image.texels[i * 4];
+        texel[0] = colorTable[source[0]];
+        texel[1] = colorTable[source[1]];
+        texel[2] = colorTable[source[2]];
+        texel[3] = channels == 4 ? tables.unormToFloat[source[3]] : 1.0f;
+    }
+    return image;
+}
+
+static void Encode(const FloatImage& image, uint32 channels, bool srgb, std::vector<uint8>& pixels) {
+    const ConversionTables& tables = GetConversionTables();
+    float colorScale = srgb ? SRGB_ENCODE_STEPS - 1.0f : 255.0f;
+
+    pixels.resize((size_t)image.width * image.height * channels);
+    for(size_t i = 0; i < (size_t)image.width * image.height; i++) {
+        const float *texel = &image.texels[i * 4];
+        int32 quantized[4];
+#ifdef MIPGENERATOR_SSE2
+        // Sharper filters overshoot, clamp before quantizing
+        __m128 value = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(texel), _mm_setzero_ps()), _mm_set1_ps(1.0f));
+        value = _mm_mul_ps(value, _mm_set_ps(255.0f, colorScale, colorScale, colorScale));
+        // Round half up and truncate like the scalar path, _mm_cvtps_epi32
+        // would round half to even and disagree on exact halves
+        value = _mm_add_ps(value, _mm_set1_ps(0.5f));
+        _mm_storeu_si128((__m128i *)quantized, _mm_cvttps_epi32(value));
+#else
+        for(uint32 c = 0; c < 4; c++) {
+            float value = texel[c] < 0.0f ? 0.0f : texel[c] > 1.0f ? 1.0f : texel[c];
+            quantized[c] = (int32)(value * (c == 3 ? 255.0f : colorScale) + 0.5f);
+        }
+#endif
+
+        uint8 *target = &pixels[i * channels];
+        for(uint32 c = 0; c < 3; c++) {
+            target[c] = srgb ? tables.linearToSRGB[quantized[c]] : (uint8)quantized[c];
+        }
+        if(channels == 4) {
+            target[3] = (uint8)quantized[3];
+        }
+    }
+}
+
+static FloatImage DownsampleBox(const FloatImage& source) {
+    FloatImage result;
+    result.width = source.width > 1 ? source.width / 2 : 1;
+    result.height = source.height > 1 ? source.height / 2 : 1;
+    result.texels.resize((size_t)result.width * result.height * 4);
+
+    for(uint32 y = 0; y < result.height; y++) {
+        uint32 y0 = y * 2, y1 = y0 + 1 < source.height ? y0 + 1 : y0;
+        for(uint32 x = 0; x < result.width; x++) {
+            uint32 x0 = x * 2, x1 = x0 + 1 < source.width ? x0 + 1 : x0;
+            Texel sum = AddTexels(AddTexels(LoadTexel(source.GetTexel(x0, y0)), LoadTexel(source.GetTexel(x1, y0))),
+                                  AddTexels(LoadTexel(source.GetTexel(x0, y1)), LoadTexel(source.GetTexel(x1, y1))));
+            StoreTexel(result.GetTexel(x, y), ScaleTexel(sum, 0.25f));
+        }
+    }
+
+    return result;
+}
+
+// One separable Kaiser pass, halving the width. Edge texels are repeated.
+static FloatImage DownsampleKaiserRows(const FloatImage& source) {
+    if(source.width == 1) {
+        return source;
+    }
+
+    const float *weights = GetKaiserWeights().weights;
+    FloatImage result;
+    result.width = source.width / 2;
+    result.height = source.height;
+    result.texels.resize((size_t)result.width * result.height * 4);
+
+    for(uint32 y = 0; y < result.height; y++) {
+        for(uint32 x = 0; x < result.width; x++) {
+            Texel sum = ZeroTexel();
+            for(uint32 k = 0; k < KAISER_TAPS; k++) {
+                int32 sx = (int32)(x * 2 + k) - 3;
+                sx = sx < 0 ? 0 : sx >= (int32)source.width ? (int32)source.width - 1 : sx;
+                sum = AddTexels(sum, ScaleTexel(LoadTexel(source.GetTexel((uint32)sx, y)), weights[k]));
+            }
+            StoreTexel(result.GetTexel(x, y), sum);
+        }
+    }
+
+    return result;
+}
+
+// Same as DownsampleKaiserRows, halving the height. Whole rows are
+// accumulated at once to walk memory in order.
+static FloatImage DownsampleKaiserColumns(const FloatImage& source) {
+    if(source.height == 1) {
+        return source;
+    }
+
+    const float *weights = GetKaiserWeights().weights;
+    FloatImage result;
+    result.width = source.width;
+    result.height = source.height / 2;
+    result.texels.assign((size_t)result.width * result.height * 4, 0.0f);
+
+    for(uint32 y = 0; y < result.height; y++) {
+        float *target = result.GetTexel(0, y);
+        for(uint32 k = 0; k < KAISER_TAPS; k++) {
+            int32 sy = (int32)(y * 2 + k) - 3;
+            sy = sy < 0 ? 0 : sy >= (int32)source.height ? (int32)source.height - 1 : sy;
+            const float *row = source.GetTexel(0, (uint32)sy);
+            for(uint32 x = 0; x < result.width; x++) {
+                StoreTexel(target + x * 4, AddTexels(LoadTexel(target + x * 4), ScaleTexel(LoadTexel(row + x * 4), weights[k])));
+            }
+        }
+    }
+
+    return result;
+}
+
+std::vector<MipLevel> GenerateMipChain(const uint8 *pixels, uint32 width, uint32 height, uint32 channels, bool srgb,
+                                       MipFilter filter) {
+    std::vector<MipLevel> levels;
+    levels.push_back(MipLevel { width, height, std::vector<uint8>(pixels, pixels + (size_t)width * height * channels) });
+
+    // Each level is filtered from the float copy of the one above, so the
+    // 8-bit rounding doesn't accumulate down the chain
+    FloatImage image = Decode(pixels, width, height, channels, srgb);
+    while(image.width > 1 || image.height > 1) {
+        if(filter == MIP_FILTER_KAISER) {
+            image = DownsampleKaiserColumns(DownsampleKaiserRows(image));
+        } else {
+            image = DownsampleBox(image);
+        }
+
+        levels.push_back(MipLevel { image.width, image.height, std::vector<uint8>() });
+        Encode(image, channels, srgb, levels.back().pixels);
+    }
+
+    return levels;
+}
@@ -0,0 +1,40 @@
+#include <algorithm>
+#include "PixelUploadRing.h"
+
+// Keeps every copy cache line aligned
+static const uint32 UPLOAD_ALIGNMENT = 64;
+
+PixelUploadRing::PixelUploadRing(uint32 frameSize, uint32 framesInFlight)
+    : streamedBytes(0), directBytes(0), segments(GL_PIXEL_UNPACK_BUFFER, frameSize, framesInFlight, UPLOAD_ALIGNMENT) {
+}
+
+void PixelUploadRing::Upload(int32 level, int32 width, int32 height, uint32 format, uint32 bytesPerPixel, const uint8 *pixels) {
+    const uint32 rowSize = (uint32)width * bytesPerPixel;
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // As many whole rows as still fit the segment per glTexSubImage2D
+    int32 y = 0;
+    while(y < height) {
+        int32 rows = std::min((int32)(segments.GetFreeBytes() / rowSize), height - y);
+        if(rows == 0) {
+            break;
+        }
+
+        uint32 size = (uint32)rows * rowSize;
+        int64 bufferOffset = segments.Allocate(pixels + (size_t)y * rowSize, size);
+        if(bufferOffset < 0) {
+            break;
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, segments.GetBuffer());
+        glTexSubImage2D(GL_TEXTURE_2D, level, 0, y, width, rows, format, GL_UNSIGNED_BYTE, (const void *)(size_t)bufferOffset);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        streamedBytes += size;
+        y += rows;
+    }
+
+    if(y < height) {
+        glTexSubImage2D(GL_TEXTURE_2D, level, 0, y, width, height - y, format, GL_UNSIGNED_BYTE, pixels + (size_t)y * rowSize);
+        directBytes += (uint64)(height - y) * rowSize;
+    }
+}
@@ -0,0 +1,147 @@
+#include <cstdio>
+#include <vector>
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif
+#include "ProgramBinaryCache.h"
+#include "GLExtensions.h"
+#include "Hash.h"
+
+static const uint32 PROGRAM_BINARY_MAGIC = 0x4E494250; // "PBIN"
+static const uint32 PROGRAM_BINARY_VERSION = 1;
+
+struct ProgramBinaryHeader {
+    uint32 magic;
+    uint32 version;
+    uint64 key;
+    uint32 format;
+    uint32 length;
+};
+
+static const char *GetGLString(GLenum name) {
+    const char *str = (const char *)glGetString(name);
+    return str ? str : "";
+}
+
+ProgramBinaryCache::ProgramBinaryCache(const std::string& directory)
+    : hits(0), misses(0), hitMilliseconds(0.0), missMilliseconds(0.0),
+      directory(directory), driverHash(0), supported(false) {
+
+    GLint formats = 0;
+    if(GLEXT_ARB_get_program_binary) {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    }
+    supported = formats > 0;
+
+    driverHash = HashString(GetGLString(GL_VENDOR));
+    driverHash = HashString(GetGLString(GL_RENDERER), driverHash);
+    driverHash = HashString(GetGLString(GL_VERSION), driverHash);
+
+#ifdef _WIN32
+    _mkdir(directory.c_str());
+#else
+    mkdir(directory.c_str(), 0755);
+#endif
+}
+
+uint64 ProgramBinaryCache::GetKey(const char *vertexShader, const char *fragmentShader) const {
+    uint64 key = HashString(vertexShader, driverHash);
+    return HashString(fragmentShader, key);
+}
+
+std::string ProgramBinaryCache::GetPath(uint64 key) const {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", key);
+    return directory + "/" + name;
+}
+
+bool ProgramBinaryCache::Load(uint64 key, uint32 program) {
+    if(!supported) {
+        return false;
+    }
+
+    FILE *file = fopen(GetPath(key).c_str(), "rb");
+    if(!file) {
+        return false;
+    }
+
+    // The length in the header is only trusted if it is exactly what
+    // follows it, a corrupt entry must not size the allocation
+    fseek(file, 0, SEEK_END);
+    long fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    ProgramBinaryHeader header;
+    std::vector<uint8> binary;
+    bool valid = fileSize > (long)sizeof(header) &&
+                 fread(&header, sizeof(header), 1, file) == 1 &&
+                 header.magic == PROGRAM_BINARY_MAGIC &&
+                 header.version == PROGRAM_BINARY_VERSION &&
+                 header.key == key &&
+                 header.length == (uint64)(fileSize - (long)sizeof(header));
+    if(valid) {
+        binary.resize(header.length);
+        valid = fread(binary.data(), 1, binary.size(), file) == binary.size();
+    }
+    fclose(file);
+
+    if(!valid) {
+        return false;
+    }
+
+    glProgramBinary(program, header.format, binary.data(), (GLsizei)binary.size());
+
+    // Drivers reject binaries from other versions/configurations here
+    GLint status = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    return status != 0;
+}
+
+void ProgramBinaryCache::Save(uint64 key, uint32 program) {
+    if(!supported) {
+        return;
+    }
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if(length <= 0) {
+        return;
+    }
+
+    std::vector<uint8> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, nullptr, &format, binary.data());
+
+    ProgramBinaryHeader header;
+    header.magic = PROGRAM_BINARY_MAGIC;
+    header.version = PROGRAM_BINARY_VERSION;
+    header.key = key;
+    header.format = format;
+    header.length = (uint32)length;
+
+    // Write to a temporary file first so a crash never leaves a torn entry
+    std::string path = GetPath(key);
+    std::string tempPath = path + ".tmp";
+    FILE *file = fopen(tempPath.c_str(), "wb");
+    if(!file) {
+        return;
+    }
+
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   fwrite(binary.data(), 1, binary.size(), file) == binary.size();
+    fclose(file);
+
+    if(written) {
+        remove(path.c_str());
+        rename(tempPath.c_str(), path.c_str());
+    } else {
+        remove(tempPath.c_str());
+    }
+}
+
+void ProgramBinaryCache::PrintStats() const {
+    printf("Program cache: %u hits (%.2f ms), %u misses (%.2f ms)\n",
+           hits, hitMilliseconds, misses, missMilliseconds);
+}
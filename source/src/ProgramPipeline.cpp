@@ -0,0 +1,102 @@
+#include <cstdio>
+#include <cstdlib>
+#include "ProgramPipeline.h"
+#include "GLExtensions.h"
+#include "Hash.h"
+#include "Shader.h"
+#include "ShaderCompileQueue.h"
+
+ProgramPipeline::ProgramPipeline()
+    : ID(0), stageChanges(0), vertexStage{ GL_VERTEX_SHADER_BIT, nullptr, 0 },
+      fragmentStage{ GL_FRAGMENT_SHADER_BIT, nullptr, 0 }, activeStage(nullptr), activeVersion(0) {
+    glGenProgramPipelines(1, &ID);
+}
+
+ProgramPipeline::~ProgramPipeline() {
+    glDeleteProgramPipelines(1, &ID);
+}
+
+void ProgramPipeline::AttachStage(Stage& stage, Shader *shader) {
+    if(shader && !shader->EnsureReady()) {
+        exit(1);
+    }
+
+    glUseProgramStages(ID, stage.bit, shader ? shader->ID : 0);
+    stage.shader = shader;
+    stage.version = shader ? shader->GetVersion() : 0;
+    stageChanges++;
+}
+
+void ProgramPipeline::SetStage(Stage& stage, Shader *shader) {
+    if(shader != stage.shader || (shader && shader->GetVersion() != stage.version)) {
+        AttachStage(stage, shader);
+    }
+}
+
+void ProgramPipeline::SetVertexStage(Shader *stage) {
+    SetStage(vertexStage, stage);
+}
+
+void ProgramPipeline::SetFragmentStage(Shader *stage) {
+    SetStage(fragmentStage, stage);
+}
+
+void ProgramPipeline::Bind() {
+    // A Swap leaves the pipeline pointing at the old, deleted program
+    SetStage(vertexStage, vertexStage.shader);
+    SetStage(fragmentStage, fragmentStage.shader);
+    SetActiveStage(activeStage);
+
+    glUseProgram(0);
+    glBindProgramPipeline(ID);
+}
+
+void ProgramPipeline::SetActiveStage(Shader *stage) {
+    if(stage != activeStage || (stage && stage->GetVersion() != activeVersion)) {
+        glActiveShaderProgram(ID, stage ? stage->ID : 0);
+        activeStage = stage;
+        activeVersion = stage ? stage->GetVersion() : 0;
+    }
+}
+
+bool ProgramPipeline::Validate() {
+    GLint status = 0;
+    glValidateProgramPipeline(ID);
+    glGetProgramPipelineiv(ID, GL_VALIDATE_STATUS, &status);
+
+    if(!status) {
+        char log[1024] = "";
+        glGetProgramPipelineInfoLog(ID, sizeof(log), nullptr, log);
+        fprintf(stderr, "Program pipeline failed to validate:\n%s\n", log);
+    }
+
+    return status != 0;
+}
+
+ShaderStageCache::ShaderStageCache(ProgramBinaryCache *binaryCache, ShaderCompileQueue *compileQueue)
+    : binaryCache(binaryCache), compileQueue(compileQueue) {
+}
+
+ShaderStageCache::~ShaderStageCache() {
+    for(auto& entry : stages) {
+        delete entry.second;
+    }
+}
+
+Shader *ShaderStageCache::GetStage(uint32 stage, const char *source) {
+    uint64 key = HashBytes(&stage, sizeof(stage));
+    key = HashString(source, key);
+
+    auto it = stages.find(key);
+    if(it != stages.end()) {
+        return it->second;
+    }
+
+    Shader *shader = new Shader(stage, source, binaryCache);
+    if(compileQueue) {
+        compileQueue->Add(shader);
+    }
+
+    stages[key] = shader;
+    return shader;
+}
@@ -0,0 +1,87 @@
+#include <cstring>
+#include "SegmentedBuffer.h"
+#include "GLExtensions.h"
+
+SegmentedBuffer::SegmentedBuffer(uint32 target, uint32 frameSize, uint32 framesInFlight, uint32 alignment)
+    : target(target), buffer(0), mapped(nullptr), alignment(alignment),
+      frameSize((frameSize + alignment - 1) / alignment * alignment), framesInFlight(framesInFlight), frameIndex(0),
+      offset(0), fences(framesInFlight, nullptr) {
+
+    GLsizeiptr totalSize = (GLsizeiptr)this->frameSize * framesInFlight;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(target, buffer);
+
+    if(GLEXT_ARB_buffer_storage) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(target, totalSize, nullptr, flags);
+        mapped = (uint8 *)glMapBufferRange(target, 0, totalSize, flags);
+    } else {
+        glBufferData(target, totalSize, nullptr, GL_STREAM_DRAW);
+    }
+
+    // Nothing stays bound: a bound unpack buffer, for one, would turn every
+    // other glTex*Image pointer into an offset
+    glBindBuffer(target, 0);
+}
+
+SegmentedBuffer::~SegmentedBuffer() {
+    for(GLsync fence : fences) {
+        if(fence) {
+            glDeleteSync(fence);
+        }
+    }
+
+    if(mapped) {
+        glBindBuffer(target, buffer);
+        glUnmapBuffer(target);
+        glBindBuffer(target, 0);
+    }
+    glDeleteBuffers(1, &buffer);
+}
+
+void SegmentedBuffer::BeginFrame() {
+    frameIndex = (frameIndex + 1) % framesInFlight;
+    offset = 0;
+
+    GLsync& fence = fences[frameIndex];
+    if(fence) {
+        glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+}
+
+void SegmentedBuffer::EndFrame() {
+    GLsync& fence = fences[frameIndex];
+    if(fence) {
+        glDeleteSync(fence);
+    }
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+int64 SegmentedBuffer::Allocate(const void *data, uint32 size) {
+    if(size > GetFreeBytes()) {
+        return -1;
+    }
+
+    uint32 bufferOffset = frameIndex * frameSize + offset;
+    if(mapped) {
+        memcpy(mapped + bufferOffset, data, size);
+    } else {
+        // The fence in BeginFrame already guarantees the GPU is done with this range
+        glBindBuffer(target, buffer);
+        void *dst = glMapBufferRange(target, bufferOffset, size,
+                                     GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+        if(dst) {
+            memcpy(dst, data, size);
+            glUnmapBuffer(target);
+        }
+        glBindBuffer(target, 0);
+        if(!dst) {
+            return -1;
+        }
+    }
+
+    offset = (offset + size + alignment - 1) / alignment * alignment;
+    return bufferOffset;
+}
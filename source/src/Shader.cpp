@@ -1,64 +1,458 @@
+#include <chrono>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
 #include "Shader.h"
-#include "glad/glad.h"
+#include "GLExtensions.h"
+#include "ProgramBinaryCache.h"
+#include "ShaderReflection.h"
 
-Shader::Shader(const char *vertexShader, const char *fragmentShader) {
+static ShaderCompileStats compileStats = {};
 
-    uint32 vertex, fragment;
-    vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vertexShader, nullptr);
-    glCompileShader(vertex);
+const ShaderCompileStats& GetShaderCompileStats() {
+    return compileStats;
+}
 
-    GLint success;
-    glGetShaderiv(vertex, GL_COMPILE_STATUS, &success);
+static double GetMilliseconds() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
+static bool CheckShader(uint32 shader, const char *stage) {
+    if(!shader) {
+        return true;
+    }
+
+    GLint success = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
     if(!success) {
-        exit(1);
+        char log[1024];
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        fprintf(stderr, "Failed to compile %s shader:\n%s\n", stage, log);
     }
 
-    fragment = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(fragment, 1, &fragmentShader, nullptr);
-    glCompileShader(fragment);
+    return success != 0;
+}
 
-    glGetShaderiv(fragment, GL_COMPILE_STATUS, &success);
+Shader::Shader(const char *vertexShader, const char *fragmentShader, ProgramBinaryCache *cache)
+    : state(SHADER_COMPILING), version(0), separable(false), vertex(0), fragment(0), cache(cache), cacheKey(0),
+      buildMilliseconds(0) {
+    Build(vertexShader, fragmentShader);
+}
 
-    if(!success) {
-        exit(1);
+Shader::Shader(uint32 stage, const char *source, ProgramBinaryCache *cache)
+    : state(SHADER_COMPILING), version(0), separable(true), vertex(0), fragment(0), cache(cache), cacheKey(0),
+      buildMilliseconds(0) {
+    if(stage == GL_VERTEX_SHADER) {
+        Build(source, nullptr);
+    } else {
+        Build(nullptr, source);
     }
+}
+
+static uint32 CompileShader(uint32 type, const char *source) {
+    uint32 shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    return shader;
+}
+
+void Shader::Build(const char *vertexShader, const char *fragmentShader) {
+    double startTime = GetMilliseconds();
+    compileStats.programs++;
 
     ID = glCreateProgram();
-    glAttachShader(ID, vertex);
-    glAttachShader(ID, fragment);
+    if(separable) {
+        // Must be set before linking or loading a binary
+        glProgramParameteri(ID, GL_PROGRAM_SEPARABLE, GL_TRUE);
+    }
+
+    if(cache) {
+        cacheKey = cache->GetKey(vertexShader ? vertexShader : "", fragmentShader ? fragmentShader : "");
+        if(cache->Load(cacheKey, ID)) {
+            LoadUniforms();
+            BindUniformBlocks();
+            state = SHADER_READY;
+
+            compileStats.cacheHits++;
+            cache->hits++;
+            cache->hitMilliseconds += GetMilliseconds() - startTime;
+            return;
+        }
+    }
+
+    // Issue everything up front, the driver may compile on its own threads
+    if(vertexShader) {
+        vertex = CompileShader(GL_VERTEX_SHADER, vertexShader);
+        glAttachShader(ID, vertex);
+    }
+    if(fragmentShader) {
+        fragment = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
+        glAttachShader(ID, fragment);
+    }
+
+    if(cache && cache->IsSupported()) {
+        glProgramParameteri(ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     glLinkProgram(ID);
 
-    GLint status;
-    glGetProgramiv(ID, GL_LINK_STATUS, &status);
-    if(!status) {
-        exit(1);
+    buildMilliseconds = GetMilliseconds() - startTime;
+}
+
+Shader::~Shader() {
+    if(vertex) {
+        glDeleteShader(vertex);
     }
+    if(fragment) {
+        glDeleteShader(fragment);
+    }
+    glDeleteProgram(ID);
+}
 
-    glValidateProgram(ID);
-    glGetProgramiv(ID, GL_VALIDATE_STATUS, &status);
-    if(!status) {
-        exit(1);
+void Shader::Swap(Shader& other) {
+    std::swap(ID, other.ID);
+    std::swap(state, other.state);
+    std::swap(separable, other.separable);
+    std::swap(vertex, other.vertex);
+    std::swap(fragment, other.fragment);
+    std::swap(cache, other.cache);
+    std::swap(cacheKey, other.cacheKey);
+    std::swap(buildMilliseconds, other.buildMilliseconds);
+    uniforms.swap(other.uniforms);
+    shadowData.swap(other.shadowData);
+    uniformLookup.swap(other.uniformLookup);
+    namePointerLookup.swap(other.namePointerLookup);
+
+    ++version;
+    ++other.version;
+}
+
+bool Shader::IsReady() {
+    if(state == SHADER_COMPILING) {
+        if(GLEXT_KHR_parallel_shader_compile) {
+            GLint complete = 0;
+            glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &complete);
+            if(!complete) {
+                return false;
+            }
+        }
+        Finalize();
     }
 
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
+    return state == SHADER_READY;
+}
+
+bool Shader::Finalize() {
+    if(state != SHADER_COMPILING) {
+        return state == SHADER_READY;
+    }
+
+    double startTime = GetMilliseconds();
+
+    bool success = CheckShader(vertex, "vertex") && CheckShader(fragment, "fragment");
+    if(success) {
+        GLint status = 0;
+        glGetProgramiv(ID, GL_LINK_STATUS, &status);
+        // A lone stage is validated as part of its ProgramPipeline
+        if(status && !separable) {
+            glValidateProgram(ID);
+            glGetProgramiv(ID, GL_VALIDATE_STATUS, &status);
+        }
+
+        if(!status) {
+            char log[1024];
+            glGetProgramInfoLog(ID, sizeof(log), nullptr, log);
+            fprintf(stderr, "Failed to link program:\n%s\n", log);
+            success = false;
+        }
+    }
+
+    for(uint32 shader : { vertex, fragment }) {
+        if(shader) {
+            glDetachShader(ID, shader);
+            glDeleteShader(shader);
+        }
+    }
+    vertex = fragment = 0;
+
+    if(!success) {
+        state = SHADER_FAILED;
+        return false;
+    }
+
+    LoadUniforms();
+    BindUniformBlocks();
+    state = SHADER_READY;
+
+    if(cache) {
+        cache->Save(cacheKey, ID);
+        cache->misses++;
+        cache->missMilliseconds += buildMilliseconds + GetMilliseconds() - startTime;
+    }
+
+    return true;
+}
+
+bool Shader::EnsureReady() {
+    if(state == SHADER_COMPILING) {
+        // A program the driver already finished in the background is no
+        // stall. Without the extension there is no asking, assume the worst.
+        GLint complete = 0;
+        if(GLEXT_KHR_parallel_shader_compile) {
+            glGetProgramiv(ID, GL_COMPLETION_STATUS_KHR, &complete);
+        }
+        if(complete) {
+            Finalize();
+        } else {
+            double startTime = GetMilliseconds();
+            Finalize();
+            compileStats.stalls++;
+            compileStats.stallMilliseconds += GetMilliseconds() - startTime;
+        }
+    }
+
+    return state == SHADER_READY;
+}
+
+void Shader::BindUniformBlock(const char *blockName, uint32 binding) {
+    GLuint blockIndex = glGetUniformBlockIndex(ID, blockName);
+    if(blockIndex != GL_INVALID_INDEX) {
+        glUniformBlockBinding(ID, blockIndex, binding);
+    }
+}
+
+void Shader::BindUniformBlocks() {
+    for(uint32 i = 0; i < ShaderReflection::UNIFORM_BLOCK_COUNT; i++) {
+        BindUniformBlock(ShaderReflection::UNIFORM_BLOCKS[i].name, ShaderReflection::UNIFORM_BLOCKS[i].binding);
+    }
+}
+
+static uint32 GetUniformTypeSize(GLenum type) {
+    switch(type) {
+        case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2: case GL_BOOL_VEC2:
+            return 8;
+        case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3: case GL_BOOL_VEC3:
+            return 12;
+        case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_UNSIGNED_INT_VEC4: case GL_BOOL_VEC4:
+        case GL_FLOAT_MAT2:
+            return 16;
+        case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT3x2:
+            return 24;
+        case GL_FLOAT_MAT2x4: case GL_FLOAT_MAT4x2:
+            return 32;
+        case GL_FLOAT_MAT3:
+            return 36;
+        case GL_FLOAT_MAT3x4: case GL_FLOAT_MAT4x3:
+            return 48;
+        case GL_FLOAT_MAT4:
+            return 64;
+        default:
+            // float, int, uint, bool and samplers
+            return 4;
+    }
+}
+
+void Shader::LoadUniforms() {
+    GLint count = 0, maxLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+    std::string name(maxLength > 0 ? maxLength : 1, '\0');
+    for(GLint i=0; i<count; ++i) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(ID, (GLuint)i, maxLength, &length, &size, &type, &name[0]);
+
+        std::string uniformName(name.c_str(), length);
+        GLint location = glGetUniformLocation(ID, uniformName.c_str());
+        // Uniform block members have no location
+        if(location < 0) {
+            continue;
+        }
+
+        // Only a trailing "[0]", members of struct arrays keep theirs
+        // (lights[0].color)
+        if(uniformName.size() >= 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0) {
+            uniformName.resize(uniformName.size() - 3);
+        }
+
+        UniformInfo info;
+        info.name = InternString(uniformName.c_str());
+        info.nameText = GetInternedString(info.name);
+        info.location = location;
+        info.type = type;
+        info.size = size;
+        info.shadowOffset = (uint32)shadowData.size();
+        info.shadowSize = GetUniformTypeSize(type) * size;
+        info.shadowValid = false;
+        shadowData.resize(shadowData.size() + info.shadowSize);
+
+        uniformLookup[info.name] = (UniformHandle)uniforms.size();
+        uniforms.push_back(info);
+    }
 }
 
 void Shader::UseShader() {
+    if(!EnsureReady()) {
+        exit(1);
+    }
+
     glUseProgram(ID);
 }
 
+UniformHandle Shader::GetUniform(const char *name) {
+    EnsureReady();
+
+    // The same pointer may hold different text over time (a reused buffer),
+    // so a hit is only trusted after comparing the text
+    auto it = namePointerLookup.find(name);
+    if(it != namePointerLookup.end() && it->second != INVALID_UNIFORM &&
+       strcmp(uniforms[it->second].nameText, name) == 0) {
+        return it->second;
+    }
+
+    UniformHandle uniform = INVALID_UNIFORM;
+    for(size_t i=0; i<uniforms.size(); ++i) {
+        if(strcmp(uniforms[i].nameText, name) == 0) {
+            uniform = (UniformHandle)i;
+            break;
+        }
+    }
+
+    namePointerLookup[name] = uniform;
+    return uniform;
+}
+
+UniformHandle Shader::GetUniform(StringId name) {
+    EnsureReady();
+
+    auto it = uniformLookup.find(name);
+    return it != uniformLookup.end() ? it->second : INVALID_UNIFORM;
+}
+
+bool Shader::SetUniformData(UniformHandle uniform, const void *data, uint32 bytes) {
+    if(uniform == INVALID_UNIFORM) {
+        return false;
+    }
+
+    UniformInfo& info = uniforms[uniform];
+    if(bytes > info.shadowSize) {
+        bytes = info.shadowSize;
+    }
+
+    uint8 *shadow = &shadowData[info.shadowOffset];
+    if(info.shadowValid && memcmp(shadow, data, bytes) == 0) {
+        return false;
+    }
+
+    memcpy(shadow, data, bytes);
+    // A partial array upload leaves the rest of the shadow as it was
+    info.shadowValid = info.shadowValid || bytes == info.shadowSize;
+    return true;
+}
+
+void Shader::SetBool(UniformHandle uniform, bool value) {
+    SetInt(uniform, (int32)value);
+}
+
+void Shader::SetInt(UniformHandle uniform, int32 value) {
+    if(SetUniformData(uniform, &value, sizeof(value))) {
+        glUniform1i(uniforms[uniform].location, value);
+    }
+}
+
+void Shader::SetFloat(UniformHandle uniform, float value) {
+    if(SetUniformData(uniform, &value, sizeof(value))) {
+        glUniform1f(uniforms[uniform].location, value);
+    }
+}
+
+void Shader::SetVector2f(UniformHandle uniform, float x, float y) {
+    float value[2] = { x, y };
+    if(SetUniformData(uniform, value, sizeof(value))) {
+        glUniform2fv(uniforms[uniform].location, 1, value);
+    }
+}
+
+void Shader::SetVector3f(UniformHandle uniform, const Vector3f& value) {
+    if(SetUniformData(uniform, &value.x, 3 * sizeof(float))) {
+        glUniform3fv(uniforms[uniform].location, 1, &value.x);
+    }
+}
+
+void Shader::SetVector4f(UniformHandle uniform, const Vector4f& value) {
+    if(SetUniformData(uniform, &value.x, 4 * sizeof(float))) {
+        glUniform4fv(uniforms[uniform].location, 1, &value.x);
+    }
+}
+
+void Shader::SetMatrix3f(UniformHandle uniform, const float *values) {
+    if(SetUniformData(uniform, values, 9 * sizeof(float))) {
+        glUniformMatrix3fv(uniforms[uniform].location, 1, GL_TRUE, values);
+    }
+}
+
+void Shader::SetMatrix4f(UniformHandle uniform, const Matrix4f& value) {
+    // Matrix4f is row-major, let GL transpose it
+    if(SetUniformData(uniform, value.m, sizeof(value.m))) {
+        glUniformMatrix4fv(uniforms[uniform].location, 1, GL_TRUE, &value.m[0][0]);
+    }
+}
+
+void Shader::SetIntArray(UniformHandle uniform, const int32 *values, int32 count) {
+    if(SetUniformData(uniform, values, count * sizeof(int32))) {
+        glUniform1iv(uniforms[uniform].location, count, values);
+    }
+}
+
+void Shader::SetFloatArray(UniformHandle uniform, const float *values, int32 count) {
+    if(SetUniformData(uniform, values, count * sizeof(float))) {
+        glUniform1fv(uniforms[uniform].location, count, values);
+    }
+}
+
+void Shader::SetVector3fArray(UniformHandle uniform, const Vector3f *values, int32 count) {
+    static_assert(sizeof(Vector3f) == 3 * sizeof(float), "Vector3f must be tightly packed");
+    if(SetUniformData(uniform, values, count * sizeof(Vector3f))) {
+        glUniform3fv(uniforms[uniform].location, count, &values->x);
+    }
+}
+
+void Shader::SetVector4fArray(UniformHandle uniform, const Vector4f *values, int32 count) {
+    if(SetUniformData(uniform, values, count * sizeof(Vector4f))) {
+        glUniform4fv(uniforms[uniform].location, count, &values->x);
+    }
+}
+
+void Shader::SetMatrix4fArray(UniformHandle uniform, const Matrix4f *values, int32 count) {
+    if(SetUniformData(uniform, values, count * sizeof(Matrix4f))) {
+        glUniformMatrix4fv(uniforms[uniform].location, count, GL_TRUE, &values->m[0][0]);
+    }
+}
+
 void Shader::SetBool(const char *name, bool value) {
-    glUniform1i(glGetUniformLocation(ID, name), (int32)value);
+    SetBool(GetUniform(name), value);
 }
 
 void Shader::SetInt(const char *name, int32 value) {
-    glUniform1i(glGetUniformLocation(ID, name), value);
+    SetInt(GetUniform(name), value);
 }
 
 void Shader::SetFloat(const char *name, float value) {
-    glUniform1f(glGetUniformLocation(ID, name), value);
+    SetFloat(GetUniform(name), value);
+}
+
+void Shader::SetVector3f(const char *name, const Vector3f& value) {
+    SetVector3f(GetUniform(name), value);
+}
+
+void Shader::SetVector4f(const char *name, const Vector4f& value) {
+    SetVector4f(GetUniform(name), value);
+}
+
+void Shader::SetMatrix4f(const char *name, const Matrix4f& value) {
+    SetMatrix4f(GetUniform(name), value);
 }
@@ -0,0 +1,37 @@
+#include "ShaderCompileQueue.h"
+#include "GLExtensions.h"
+#include "Shader.h"
+
+ShaderCompileQueue::ShaderCompileQueue() {
+    if(GLEXT_KHR_parallel_shader_compile) {
+        // 0xFFFFFFFF lets the implementation pick the number of threads
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+    }
+}
+
+void ShaderCompileQueue::Add(Shader *shader) {
+    if(shader->GetState() == SHADER_COMPILING) {
+        pending.push_back(shader);
+    }
+}
+
+uint32 ShaderCompileQueue::Poll() {
+    size_t count = 0;
+    for(size_t i = 0; i < pending.size(); i++) {
+        Shader *shader = pending[i];
+        // IsReady finalizes the shader once the driver is done with it
+        if(!shader->IsReady() && shader->GetState() == SHADER_COMPILING) {
+            pending[count++] = shader;
+        }
+    }
+    pending.resize(count);
+
+    return (uint32)count;
+}
+
+void ShaderCompileQueue::FinishAll() {
+    for(Shader *shader : pending) {
+        shader->Finalize();
+    }
+    pending.clear();
+}
@@ -0,0 +1,26 @@
+// The feature names on their own, so the offline shader pass can expand
+// variants without linking the GL-facing half of ShaderVariantCache
+#include "ShaderVariantCache.h"
+
+static const char *FEATURE_NAMES[SHADER_FEATURE_COUNT] = {
+    "SKINNING",
+    "NORMAL_MAP",
+    "INSTANCING",
+};
+
+const char *ShaderVariantCache::GetFeatureName(uint32 featureIndex) {
+    return featureIndex < SHADER_FEATURE_COUNT ? FEATURE_NAMES[featureIndex] : nullptr;
+}
+
+std::string ShaderVariantCache::GetFeatureDefines(ShaderFeatures features) {
+    std::string defines;
+    for(uint32 i = 0; i < SHADER_FEATURE_COUNT; i++) {
+        if(features & (1u << i)) {
+            defines += "#define ";
+            defines += FEATURE_NAMES[i];
+            defines += " 1\n";
+        }
+    }
+
+    return defines;
+}
@@ -0,0 +1,248 @@
+#include <algorithm>
+#include <cstdio>
+#include "ShaderPreprocessor.h"
+#include "utils.h"
+
+void ShaderPreprocessor::AddIncludePath(const std::string& directory) {
+    includePaths.push_back(NormalizePath(directory));
+}
+
+void ShaderPreprocessor::SetDefine(const std::string& name, const std::string& value) {
+    for(auto& define : defines) {
+        if(define.first == name) {
+            define.second = value;
+            return;
+        }
+    }
+    defines.emplace_back(name, value);
+}
+
+void ShaderPreprocessor::UpdateFile(const std::string& path, const std::string& source) {
+    files[NormalizePath(path)] = source;
+}
+
+std::string ShaderPreprocessor::NormalizePath(const std::string& path) {
+    std::vector<std::string> parts;
+    size_t start = 0;
+    while(start <= path.size()) {
+        size_t end = path.find('/', start);
+        if(end == std::string::npos) {
+            end = path.size();
+        }
+
+        std::string part = path.substr(start, end - start);
+        if(part == "..") {
+            if(!parts.empty() && parts.back() != "..") {
+                parts.pop_back();
+            } else {
+                parts.push_back(part);
+            }
+        } else if(!part.empty() && part != ".") {
+            parts.push_back(part);
+        }
+        start = end + 1;
+    }
+
+    std::string result = !path.empty() && path[0] == '/' ? "/" : "";
+    for(size_t i = 0; i < parts.size(); i++) {
+        result += (i > 0 ? "/" : "") + parts[i];
+    }
+    return result;
+}
+
+const std::string *ShaderPreprocessor::GetFile(const std::string& path) {
+    auto it = files.find(path);
+    if(it != files.end()) {
+        return &it->second;
+    }
+
+    std::string source;
+    if(!ReadFile(path, source)) {
+        return nullptr;
+    }
+    return &files.emplace(path, std::move(source)).first->second;
+}
+
+bool ShaderPreprocessor::ResolveInclude(const std::string& includer, const std::string& name, bool quoted, std::string& outPath) {
+    if(quoted) {
+        size_t slash = includer.find_last_of('/');
+        std::string directory = slash == std::string::npos ? "" : includer.substr(0, slash + 1);
+        outPath = NormalizePath(directory + name);
+        if(GetFile(outPath)) {
+            return true;
+        }
+    }
+
+    for(const std::string& directory : includePaths) {
+        outPath = NormalizePath(directory + "/" + name);
+        if(GetFile(outPath)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Returns the directive name of a "# name ..." line and where its arguments start
+static std::string GetDirective(const std::string& line, size_t& argumentStart) {
+    size_t i = line.find_first_not_of(" \t");
+    if(i == std::string::npos || line[i] != '#') {
+        return "";
+    }
+
+    i = line.find_first_not_of(" \t", i + 1);
+    if(i == std::string::npos) {
+        return "";
+    }
+    size_t end = line.find_first_of(" \t", i);
+    if(end == std::string::npos) {
+        end = line.size();
+    }
+
+    argumentStart = end;
+    return line.substr(i, end - i);
+}
+
+// Returns the first whitespace separated token of line at or after start
+static std::string GetToken(const std::string& line, size_t start) {
+    size_t i = line.find_first_not_of(" \t", start);
+    if(i == std::string::npos) {
+        return "";
+    }
+    size_t end = line.find_first_of(" \t", i);
+    return line.substr(i, end == std::string::npos ? std::string::npos : end - i);
+}
+
+// Whether the next line starts inside a /* */ comment, given whether this one did
+static bool IsInBlockComment(const std::string& line, bool inComment) {
+    for(size_t i = 0; i + 1 < line.size(); i++) {
+        if(inComment) {
+            if(line[i] == '*' && line[i + 1] == '/') {
+                inComment = false;
+                i++;
+            }
+        } else if(line[i] == '/' && line[i + 1] == '/') {
+            break;
+        } else if(line[i] == '/' && line[i + 1] == '*') {
+            inComment = true;
+            i++;
+        }
+    }
+
+    return inComment;
+}
+
+static void AppendLineDirective(std::string& source, uint32 line, uint32 sourceIndex) {
+    // GLSL 330+: the line after the directive is number line
+    source += "#line " + std::to_string(line) + " " + std::to_string(sourceIndex) + "\n";
+}
+
+bool ShaderPreprocessor::Expand(const std::string& path, uint32 sourceIndex, const std::string& defines, Context& context) {
+    const std::string *file = GetFile(path);
+    if(!file) {
+        fprintf(stderr, "%s: can't read file\n", path.c_str());
+        return false;
+    }
+    if(std::find(context.stack.begin(), context.stack.end(), path) != context.stack.end()) {
+        fprintf(stderr, "%s: include cycle\n", path.c_str());
+        return false;
+    }
+    context.stack.push_back(path);
+
+    const bool isRoot = context.stack.size() == 1;
+    std::string& out = context.out->source;
+
+    const size_t rootStart = out.size();
+    bool hasVersion = false;
+
+    uint32 lineNumber = 0;
+    size_t lineStart = 0;
+    bool inComment = false;
+    while(lineStart < file->size()) {
+        size_t lineEnd = file->find('\n', lineStart);
+        if(lineEnd == std::string::npos) {
+            lineEnd = file->size();
+        }
+        std::string line = file->substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+        lineNumber++;
+
+        size_t arguments = 0;
+        std::string directive = inComment ? "" : GetDirective(line, arguments);
+        inComment = IsInBlockComment(line, inComment);
+
+        if(directive == "version") {
+            if(!isRoot) {
+                fprintf(stderr, "%s:%u: #version in an included file\n", path.c_str(), lineNumber);
+                return false;
+            }
+            out += line + "\n";
+            out += defines;
+            AppendLineDirective(out, lineNumber + 1, sourceIndex);
+            hasVersion = true;
+        } else if(directive == "pragma" && GetToken(line, arguments) == "once") {
+            context.onceFiles.insert(path);
+            out += "\n";
+        } else if(directive == "include") {
+            size_t open = line.find_first_of("\"<", arguments);
+            size_t close = open == std::string::npos ? open : line.find(line[open] == '"' ? '"' : '>', open + 1);
+            if(close == std::string::npos) {
+                fprintf(stderr, "%s:%u: malformed #include\n", path.c_str(), lineNumber);
+                return false;
+            }
+
+            std::string name = line.substr(open + 1, close - open - 1);
+            std::string includePath;
+            if(!ResolveInclude(path, name, line[open] == '"', includePath)) {
+                fprintf(stderr, "%s:%u: can't find include %s\n", path.c_str(), lineNumber, name.c_str());
+                return false;
+            }
+            if(context.onceFiles.count(includePath)) {
+                out += "\n";
+                continue;
+            }
+
+            std::vector<std::string>& dependencies = context.out->dependencies;
+            auto dependency = std::find(dependencies.begin(), dependencies.end(), includePath);
+            uint32 includeIndex = (uint32)(dependency - dependencies.begin());
+            if(dependency == dependencies.end()) {
+                dependencies.push_back(includePath);
+            }
+
+            AppendLineDirective(out, 1, includeIndex);
+            if(!Expand(includePath, includeIndex, defines, context)) {
+                return false;
+            }
+            AppendLineDirective(out, lineNumber + 1, sourceIndex);
+        } else {
+            out += line + "\n";
+        }
+    }
+
+    // A shader without #version gets its defines up front. Decided here and
+    // not by searching the file, which would find one in a comment.
+    if(isRoot && !hasVersion) {
+        std::string prologue = defines;
+        AppendLineDirective(prologue, 1, sourceIndex);
+        out.insert(rootStart, prologue);
+    }
+
+    context.stack.pop_back();
+    return true;
+}
+
+bool ShaderPreprocessor::Preprocess(const std::string& path, const std::string& extraDefines, PreprocessedShader& out) {
+    std::string allDefines;
+    for(const auto& define : defines) {
+        allDefines += "#define " + define.first + " " + define.second + "\n";
+    }
+    allDefines += extraDefines;
+
+    std::string root = NormalizePath(path);
+    out.source.clear();
+    out.dependencies.assign(1, root);
+
+    Context context;
+    context.out = &out;
+    return Expand(root, 0, allDefines, context);
+}
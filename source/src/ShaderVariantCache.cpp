@@ -0,0 +1,54 @@
+#include <cstdio>
+#include <cstdlib>
+#include "ShaderVariantCache.h"
+#include "ShaderCompileQueue.h"
+#include "ShaderPreprocessor.h"
+#include "ShaderWatcher.h"
+#include "Shader.h"
+#include "Hash.h"
+
+ShaderVariantCache::ShaderVariantCache(ShaderPreprocessor *preprocessor, ProgramBinaryCache *binaryCache,
+                                       ShaderCompileQueue *compileQueue, ShaderWatcher *watcher)
+    : preprocessor(preprocessor), binaryCache(binaryCache), compileQueue(compileQueue), watcher(watcher) {
+}
+
+ShaderVariantCache::~ShaderVariantCache() {
+    for(auto& entry : variants) {
+        if(watcher) {
+            watcher->Unwatch(entry.second);
+        }
+        delete entry.second;
+    }
+}
+
+uint64 ShaderVariantCache::GetVariantKey(const char *vertexPath, const char *fragmentPath, ShaderFeatures features) {
+    // "./shaders/a.vs" and "shaders/a.vs" are the same variant
+    uint64 key = HashString(ShaderPreprocessor::NormalizePath(vertexPath).c_str());
+    key = HashString(ShaderPreprocessor::NormalizePath(fragmentPath).c_str(), key);
+    return HashBytes(&features, sizeof(features), key);
+}
+
+Shader *ShaderVariantCache::GetVariant(const char *vertexPath, const char *fragmentPath, ShaderFeatures features) {
+    uint64 key = GetVariantKey(vertexPath, fragmentPath, features);
+    auto it = variants.find(key);
+    if(it != variants.end()) {
+        return it->second;
+    }
+
+    std::string defines = GetFeatureDefines(features);
+    PreprocessedShader vertex, fragment;
+    if(!preprocessor->Preprocess(vertexPath, defines, vertex) || !preprocessor->Preprocess(fragmentPath, defines, fragment)) {
+        exit(1);
+    }
+
+    Shader *shader = new Shader(vertex.source.c_str(), fragment.source.c_str(), binaryCache);
+    if(compileQueue) {
+        compileQueue->Add(shader);
+    }
+    if(watcher) {
+        watcher->Watch(shader, vertexPath, fragmentPath, features);
+    }
+
+    variants[key] = shader;
+    return shader;
+}
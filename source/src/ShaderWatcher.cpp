@@ -0,0 +1,255 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+#include "ShaderWatcher.h"
+#include "Shader.h"
+#include "ShaderPreprocessor.h"
+#include "utils.h"
+
+ShaderWatcher::ShaderWatcher(ShaderPreprocessor *preprocessor, ProgramBinaryCache *binaryCache)
+    : reloads(0), failedReloads(0), preprocessor(preprocessor), binaryCache(binaryCache), inotifyFd(-1),
+      running(false) {
+#ifdef __linux__
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(inotifyFd < 0) {
+        perror("inotify_init1");
+        return;
+    }
+
+    running = true;
+    thread = std::thread(&ShaderWatcher::WatchThread, this);
+#endif
+}
+
+ShaderWatcher::~ShaderWatcher() {
+    running = false;
+    if(thread.joinable()) {
+        thread.join();
+    }
+
+    for(Program& program : programs) {
+        delete program.candidate;
+    }
+
+#ifdef __linux__
+    if(inotifyFd >= 0) {
+        close(inotifyFd);
+    }
+#endif
+}
+
+void ShaderWatcher::AddWatch(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if(watchedFiles[path]++ > 0) {
+        return;
+    }
+
+#ifdef __linux__
+    if(inotifyFd < 0) {
+        return;
+    }
+
+    // Watch the directory rather than the file: editors that save by
+    // writing a new file and renaming it over the old one would otherwise
+    // leave us watching a deleted inode
+    size_t slash = path.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : path.substr(0, slash);
+    char *resolved = realpath(directory.empty() ? "/" : directory.c_str(), nullptr);
+    if(!resolved) {
+        perror(directory.c_str());
+        return;
+    }
+    std::string resolvedDirectory = std::string(resolved) + (resolved[1] ? "/" : "");
+    free(resolved);
+
+    int wd = inotify_add_watch(inotifyFd, resolvedDirectory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if(wd < 0) {
+        perror(directory.c_str());
+        return;
+    }
+    directories[wd] = resolvedDirectory;
+
+    std::vector<std::string>& names = spellings[resolvedDirectory + path.substr(slash + 1)];
+    if(std::find(names.begin(), names.end(), path) == names.end()) {
+        names.push_back(path);
+    }
+#endif
+}
+
+void ShaderWatcher::RemoveWatch(const std::string& path) {
+    // Directory watches stay, events for files nobody uses are ignored
+    std::lock_guard<std::mutex> lock(mutex);
+    watchedFiles[path]--;
+}
+
+void ShaderWatcher::SetDependencies(Program& program, const std::vector<std::string>& dependencies) {
+    for(const std::string& path : dependencies) {
+        AddWatch(path);
+    }
+    for(const std::string& path : program.dependencies) {
+        RemoveWatch(path);
+    }
+    program.dependencies = dependencies;
+}
+
+// Preprocesses both stages, returns the union of their dependencies
+static bool PreprocessProgram(ShaderPreprocessor *preprocessor, const std::string& vertexPath, const std::string& fragmentPath,
+                              ShaderFeatures features, PreprocessedShader& vertex, PreprocessedShader& fragment,
+                              std::vector<std::string>& dependencies) {
+    std::string defines = ShaderVariantCache::GetFeatureDefines(features);
+    bool success = preprocessor->Preprocess(vertexPath, defines, vertex) &&
+                   preprocessor->Preprocess(fragmentPath, defines, fragment);
+
+    dependencies = vertex.dependencies;
+    for(const std::string& path : fragment.dependencies) {
+        if(std::find(dependencies.begin(), dependencies.end(), path) == dependencies.end()) {
+            dependencies.push_back(path);
+        }
+    }
+
+    return success;
+}
+
+void ShaderWatcher::Watch(Shader *shader, const std::string& vertexPath, const std::string& fragmentPath, ShaderFeatures features) {
+    Program program = { shader, vertexPath, fragmentPath, features, {}, nullptr };
+
+    // Only for the dependencies, shader is already built from these
+    PreprocessedShader vertex, fragment;
+    std::vector<std::string> dependencies;
+    PreprocessProgram(preprocessor, vertexPath, fragmentPath, features, vertex, fragment, dependencies);
+    SetDependencies(program, dependencies);
+
+    programs.push_back(std::move(program));
+}
+
+void ShaderWatcher::Unwatch(Shader *shader) {
+    for(size_t i = 0; i < programs.size(); i++) {
+        if(programs[i].shader == shader) {
+            SetDependencies(programs[i], {});
+            delete programs[i].candidate;
+            programs.erase(programs.begin() + i);
+            return;
+        }
+    }
+}
+
+void ShaderWatcher::WatchThread() {
+#ifdef __linux__
+    alignas(struct inotify_event) char buffer[4096];
+
+    while(running) {
+        // Time out now and then so the destructor doesn't have to wake us
+        pollfd fd = { inotifyFd, POLLIN, 0 };
+        if(poll(&fd, 1, 100) <= 0) {
+            continue;
+        }
+
+        ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+        for(ssize_t offset = 0; offset < length;) {
+            const inotify_event *event = (const inotify_event *)(buffer + offset);
+            offset += sizeof(inotify_event) + event->len;
+            if(event->len == 0) {
+                continue;
+            }
+
+            std::string path;
+            std::vector<std::string> names;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto directory = directories.find(event->wd);
+                if(directory == directories.end()) {
+                    continue;
+                }
+                path = directory->second + event->name;
+                auto spelling = spellings.find(path);
+                if(spelling == spellings.end()) {
+                    continue;
+                }
+                for(const std::string& name : spelling->second) {
+                    auto watched = watchedFiles.find(name);
+                    if(watched != watchedFiles.end() && watched->second > 0) {
+                        names.push_back(name);
+                    }
+                }
+            }
+            if(names.empty()) {
+                continue;
+            }
+
+            // Read here so the GL thread never waits on the disk
+            std::string source;
+            if(!ReadFile(path, source)) {
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            for(const std::string& name : names) {
+                changedSources[name] = source;
+            }
+        }
+    }
+#endif
+}
+
+uint32 ShaderWatcher::Update() {
+    std::unordered_map<std::string, std::string> changed;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        changed.swap(changedSources);
+    }
+
+    for(const auto& file : changed) {
+        preprocessor->UpdateFile(file.first, file.second);
+    }
+
+    uint32 swapped = 0;
+    for(Program& program : programs) {
+        bool dirty = false;
+        for(const std::string& path : program.dependencies) {
+            dirty = dirty || changed.count(path) > 0;
+        }
+
+        if(dirty) {
+            reloads++;
+
+            PreprocessedShader vertex, fragment;
+            std::vector<std::string> dependencies;
+            bool success = PreprocessProgram(preprocessor, program.vertexPath, program.fragmentPath, program.features,
+                                             vertex, fragment, dependencies);
+            // An edit may have added or removed includes
+            SetDependencies(program, dependencies);
+
+            // A newer edit supersedes a rebuild still in flight
+            delete program.candidate;
+            program.candidate = nullptr;
+
+            if(success) {
+                program.candidate = new Shader(vertex.source.c_str(), fragment.source.c_str(), binaryCache);
+            } else {
+                failedReloads++;
+                fprintf(stderr, "Keeping the previous program for %s + %s\n", program.vertexPath.c_str(), program.fragmentPath.c_str());
+            }
+        }
+
+        if(program.candidate && (program.candidate->IsReady() || program.candidate->GetState() == SHADER_FAILED)) {
+            if(program.candidate->GetState() == SHADER_READY) {
+                program.shader->Swap(*program.candidate);
+                swapped++;
+            } else {
+                failedReloads++;
+                fprintf(stderr, "Keeping the previous program for %s + %s\n", program.vertexPath.c_str(), program.fragmentPath.c_str());
+            }
+
+            // After a swap this deletes the old program
+            delete program.candidate;
+            program.candidate = nullptr;
+        }
+    }
+
+    return swapped;
+}
@@ -0,0 +1,39 @@
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "StringId.h"
+
+struct StringTable {
+    std::mutex lock;
+    // deque keeps the stored strings in place as it grows
+    std::deque<std::string> strings;
+    std::unordered_map<std::string, StringId> ids;
+};
+
+static StringTable& GetStringTable() {
+    static StringTable table;
+    return table;
+}
+
+StringId InternString(const char *str) {
+    StringTable& table = GetStringTable();
+    std::lock_guard<std::mutex> guard(table.lock);
+
+    auto it = table.ids.find(str);
+    if(it != table.ids.end()) {
+        return it->second;
+    }
+
+    StringId id = (StringId)table.strings.size();
+    table.strings.emplace_back(str);
+    table.ids.emplace(table.strings.back(), id);
+    return id;
+}
+
+const char *GetInternedString(StringId id) {
+    StringTable& table = GetStringTable();
+    std::lock_guard<std::mutex> guard(table.lock);
+
+    return id < table.strings.size() ? table.strings[id].c_str() : nullptr;
+}
@@ -1,7 +1,90 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 #include "Texture.h"
+#include "PixelUploadRing.h"
+#include "TextureContainer.h"
+#include "TextureCompression.h"
 #include "stb_image.h"
 
-void Texture::LoadTexture(bool alpha) {
+// Read-only view of a whole file, memory mapped where available
+struct MappedFile {
+    const uint8 *data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    std::vector<uint8> contents;
+#endif
+
+    bool Open(const char *path) {
+#ifdef _WIN32
+        FILE *file = fopen(path, "rb");
+        if(!file) {
+            return false;
+        }
+        fseek(file, 0, SEEK_END);
+        contents.resize((size_t)ftell(file));
+        fseek(file, 0, SEEK_SET);
+        bool success = fread(contents.data(), 1, contents.size(), file) == contents.size();
+        fclose(file);
+        data = contents.data();
+        size = contents.size();
+        return success;
+#else
+        int fd = open(path, O_RDONLY);
+        if(fd < 0) {
+            return false;
+        }
+        struct stat info;
+        void *mapping = MAP_FAILED;
+        if(fstat(fd, &info) == 0 && info.st_size > 0) {
+            size = (size_t)info.st_size;
+            mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        // The mapping stays valid after closing the descriptor
+        close(fd);
+        if(mapping == MAP_FAILED) {
+            return false;
+        }
+        data = (const uint8 *)mapping;
+        return true;
+#endif
+    }
+
+    ~MappedFile() {
+#ifndef _WIN32
+        if(data) {
+            munmap((void *)data, size);
+        }
+#endif
+    }
+};
+
+// Whether the context can sample a cooked format directly
+static bool IsFormatSupported(TextureContainerFormat format) {
+    switch(format) {
+        case TEXTURE_FORMAT_BC1:
+        case TEXTURE_FORMAT_BC1_SRGB:
+        case TEXTURE_FORMAT_BC3:
+        case TEXTURE_FORMAT_BC3_SRGB:
+            return GLEXT_EXT_texture_compression_s3tc != 0;
+        case TEXTURE_FORMAT_BC7:
+        case TEXTURE_FORMAT_BC7_SRGB:
+            return GLEXT_ARB_texture_compression_bptc != 0;
+        case TEXTURE_FORMAT_ETC2_RGB8:
+        case TEXTURE_FORMAT_ETC2_SRGB8:
+            return GLEXT_ARB_ES3_compatibility != 0;
+        default:
+            return true;
+    }
+}
+
+void Texture::CreateTexture() {
     glGenTextures(1, &textureID);
     glBindTexture(GL_TEXTURE_2D, textureID);
 
@@ -9,16 +92,40 @@ void Texture::LoadTexture(bool alpha) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrapMode_t);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, maxFilter);
+}
+
+void Texture::UploadMipChain(const std::vector<MipLevel>& levels, bool alpha, PixelUploadRing *ring) {
+    GLint internalFormat = alpha ? (srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8) : (srgb ? GL_SRGB8 : GL_RGB8);
+    GLenum format = alpha ? GL_RGBA : GL_RGB;
+
+    // RGB rows are not 4-byte aligned in general
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)levels.size() - 1);
+    for(uint32 level = 0; level < levels.size(); level++) {
+        const MipLevel& mip = levels[level];
+        if(ring) {
+            // Allocate the level, then fill it from the pixel buffer
+            glTexImage2D(GL_TEXTURE_2D, (GLint)level, internalFormat, (GLsizei)mip.width, (GLsizei)mip.height, 0, format,
+                         GL_UNSIGNED_BYTE, nullptr);
+            ring->Upload(level, mip.width, mip.height, format, alpha ? 4 : 3, mip.pixels.data());
+        } else {
+            glTexImage2D(GL_TEXTURE_2D, (GLint)level, internalFormat, (GLsizei)mip.width, (GLsizei)mip.height, 0, format,
+                         GL_UNSIGNED_BYTE, mip.pixels.data());
+        }
+    }
+}
+
+void Texture::LoadTexture(bool alpha) {
+    CreateTexture();
 
     int32 width, height, nChannels;
     stbi_set_flip_vertically_on_load(true);
-    uint8 *data = stbi_load(fileName, &width, &height, &nChannels, 0);
+    uint8 *data = stbi_load(fileName, &width, &height, &nChannels, alpha ? 4 : 3);
     if(data) {
-        if(alpha)
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-        else
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
+        // This runs on the GL thread, so always the cheap filter. mipFilter
+        // applies to TextureLoader, which filters on its workers.
+        UploadMipChain(GenerateMipChain(data, (uint32)width, (uint32)height, alpha ? 4 : 3, srgb, MIP_FILTER_BOX), alpha);
+        ready = true;
     } else {
         stbi_image_free(data);
         exit(-1);
@@ -26,6 +133,55 @@ void Texture::LoadTexture(bool alpha) {
     stbi_image_free(data);
 }
 
+bool Texture::LoadCookedTexture() {
+    MappedFile file;
+    if(!file.Open(fileName)) {
+        fprintf(stderr, "%s: can't open cooked texture\n", fileName);
+        return false;
+    }
+
+    TextureContainerView container;
+    std::string error;
+    if(!ParseTextureContainer(file.data, file.size, container, error)) {
+        fprintf(stderr, "%s: %s\n", fileName, error.c_str());
+        return false;
+    }
+
+    TextureContainerFormat format = container.format;
+    const TextureContainerMip *mips = container.mips;
+
+    CreateTexture();
+    TextureFormatInfo info = GetTextureFormatInfo(format);
+    bool decompress = info.blockBytes && !IsFormatSupported(format);
+    if(decompress) {
+        fprintf(stderr, "%s: %s not supported by the GPU, decompressing\n", fileName, info.name);
+    }
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)container.header->mipCount - 1);
+    std::vector<uint8> rgba;
+    for(uint32 level = 0; level < container.header->mipCount; level++) {
+        const uint8 *data = file.data + mips[level].offset;
+        GLsizei width = (GLsizei)mips[level].width, height = (GLsizei)mips[level].height;
+        if(decompress) {
+            if(!DecompressImage(format, data, mips[level].width, mips[level].height, rgba)) {
+                fprintf(stderr, "%s: can't decode mip level %u\n", fileName, level);
+                return false;
+            }
+            glTexImage2D(GL_TEXTURE_2D, (GLint)level, info.srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8, width, height, 0,
+                         GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+        } else if(info.blockBytes) {
+            glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)level, info.internalFormat, width, height, 0,
+                                   (GLsizei)GetTextureLevelSize(format, mips[level].width, mips[level].height), data);
+        } else {
+            glTexImage2D(GL_TEXTURE_2D, (GLint)level, (GLint)info.internalFormat, width, height, 0, info.format,
+                         info.type, data);
+        }
+    }
+    ready = true;
+
+    return true;
+}
+
 void Texture::BindTexture() {
     glBindTexture(GL_TEXTURE_2D, textureID);
 }
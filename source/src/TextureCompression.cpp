@@ -0,0 +1,649 @@
+#include <cmath>
+#include <cstring>
+#include "TextureCompression.h"
+
+static inline uint8 Clamp255(int32 value) {
+    return (uint8)(value < 0 ? 0 : value > 255 ? 255 : value);
+}
+
+static inline int32 Square(int32 value) {
+    return value * value;
+}
+
+// Principal axis of the block's texels over the first `channels` channels,
+// returned as the mean and the extreme points projected onto the axis.
+static void GetPrincipalEndpoints(const uint8 *rgba, uint32 channels, float *low, float *high) {
+    float mean[4] = {};
+    for(uint32 i = 0; i < 16; i++) {
+        for(uint32 c = 0; c < channels; c++) {
+            mean[c] += rgba[i * 4 + c];
+        }
+    }
+    for(uint32 c = 0; c < channels; c++) {
+        mean[c] /= 16.0f;
+    }
+
+    float covariance[4][4] = {};
+    for(uint32 i = 0; i < 16; i++) {
+        float d[4];
+        for(uint32 c = 0; c < channels; c++) {
+            d[c] = rgba[i * 4 + c] - mean[c];
+        }
+        for(uint32 a = 0; a < channels; a++) {
+            for(uint32 b = 0; b < channels; b++) {
+                covariance[a][b] += d[a] * d[b];
+            }
+        }
+    }
+
+    // A few power iterations are plenty for a 16 texel block
+    float axis[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    for(uint32 iteration = 0; iteration < 8; iteration++) {
+        float next[4] = {};
+        float length = 0.0f;
+        for(uint32 a = 0; a < channels; a++) {
+            for(uint32 b = 0; b < channels; b++) {
+                next[a] += covariance[a][b] * axis[b];
+            }
+            length += next[a] * next[a];
+        }
+        if(length < 1e-12f) {
+            break;
+        }
+        length = 1.0f / sqrtf(length);
+        for(uint32 c = 0; c < channels; c++) {
+            axis[c] = next[c] * length;
+        }
+    }
+
+    float minT = 1e30f, maxT = -1e30f;
+    for(uint32 i = 0; i < 16; i++) {
+        float t = 0.0f;
+        for(uint32 c = 0; c < channels; c++) {
+            t += (rgba[i * 4 + c] - mean[c]) * axis[c];
+        }
+        minT = t < minT ? t : minT;
+        maxT = t > maxT ? t : maxT;
+    }
+
+    // Pull the endpoints in slightly, the extremes are rarely worth an exact match
+    float inset = (maxT - minT) / 32.0f;
+    minT += inset;
+    maxT -= inset;
+    for(uint32 c = 0; c < channels; c++) {
+        low[c] = fminf(fmaxf(mean[c] + axis[c] * minT, 0.0f), 255.0f);
+        high[c] = fminf(fmaxf(mean[c] + axis[c] * maxT, 0.0f), 255.0f);
+    }
+}
+
+// --- BC1 / BC3 ----------------------------------------------------------
+
+static uint16 PackRGB565(const float *color) {
+    uint32 r = (uint32)(color[0] * 31.0f / 255.0f + 0.5f);
+    uint32 g = (uint32)(color[1] * 63.0f / 255.0f + 0.5f);
+    uint32 b = (uint32)(color[2] * 31.0f / 255.0f + 0.5f);
+    return (uint16)((r << 11) | (g << 5) | b);
+}
+
+static void UnpackRGB565(uint16 color, int32 *rgb) {
+    uint32 r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+    rgb[0] = (int32)((r << 3) | (r >> 2));
+    rgb[1] = (int32)((g << 2) | (g >> 4));
+    rgb[2] = (int32)((b << 3) | (b >> 2));
+}
+
+// Builds the BC1 palette, four colours when color0 > color1 (always in BC3)
+static void GetBC1Palette(uint16 color0, uint16 color1, bool forceFourColors, int32 palette[4][4]) {
+    UnpackRGB565(color0, palette[0]);
+    UnpackRGB565(color1, palette[1]);
+    for(uint32 c = 0; c < 3; c++) {
+        if(color0 > color1 || forceFourColors) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        } else {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+    palette[0][3] = palette[1][3] = palette[2][3] = 255;
+    palette[3][3] = color0 > color1 || forceFourColors ? 255 : 0;
+}
+
+static void EncodeColorBlock(const uint8 *rgba, uint8 *block) {
+    float low[4], high[4];
+    GetPrincipalEndpoints(rgba, 3, low, high);
+
+    uint16 color0 = PackRGB565(high);
+    uint16 color1 = PackRGB565(low);
+    if(color0 < color1) {
+        uint16 swap = color0;
+        color0 = color1;
+        color1 = swap;
+    }
+
+    uint32 indices = 0;
+    if(color0 != color1) {
+        int32 palette[4][4];
+        GetBC1Palette(color0, color1, true, palette);
+        for(uint32 i = 0; i < 16; i++) {
+            uint32 best = 0;
+            int32 bestError = 1 << 30;
+            for(uint32 p = 0; p < 4; p++) {
+                int32 error = Square(rgba[i * 4] - palette[p][0]) + Square(rgba[i * 4 + 1] - palette[p][1]) +
+                              Square(rgba[i * 4 + 2] - palette[p][2]);
+                if(error < bestError) {
+                    bestError = error;
+                    best = p;
+                }
+            }
+            indices |= best << (2 * i);
+        }
+    }
+
+    block[0] = (uint8)color0;
+    block[1] = (uint8)(color0 >> 8);
+    block[2] = (uint8)color1;
+    block[3] = (uint8)(color1 >> 8);
+    for(uint32 i = 0; i < 4; i++) {
+        block[4 + i] = (uint8)(indices >> (8 * i));
+    }
+}
+
+static void DecodeColorBlock(const uint8 *block, bool forceFourColors, uint8 *rgba) {
+    uint16 color0 = (uint16)(block[0] | (block[1] << 8));
+    uint16 color1 = (uint16)(block[2] | (block[3] << 8));
+    uint32 indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((uint32)block[7] << 24);
+
+    int32 palette[4][4];
+    GetBC1Palette(color0, color1, forceFourColors, palette);
+    for(uint32 i = 0; i < 16; i++) {
+        const int32 *color = palette[(indices >> (2 * i)) & 3];
+        for(uint32 c = 0; c < 4; c++) {
+            rgba[i * 4 + c] = (uint8)color[c];
+        }
+    }
+}
+
+static void GetAlphaPalette(uint8 alpha0, uint8 alpha1, int32 palette[8]) {
+    palette[0] = alpha0;
+    palette[1] = alpha1;
+    if(alpha0 > alpha1) {
+        for(int32 i = 1; i < 7; i++) {
+            palette[i + 1] = ((7 - i) * alpha0 + i * alpha1) / 7;
+        }
+    } else {
+        for(int32 i = 1; i < 5; i++) {
+            palette[i + 1] = ((5 - i) * alpha0 + i * alpha1) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+static void EncodeAlphaBlock(const uint8 *rgba, uint8 *block) {
+    uint8 alpha0 = 0, alpha1 = 255;
+    for(uint32 i = 0; i < 16; i++) {
+        alpha0 = rgba[i * 4 + 3] > alpha0 ? rgba[i * 4 + 3] : alpha0;
+        alpha1 = rgba[i * 4 + 3] < alpha1 ? rgba[i * 4 + 3] : alpha1;
+    }
+
+    uint64 indices = 0;
+    if(alpha0 != alpha1) {
+        int32 palette[8];
+        GetAlphaPalette(alpha0, alpha1, palette);
+        for(uint32 i = 0; i < 16; i++) {
+            uint32 best = 0;
+            int32 bestError = 1 << 30;
+            for(uint32 p = 0; p < 8; p++) {
+                int32 error = Square(rgba[i * 4 + 3] - palette[p]);
+                if(error < bestError) {
+                    bestError = error;
+                    best = p;
+                }
+            }
+            indices |= (uint64)best << (3 * i);
+        }
+    }
+
+    block[0] = alpha0;
+    block[1] = alpha1;
+    for(uint32 i = 0; i < 6; i++) {
+        block[2 + i] = (uint8)(indices >> (8 * i));
+    }
+}
+
+static void DecodeAlphaBlock(const uint8 *block, uint8 *rgba) {
+    int32 palette[8];
+    GetAlphaPalette(block[0], block[1], palette);
+
+    uint64 indices = 0;
+    for(uint32 i = 0; i < 6; i++) {
+        indices |= (uint64)block[2 + i] << (8 * i);
+    }
+    for(uint32 i = 0; i < 16; i++) {
+        rgba[i * 4 + 3] = (uint8)palette[(indices >> (3 * i)) & 7];
+    }
+}
+
+void EncodeBC1Block(const uint8 *rgba, uint8 *block) {
+    EncodeColorBlock(rgba, block);
+}
+
+void DecodeBC1Block(const uint8 *block, uint8 *rgba) {
+    DecodeColorBlock(block, false, rgba);
+}
+
+void EncodeBC3Block(const uint8 *rgba, uint8 *block) {
+    EncodeAlphaBlock(rgba, block);
+    EncodeColorBlock(rgba, block + 8);
+}
+
+void DecodeBC3Block(const uint8 *block, uint8 *rgba) {
+    DecodeColorBlock(block + 8, true, rgba);
+    DecodeAlphaBlock(block, rgba);
+}
+
+// --- BC7 mode 6 ---------------------------------------------------------
+
+static const int32 BC7_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+struct BitWriter {
+    uint8 *data;
+    uint32 position;
+
+    void Write(uint32 value, uint32 bits) {
+        for(uint32 i = 0; i < bits; i++, position++) {
+            data[position >> 3] |= (uint8)(((value >> i) & 1) << (position & 7));
+        }
+    }
+};
+
+struct BitReader {
+    const uint8 *data;
+    uint32 position;
+
+    uint32 Read(uint32 bits) {
+        uint32 value = 0;
+        for(uint32 i = 0; i < bits; i++, position++) {
+            value |= (uint32)((data[position >> 3] >> (position & 7)) & 1) << i;
+        }
+        return value;
+    }
+};
+
+// Picks the 7-bit endpoint and shared p-bit closest to an RGBA colour
+static void QuantizeBC7Endpoint(const float *color, uint32 *quantized, uint32& pBit) {
+    float bestError = 1e30f;
+    for(uint32 p = 0; p < 2; p++) {
+        uint32 candidate[4];
+        float error = 0.0f;
+        for(uint32 c = 0; c < 4; c++) {
+            int32 q = (int32)((color[c] - p) / 2.0f + 0.5f);
+            candidate[c] = (uint32)(q < 0 ? 0 : q > 127 ? 127 : q);
+            float d = color[c] - (float)((candidate[c] << 1) | p);
+            error += d * d;
+        }
+        if(error < bestError) {
+            bestError = error;
+            pBit = p;
+            memcpy(quantized, candidate, sizeof(candidate));
+        }
+    }
+}
+
+void EncodeBC7Block(const uint8 *rgba, uint8 *block) {
+    float low[4], high[4];
+    GetPrincipalEndpoints(rgba, 4, low, high);
+
+    uint32 endpoints[2][4], pBits[2];
+    QuantizeBC7Endpoint(low, endpoints[0], pBits[0]);
+    QuantizeBC7Endpoint(high, endpoints[1], pBits[1]);
+
+    int32 expanded[2][4];
+    for(uint32 e = 0; e < 2; e++) {
+        for(uint32 c = 0; c < 4; c++) {
+            expanded[e][c] = (int32)((endpoints[e][c] << 1) | pBits[e]);
+        }
+    }
+
+    uint32 indices[16];
+    for(uint32 i = 0; i < 16; i++) {
+        int32 bestError = 1 << 30;
+        for(uint32 w = 0; w < 16; w++) {
+            int32 error = 0;
+            for(uint32 c = 0; c < 4; c++) {
+                int32 value = ((64 - BC7_WEIGHTS4[w]) * expanded[0][c] + BC7_WEIGHTS4[w] * expanded[1][c] + 32) >> 6;
+                error += Square(rgba[i * 4 + c] - value);
+            }
+            if(error < bestError) {
+                bestError = error;
+                indices[i] = w;
+            }
+        }
+    }
+
+    // The anchor index is stored without its top bit, swap the endpoints if it's set
+    if(indices[0] & 8) {
+        for(uint32 c = 0; c < 4; c++) {
+            uint32 swap = endpoints[0][c];
+            endpoints[0][c] = endpoints[1][c];
+            endpoints[1][c] = swap;
+        }
+        uint32 swap = pBits[0];
+        pBits[0] = pBits[1];
+        pBits[1] = swap;
+        for(uint32 i = 0; i < 16; i++) {
+            indices[i] = 15 - indices[i];
+        }
+    }
+
+    memset(block, 0, 16);
+    BitWriter writer = { block, 0 };
+    writer.Write(1 << 6, 7);   // mode 6
+    for(uint32 c = 0; c < 4; c++) {
+        writer.Write(endpoints[0][c], 7);
+        writer.Write(endpoints[1][c], 7);
+    }
+    writer.Write(pBits[0], 1);
+    writer.Write(pBits[1], 1);
+    writer.Write(indices[0], 3);
+    for(uint32 i = 1; i < 16; i++) {
+        writer.Write(indices[i], 4);
+    }
+}
+
+bool DecodeBC7Block(const uint8 *block, uint8 *rgba) {
+    BitReader reader = { block, 0 };
+    if(reader.Read(7) != (1 << 6)) {
+        return false;
+    }
+
+    uint32 endpoints[2][4];
+    for(uint32 c = 0; c < 4; c++) {
+        endpoints[0][c] = reader.Read(7);
+        endpoints[1][c] = reader.Read(7);
+    }
+    uint32 pBits[2] = { reader.Read(1), reader.Read(1) };
+
+    for(uint32 i = 0; i < 16; i++) {
+        uint32 w = BC7_WEIGHTS4[reader.Read(i == 0 ? 3 : 4)];
+        for(uint32 c = 0; c < 4; c++) {
+            uint32 e0 = (endpoints[0][c] << 1) | pBits[0];
+            uint32 e1 = (endpoints[1][c] << 1) | pBits[1];
+            rgba[i * 4 + c] = (uint8)(((64 - w) * e0 + w * e1 + 32) >> 6);
+        }
+    }
+    return true;
+}
+
+// --- ETC2 (ETC1-compatible modes) ---------------------------------------
+
+static const int32 ETC_MODIFIERS[8][2] = {
+    { 2, 8 }, { 5, 17 }, { 9, 29 }, { 13, 42 }, { 18, 60 }, { 24, 80 }, { 33, 106 }, { 47, 183 },
+};
+
+// Pixel index value -> modifier: 0 = +small, 1 = +large, 2 = -small, 3 = -large
+static inline int32 GetETCModifier(uint32 table, uint32 index) {
+    int32 modifier = ETC_MODIFIERS[table][index & 1];
+    return index & 2 ? -modifier : modifier;
+}
+
+// Texel (x, y) of a block belongs to subblock 1 when it's in the right
+// half, or the bottom half for flipped blocks
+static inline uint32 GetETCSubblock(uint32 x, uint32 y, bool flip) {
+    return flip ? (y >= 2) : (x >= 2);
+}
+
+struct ETCSubblockFit {
+    uint32 table;
+    uint32 indices[16];   // only the subblock's texels are set
+    int32 error;
+};
+
+static ETCSubblockFit FitETCSubblock(const uint8 *rgba, const int32 *base, uint32 subblock, bool flip) {
+    ETCSubblockFit best = {};
+    best.error = 1 << 30;
+
+    for(uint32 table = 0; table < 8; table++) {
+        ETCSubblockFit fit = {};
+        fit.table = table;
+        for(uint32 y = 0; y < 4 && fit.error < best.error; y++) {
+            for(uint32 x = 0; x < 4; x++) {
+                if(GetETCSubblock(x, y, flip) != subblock) {
+                    continue;
+                }
+
+                const uint8 *texel = rgba + (y * 4 + x) * 4;
+                int32 bestError = 1 << 30;
+                for(uint32 index = 0; index < 4; index++) {
+                    int32 modifier = GetETCModifier(table, index);
+                    int32 error = Square(texel[0] - Clamp255(base[0] + modifier)) +
+                                  Square(texel[1] - Clamp255(base[1] + modifier)) +
+                                  Square(texel[2] - Clamp255(base[2] + modifier));
+                    if(error < bestError) {
+                        bestError = error;
+                        fit.indices[y * 4 + x] = index;
+                    }
+                }
+                fit.error += bestError;
+            }
+        }
+        if(fit.error < best.error) {
+            best = fit;
+        }
+    }
+
+    return best;
+}
+
+void EncodeETC2Block(const uint8 *rgba, uint8 *block) {
+    uint64 bestBits = 0;
+    int32 bestError = 1 << 30;
+
+    for(uint32 flip = 0; flip < 2; flip++) {
+        float average[2][3] = {};
+        for(uint32 y = 0; y < 4; y++) {
+            for(uint32 x = 0; x < 4; x++) {
+                uint32 subblock = GetETCSubblock(x, y, flip != 0);
+                for(uint32 c = 0; c < 3; c++) {
+                    average[subblock][c] += rgba[(y * 4 + x) * 4 + c] / 8.0f;
+                }
+            }
+        }
+
+        // Differential mode: 5-bit bases, the second within -4..3 of the first
+        for(uint32 differential = 0; differential < 2; differential++) {
+            uint32 bits = differential ? 5 : 4;
+            uint32 maxValue = (1 << bits) - 1;
+            int32 quantized[2][3], base[2][3];
+            bool representable = true;
+            for(uint32 s = 0; s < 2; s++) {
+                for(uint32 c = 0; c < 3; c++) {
+                    quantized[s][c] = (int32)(average[s][c] * maxValue / 255.0f + 0.5f);
+                    base[s][c] = differential ? (quantized[s][c] << 3) | (quantized[s][c] >> 2)
+                                              : (quantized[s][c] << 4) | quantized[s][c];
+                }
+            }
+            for(uint32 c = 0; c < 3 && differential; c++) {
+                int32 delta = quantized[1][c] - quantized[0][c];
+                representable = representable && delta >= -4 && delta <= 3;
+            }
+            if(!representable) {
+                continue;
+            }
+
+            ETCSubblockFit fits[2] = { FitETCSubblock(rgba, base[0], 0, flip != 0), FitETCSubblock(rgba, base[1], 1, flip != 0) };
+            int32 error = fits[0].error + fits[1].error;
+            if(error >= bestError) {
+                continue;
+            }
+
+            uint64 value = 0;
+            for(uint32 c = 0; c < 3; c++) {
+                uint32 shift = 56 - c * 8;
+                if(differential) {
+                    value |= (uint64)quantized[0][c] << (shift + 3);
+                    value |= (uint64)((quantized[1][c] - quantized[0][c]) & 7) << shift;
+                } else {
+                    value |= (uint64)quantized[0][c] << (shift + 4);
+                    value |= (uint64)quantized[1][c] << shift;
+                }
+            }
+            value |= (uint64)fits[0].table << 37;
+            value |= (uint64)fits[1].table << 34;
+            value |= (uint64)differential << 33;
+            value |= (uint64)flip << 32;
+            for(uint32 y = 0; y < 4; y++) {
+                for(uint32 x = 0; x < 4; x++) {
+                    uint32 index = fits[GetETCSubblock(x, y, flip != 0)].indices[y * 4 + x];
+                    uint32 bit = x * 4 + y;
+                    value |= (uint64)(index >> 1) << (16 + bit);
+                    value |= (uint64)(index & 1) << bit;
+                }
+            }
+
+            bestError = error;
+            bestBits = value;
+        }
+    }
+
+    // Individual mode always fits, so bestBits is always set
+    for(uint32 i = 0; i < 8; i++) {
+        block[i] = (uint8)(bestBits >> (56 - 8 * i));
+    }
+}
+
+void DecodeETC2Block(const uint8 *block, uint8 *rgba) {
+    uint64 value = 0;
+    for(uint32 i = 0; i < 8; i++) {
+        value = (value << 8) | block[i];
+    }
+
+    bool differential = (value >> 33) & 1;
+    bool flip = (value >> 32) & 1;
+    uint32 tables[2] = { (uint32)(value >> 37) & 7, (uint32)(value >> 34) & 7 };
+
+    int32 base[2][3];
+    for(uint32 c = 0; c < 3; c++) {
+        uint32 shift = 56 - c * 8;
+        if(differential) {
+            int32 first = (int32)(value >> (shift + 3)) & 31;
+            int32 delta = (int32)(value >> shift) & 7;
+            int32 second = first + (delta >= 4 ? delta - 8 : delta);
+            base[0][c] = (first << 3) | (first >> 2);
+            base[1][c] = (second << 3) | (second >> 2);
+        } else {
+            int32 first = (int32)(value >> (shift + 4)) & 15;
+            int32 second = (int32)(value >> shift) & 15;
+            base[0][c] = (first << 4) | first;
+            base[1][c] = (second << 4) | second;
+        }
+    }
+
+    for(uint32 y = 0; y < 4; y++) {
+        for(uint32 x = 0; x < 4; x++) {
+            uint32 bit = x * 4 + y;
+            uint32 index = (uint32)(((value >> (16 + bit)) & 1) << 1 | ((value >> bit) & 1));
+            uint32 subblock = GetETCSubblock(x, y, flip);
+            int32 modifier = GetETCModifier(tables[subblock], index);
+            uint8 *texel = rgba + (y * 4 + x) * 4;
+            for(uint32 c = 0; c < 3; c++) {
+                texel[c] = Clamp255(base[subblock][c] + modifier);
+            }
+            texel[3] = 255;
+        }
+    }
+}
+
+// --- Images ---------------------------------------------------------------
+
+typedef void (*EncodeBlockFunction)(const uint8 *rgba, uint8 *block);
+
+static EncodeBlockFunction GetEncoder(TextureContainerFormat format) {
+    switch(format) {
+        case TEXTURE_FORMAT_BC1:
+        case TEXTURE_FORMAT_BC1_SRGB:
+            return EncodeBC1Block;
+        case TEXTURE_FORMAT_BC3:
+        case TEXTURE_FORMAT_BC3_SRGB:
+            return EncodeBC3Block;
+        case TEXTURE_FORMAT_BC7:
+        case TEXTURE_FORMAT_BC7_SRGB:
+            return EncodeBC7Block;
+        case TEXTURE_FORMAT_ETC2_RGB8:
+        case TEXTURE_FORMAT_ETC2_SRGB8:
+            return EncodeETC2Block;
+        default:
+            return nullptr;
+    }
+}
+
+std::vector<uint8> CompressImage(TextureContainerFormat format, const uint8 *rgba, uint32 width, uint32 height) {
+    EncodeBlockFunction encode = GetEncoder(format);
+    uint32 blockBytes = GetTextureFormatInfo(format).blockBytes;
+    uint32 blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    std::vector<uint8> blocks((size_t)blocksX * blocksY * blockBytes);
+    if(!encode) {
+        return blocks;
+    }
+
+    uint8 texels[64];
+    for(uint32 by = 0; by < blocksY; by++) {
+        for(uint32 bx = 0; bx < blocksX; bx++) {
+            for(uint32 y = 0; y < 4; y++) {
+                uint32 sy = by * 4 + y < height ? by * 4 + y : height - 1;
+                for(uint32 x = 0; x < 4; x++) {
+                    uint32 sx = bx * 4 + x < width ? bx * 4 + x : width - 1;
+                    memcpy(texels + (y * 4 + x) * 4, rgba + ((size_t)sy * width + sx) * 4, 4);
+                }
+            }
+            encode(texels, &blocks[((size_t)by * blocksX + bx) * blockBytes]);
+        }
+    }
+
+    return blocks;
+}
+
+bool DecompressImage(TextureContainerFormat format, const uint8 *blocks, uint32 width, uint32 height,
+                     std::vector<uint8>& rgba) {
+    uint32 blockBytes = GetTextureFormatInfo(format).blockBytes;
+    uint32 blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    rgba.resize((size_t)width * height * 4);
+
+    uint8 texels[64];
+    for(uint32 by = 0; by < blocksY; by++) {
+        for(uint32 bx = 0; bx < blocksX; bx++) {
+            const uint8 *block = blocks + ((size_t)by * blocksX + bx) * blockBytes;
+            switch(format) {
+                case TEXTURE_FORMAT_BC1:
+                case TEXTURE_FORMAT_BC1_SRGB:
+                    DecodeBC1Block(block, texels);
+                    break;
+                case TEXTURE_FORMAT_BC3:
+                case TEXTURE_FORMAT_BC3_SRGB:
+                    DecodeBC3Block(block, texels);
+                    break;
+                case TEXTURE_FORMAT_BC7:
+                case TEXTURE_FORMAT_BC7_SRGB:
+                    if(!DecodeBC7Block(block, texels)) {
+                        return false;
+                    }
+                    break;
+                case TEXTURE_FORMAT_ETC2_RGB8:
+                case TEXTURE_FORMAT_ETC2_SRGB8:
+                    DecodeETC2Block(block, texels);
+                    break;
+                default:
+                    return false;
+            }
+
+            for(uint32 y = 0; y < 4 && by * 4 + y < height; y++) {
+                for(uint32 x = 0; x < 4 && bx * 4 + x < width; x++) {
+                    memcpy(&rgba[((size_t)(by * 4 + y) * width + bx * 4 + x) * 4], texels + (y * 4 + x) * 4, 4);
+                }
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,35 @@
+#include "TextureContainer.h"
+
+bool ParseTextureContainer(const uint8 *data, size_t size, TextureContainerView& view, std::string& error) {
+    const TextureContainerHeader *header = (const TextureContainerHeader *)data;
+    if(size < sizeof(TextureContainerHeader) || header->magic != TEXTURE_CONTAINER_MAGIC ||
+       header->version != TEXTURE_CONTAINER_VERSION || header->format >= TEXTURE_FORMAT_COUNT) {
+        error = "not a cooked texture or an old version";
+        return false;
+    }
+    if(header->mipCount == 0 || header->mipCount > 32 ||
+       size < sizeof(TextureContainerHeader) + header->mipCount * sizeof(TextureContainerMip)) {
+        error = "truncated mip table";
+        return false;
+    }
+
+    TextureContainerFormat format = (TextureContainerFormat)header->format;
+    const TextureContainerMip *mips = (const TextureContainerMip *)(header + 1);
+    for(uint32 level = 0; level < header->mipCount; level++) {
+        uint32 width = header->width >> level, height = header->height >> level;
+        if(mips[level].width != (width ? width : 1) || mips[level].height != (height ? height : 1)) {
+            error = "mip level " + std::to_string(level) + " is not half the size of the one above";
+            return false;
+        }
+        if(mips[level].offset > size || mips[level].size > size - mips[level].offset ||
+           mips[level].size < GetTextureLevelSize(format, mips[level].width, mips[level].height)) {
+            error = "truncated mip level " + std::to_string(level);
+            return false;
+        }
+    }
+
+    view.header = header;
+    view.mips = mips;
+    view.format = format;
+    return true;
+}
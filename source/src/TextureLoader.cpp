@@ -0,0 +1,129 @@
+#include <cstdio>
+#include "TextureLoader.h"
+#include "Texture.h"
+#include "stb_image.h"
+
+TextureLoader::TextureLoader(uint32 workerCount, uint32 uploadBudget, PixelUploadRing *uploadRing)
+    : uploadedBytes(0), failedLoads(0), uploadBudget(uploadBudget), uploadRing(uploadRing), pending(0),
+      stopping(false), completed(nullptr) {
+    if(workerCount == 0) {
+        uint32 hardwareThreads = std::thread::hardware_concurrency();
+        workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    for(uint32 i = 0; i < workerCount; i++) {
+        workers.emplace_back(&TextureLoader::WorkerThread, this);
+    }
+}
+
+TextureLoader::~TextureLoader() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for(std::thread& worker : workers) {
+        worker.join();
+    }
+
+    for(Job *job : jobs) {
+        delete job;
+    }
+    for(Job *job = completed.exchange(nullptr); job;) {
+        Job *next = job->next;
+        uploads.push_back(job);
+        job = next;
+    }
+    for(Job *job : uploads) {
+        delete job;
+    }
+}
+
+void TextureLoader::Load(Texture *texture, bool alpha) {
+    static const uint8 PLACEHOLDER[4] = { 128, 128, 128, 255 };
+
+    texture->ready = false;
+    texture->CreateTexture();
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, PLACEHOLDER);
+    // The placeholder has no mips, don't let the min filter ask for them
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+    Job *job = new Job { texture, texture->fileName, alpha, texture->srgb, texture->mipFilter, {}, nullptr, 0, 0, nullptr };
+    pending++;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(job);
+    }
+    wake.notify_one();
+}
+
+void TextureLoader::WorkerThread() {
+    // The flip flag is global in stb_image, keep it per thread
+    stbi_set_flip_vertically_on_load_thread(true);
+
+    while(true) {
+        Job *job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if(stopping) {
+                return;
+            }
+            job = jobs.front();
+            jobs.pop_front();
+        }
+
+        int32 nChannels;
+        uint8 *pixels = stbi_load(job->fileName.c_str(), &job->width, &job->height, &nChannels, job->alpha ? 4 : 3);
+        if(pixels) {
+            job->levels = GenerateMipChain(pixels, (uint32)job->width, (uint32)job->height, job->alpha ? 4 : 3,
+                                           job->srgb, job->mipFilter);
+            stbi_image_free(pixels);
+        } else {
+            job->failure = stbi_failure_reason();
+        }
+
+        job->next = completed.load(std::memory_order_relaxed);
+        while(!completed.compare_exchange_weak(job->next, job, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+}
+
+uint32 TextureLoader::Update() {
+    // The list comes back newest first, restore request order
+    std::deque<Job*> taken;
+    for(Job *job = completed.exchange(nullptr, std::memory_order_acquire); job; job = job->next) {
+        taken.push_front(job);
+    }
+    uploads.insert(uploads.end(), taken.begin(), taken.end());
+
+    uint32 ready = 0;
+    uint64 frameBytes = 0;
+    while(!uploads.empty() && (frameBytes < uploadBudget || ready == 0)) {
+        Job *job = uploads.front();
+        uploads.pop_front();
+        pending--;
+
+        if(!job->levels.empty()) {
+            uint64 bytes = 0;
+            for(const MipLevel& level : job->levels) {
+                bytes += level.pixels.size();
+            }
+            job->texture->BindTexture();
+            job->texture->UploadMipChain(job->levels, job->alpha, uploadRing);
+            job->texture->ready = true;
+
+            frameBytes += bytes;
+            uploadedBytes += bytes;
+            ready++;
+        } else {
+            // Unlike LoadTexture, keep running with the placeholder
+            fprintf(stderr, "Failed to load texture %s: %s\n", job->fileName.c_str(), job->failure);
+            failedLoads++;
+        }
+        delete job;
+    }
+
+    return ready;
+}
@@ -0,0 +1,47 @@
+#include <cstddef>
+#include "UniformBuffer.h"
+#include "ShaderReflection.h"
+
+// The C++ mirrors must match the blocks as declared in shaders/
+static_assert(PER_FRAME_BLOCK_BINDING == ShaderReflection::PerFrame::BINDING, "PerFrame is bound elsewhere");
+static_assert(PER_OBJECT_BLOCK_BINDING == ShaderReflection::PerObject::BINDING, "PerObject is bound elsewhere");
+static_assert(sizeof(PerFrameData) == ShaderReflection::PerFrame::SIZE, "PerFrameData size differs from the PerFrame block");
+static_assert(offsetof(PerFrameData, viewProjection) == ShaderReflection::PerFrame::VIEW_PROJECTION_OFFSET, "PerFrame.viewProjection moved");
+static_assert(offsetof(PerFrameData, cameraPos) == ShaderReflection::PerFrame::CAMERA_POS_OFFSET, "PerFrame.cameraPos moved");
+static_assert(offsetof(PerFrameData, time) == ShaderReflection::PerFrame::TIME_OFFSET, "PerFrame.time moved");
+static_assert(offsetof(PerFrameData, deltaTime) == ShaderReflection::PerFrame::DELTA_TIME_OFFSET, "PerFrame.deltaTime moved");
+static_assert(sizeof(PerObjectData) == ShaderReflection::PerObject::SIZE, "PerObjectData size differs from the PerObject block");
+static_assert(offsetof(PerObjectData, modelViewProjection) == ShaderReflection::PerObject::MODEL_VIEW_PROJECTION_OFFSET, "PerObject.modelViewProjection moved");
+
+static uint32 GetOffsetAlignment() {
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    return alignment > 0 ? (uint32)alignment : 256;
+}
+
+UniformBufferRing::UniformBufferRing(uint32 frameSize, uint32 framesInFlight)
+    : pushedBytes(0), overflows(0), segments(GL_UNIFORM_BUFFER, frameSize, framesInFlight, GetOffsetAlignment()) {
+}
+
+UniformBufferRange UniformBufferRing::Push(const void *data, uint32 size) {
+    UniformBufferRange range = { 0, 0, 0 };
+
+    int64 bufferOffset = segments.Allocate(data, size);
+    if(bufferOffset < 0) {
+        overflows++;
+        return range;
+    }
+
+    range.buffer = segments.GetBuffer();
+    range.offset = (uint32)bufferOffset;
+    range.size = size;
+    pushedBytes += size;
+
+    return range;
+}
+
+void UniformBufferRing::Bind(uint32 binding, const UniformBufferRange& range) {
+    if(range.buffer) {
+        glBindBufferRange(GL_UNIFORM_BUFFER, binding, range.buffer, range.offset, range.size);
+    }
+}
@@ -7,18 +7,67 @@
 #include <glad/glad.h>
 #include <SDL_opengl.h>
 
-#include <glm/vec3.hpp> // glm::vec3
-#include <glm/vec4.hpp> // glm::vec4
-#include <glm/mat4x4.hpp> // glm::mat4
-#include <glm/gtc/matrix_transform.hpp> // glm::translate, glm::rotate, glm::scale, glm::perspective
-#include <glm/gtc/constants.hpp> // glm::pi
-#include <glm/gtc/type_ptr.hpp> // value_ptr
-#include <glm/gtx/rotate_vector.hpp>
-
+#include "math3d.h"
+#include "FastMath.h"
 #include "utils.h"
+#include "Camera.h"
+#include "GLExtensions.h"
+#include "UniformBuffer.h"
 
 static int SCREEN_WIDTH = 1280;
 static int SCREEN_HEIGHT = 720;
+// Reverse-Z only pays off with a [0, 1] depth range and a float depth
+// buffer, so it is turned on only when glClipControl is available and the
+// scene target below could be created
+static bool REVERSE_Z = false;
+
+// With reverse-Z the scene is drawn here and blitted to the window: the
+// default framebuffer only offers 24-bit UNORM depth, on which reverse-Z
+// gains almost nothing
+struct SceneTarget
+{
+    GLuint framebuffer;
+    GLuint color;
+    GLuint depth;
+};
+static SceneTarget sceneTarget = {};
+
+static bool CreateSceneTarget(int width, int height)
+{
+    glGenRenderbuffers(1, &sceneTarget.color);
+    glBindRenderbuffer(GL_RENDERBUFFER, sceneTarget.color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glGenRenderbuffers(1, &sceneTarget.depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, sceneTarget.depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT32F, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &sceneTarget.framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, sceneTarget.framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, sceneTarget.color);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, sceneTarget.depth);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if(!complete) {
+        printf("Float depth target incomplete, reverse-Z disabled\n");
+        glDeleteFramebuffers(1, &sceneTarget.framebuffer);
+        glDeleteRenderbuffers(1, &sceneTarget.color);
+        glDeleteRenderbuffers(1, &sceneTarget.depth);
+        sceneTarget = {};
+    }
+    return complete;
+}
+
+static void DeleteSceneTarget()
+{
+    if(sceneTarget.framebuffer) {
+        glDeleteFramebuffers(1, &sceneTarget.framebuffer);
+        glDeleteRenderbuffers(1, &sceneTarget.color);
+        glDeleteRenderbuffers(1, &sceneTarget.depth);
+        sceneTarget = {};
+    }
+}
 
 struct InputState
 {
@@ -29,18 +78,15 @@ struct InputState
 };
 static InputState inputState = {};
 
-struct CameraState
-{
-    glm::vec3 pos;
-    glm::vec3 up;
-    glm::vec3 target;
-};
-static CameraState cameraState = {};
+static Camera camera;
+static UniformBufferRing *uniformRing = nullptr;
 
 void Render()
 {   
     //glEnable(GL_DEPTH_TEST); 
+    glBindFramebuffer(GL_FRAMEBUFFER, sceneTarget.framebuffer);
     glClear(GL_COLOR_BUFFER_BIT|GL_DEPTH_BUFFER_BIT);
+    uniformRing->BeginFrame();
     
     static float scale = 0.0f;
     scale += 1.0f;
@@ -49,32 +95,41 @@ void Render()
     float aspectRatio = SCREEN_WIDTH / (SCREEN_HEIGHT * 1.0f);
     float nearZ = 0.1f; float farZ = 50.0f;
     float fov = 45.0f;
-    glm::mat4 projectionMat = glm::perspective(glm::radians(fov), aspectRatio, nearZ, farZ);
+    // Only rebuilds the projection when one of these changed
+    camera.SetPerspective(aspectRatio, ToRadian(fov), nearZ, farZ);
     
     // Making the vertices move
-    glm::mat4 scaleMat = glm::scale(glm::mat4(), glm::vec3(1.0f, 1.0f, 1.0f));
-    glm::mat4 rotationMat = glm::rotate(glm::mat4(), glm::radians(scale), glm::vec3(0.0f, 1.0f, 0.0f));
-    glm::mat4 translationMat = glm::translate(glm::mat4(), glm::vec3(0.0f, 0.0f, 0.0f));
+    static constexpr Matrix4f scaleMat = GetScaleMatrix(1.0f, 1.0f, 1.0f);
+    Matrix4f rotationMat = GetRotationMatrix(0.0f, scale, 0.0f);
+    static constexpr Matrix4f translationMat = GetTranslationMatrix(0.0f, 0.0f, 0.0f);
     
     // * is left associative.
     // Therfore, translationMat will be multiplied by rotationMat and the result by scaleMat
     // Mt x Mr x Ms x V1
     // Mt x Mr x V2
     // Mt x V3 
-    glm::mat4 modelMat = translationMat * rotationMat * scaleMat;
+    Matrix4f modelMat = translationMat * rotationMat * scaleMat;
     printf("%f, %f, %f, %f\n%f, %f, %f, %f,\n%f, %f, %f, %f,\n%f, %f, %f, %f\n",
-            modelMat[0][0], modelMat[0][1], modelMat[0][2], modelMat[0][3],
-            modelMat[1][0], modelMat[1][1], modelMat[1][2], modelMat[1][3],
-            modelMat[2][0], modelMat[2][1], modelMat[2][2], modelMat[2][3],
-            modelMat[3][0], modelMat[3][1], modelMat[3][2], modelMat[3][3]
+            modelMat.m[0][0], modelMat.m[0][1], modelMat.m[0][2], modelMat.m[0][3],
+            modelMat.m[1][0], modelMat.m[1][1], modelMat.m[1][2], modelMat.m[1][3],
+            modelMat.m[2][0], modelMat.m[2][1], modelMat.m[2][2], modelMat.m[2][3],
+            modelMat.m[3][0], modelMat.m[3][1], modelMat.m[3][2], modelMat.m[3][3]
           );
     
-    // Camera Tansformation
-    glm::mat4 viewMat = glm::lookAt(cameraState.pos, cameraState.target, cameraState.up);
-
-    // Perspective transformation
-    glm::mat4 mvpMat = (projectionMat * viewMat * modelMat);
-//    glUniformMatrix4fv(uniformLocation, 1, GL_FALSE, glm::value_ptr(mvpMat));
+    // Per-frame data is uploaded once and shared by every draw
+    PerFrameData frameData = {};
+    frameData.view = camera.GetViewMatrix();
+    frameData.projection = camera.GetProjectionMatrix();
+    frameData.viewProjection = camera.GetViewProjectionMatrix();
+    frameData.cameraPos = Vector4f(camera.GetPosition(), 1.0f);
+    frameData.time = SDL_GetTicks() / 1000.0f;
+    UniformBufferRing::Bind(PER_FRAME_BLOCK_BINDING, uniformRing->Push(frameData));
+
+    // Camera and perspective transformation, cached by the camera
+    PerObjectData objectData = {};
+    objectData.model = modelMat;
+    objectData.modelViewProjection = (camera.GetViewProjectionMatrix() * modelMat);
+    UniformBufferRing::Bind(PER_OBJECT_BLOCK_BINDING, uniformRing->Push(objectData));
 //    assert (glGetError() != GL_INVALID_OPERATION);
     
 //    glUniform1i(samplerLocation, 0);
@@ -95,6 +150,16 @@ void Render()
 //    glBindVertexArray(0);
 //    assert (glGetError() != GL_INVALID_OPERATION);
 //    printf("Unbound Vertex Array Object...\n");
+
+    uniformRing->EndFrame();
+
+    if(sceneTarget.framebuffer) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, sceneTarget.framebuffer);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        glBlitFramebuffer(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT,
+                          GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
 }
 
 void GetInput()
@@ -143,29 +208,31 @@ void GetInput()
 
 void Update()
 {
+    Vector3f pos = camera.GetPosition();
     if(inputState.upPressed) {
-        cameraState.pos.z += 0.01f;
+        pos.z += 0.01f;
     }
     if(inputState.downPressed) {
-        cameraState.pos.z -= 0.01f;
+        pos.z -= 0.01f;
     }
     if(inputState.leftPressed) {
-        cameraState.pos.x -= 0.01f;
+        pos.x -= 0.01f;
     }
     if(inputState.rightPressed) {
-        cameraState.pos.x += 0.01f;
+        pos.x += 0.01f;
     }
+    camera.SetPosition(pos);
 
     float rotationAngleAroundY = (inputState.mouseX - inputState.prevMouseX);
     float rotationAngleAroundX = (inputState.mouseY - inputState.prevMouseY);
 
-    glm::vec3 rotAroundY = glm::rotateY(glm::vec3(0.0f, 0.0f, 1.0f), glm::radians(-inputState.mouseX*100.0f/(SCREEN_WIDTH*1.0f)));
-    glm::vec3 target = glm::rotateX(rotAroundY, glm::radians(-inputState.mouseY*100.0f/(SCREEN_HEIGHT*1.0f)));
+    Quaternion rotAroundY = GetAxisAngleQuaternionFast(Vector3f(0.0f, 1.0f, 0.0f), ToRadian(-inputState.mouseX*100.0f/(SCREEN_WIDTH*1.0f)));
+    Quaternion rotAroundX = GetAxisAngleQuaternionFast(Vector3f(1.0f, 0.0f, 0.0f), ToRadian(-inputState.mouseY*100.0f/(SCREEN_HEIGHT*1.0f)));
+    Vector3f target = (rotAroundX * rotAroundY).Rotate(Vector3f(0.0f, 0.0f, 1.0f));
 
-    printf("Target X: %.02f, Target Y: %.02f, Target Z: %.02f\n", target[0], target[1], target[2]);
+    printf("Target X: %.02f, Target Y: %.02f, Target Z: %.02f\n", target.x, target.y, target.z);
 
-    cameraState.target = target;
-    cameraState.up = glm::vec3(0.0f, 1.0f, 0.0f);
+    camera.SetOrientation(target, Vector3f(0.0f, 1.0f, 0.0f));
 }
 
 int main(int argc, char *argv[])
@@ -179,11 +246,12 @@ int main(int argc, char *argv[])
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 3);
     SDL_GL_SetAttribute(SDL_GL_STENCIL_SIZE, 8);
-    SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 8); 
+    SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
 
     SDL_Window* window = SDL_CreateWindow("3DEngine", 100, 100, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_OPENGL);
     SDL_GLContext context = SDL_GL_CreateContext(window);
     gladLoadGLLoader((GLADloadproc)SDL_GL_GetProcAddress);
+    LoadGLExtensions((GLADloadproc)SDL_GL_GetProcAddress);
     
     if(context == NULL) {
         std::cout << "Error creating Opengl context..\n";
@@ -191,7 +259,16 @@ int main(int argc, char *argv[])
     }
 
     glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
+    REVERSE_Z = GLEXT_ARB_clip_control != 0 && CreateSceneTarget(SCREEN_WIDTH, SCREEN_HEIGHT);
+    if(REVERSE_Z) {
+        // Depth 1 is the near plane, 0 is infinitely far away
+        glClipControl(GL_LOWER_LEFT, GL_ZERO_TO_ONE);
+        glClearDepth(0.0);
+        glDepthFunc(GL_GREATER);
+        camera.SetReverseZ(true, true);
+    } else {
+        glDepthFunc(GL_LESS);
+    }
 
     glFrontFace(GL_CW);
     glCullFace(GL_BACK);
@@ -205,7 +282,9 @@ int main(int argc, char *argv[])
 
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 
-    cameraState.pos.z = -5.0f;
+    camera.SetPosition(Vector3f(0.0f, 0.0f, -5.0f));
+
+    uniformRing = new UniformBufferRing(64 * 1024);
 
     // Start Event loop
     SDL_Event windowEvent;
@@ -223,6 +302,9 @@ int main(int argc, char *argv[])
         SDL_GL_SwapWindow(window);
     }
 
+    delete uniformRing;
+    DeleteSceneTarget();
+
 //    glDeleteProgram(shaderProg);
 //    glDeleteBuffers(1, &vbo);
 //    glDeleteVertexArrays(1, &vao);
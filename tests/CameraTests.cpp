@@ -0,0 +1,118 @@
+// Camera caching: the version only changes when a setter changes something,
+// getters rebuild the matrices at most once per change, and the cached
+// inverses undo their matrices. Built once per ENGINE_MATH_BACKEND.
+
+#include "Test.h"
+#include "Types.h"
+#include "Camera.h"
+
+const float EPSILON = 1e-4f;
+
+static void CheckIdentity(const Matrix4f& mat, float epsilon) {
+    Matrix4f identity = GetIdentityMatrix4f();
+    for(int i = 0; i < 4; i++) {
+        for(int j = 0; j < 4; j++) {
+            CHECK_NEAR(mat.m[i][j], identity.m[i][j], epsilon);
+        }
+    }
+}
+
+static void TestVersion() {
+    Camera camera;
+    uint32 version = camera.GetVersion();
+
+    // The current values are no change
+    camera.SetPerspective(1.0f, ToRadian(45.0f), 0.1f, 100.0f);
+    camera.SetAspectRatio(1.0f);
+    camera.SetReverseZ(false, false);
+    camera.SetPosition(Vector3f(0.0f, 0.0f, 0.0f));
+    camera.SetOrientation(Vector3f(0.0f, 0.0f, 1.0f), Vector3f(0.0f, 1.0f, 0.0f));
+    CHECK(camera.GetVersion() == version);
+
+    // Each real change bumps it once, setting it again does not
+    camera.SetAspectRatio(16.0f / 9.0f);
+    CHECK(camera.GetVersion() == ++version);
+    camera.SetAspectRatio(16.0f / 9.0f);
+    CHECK(camera.GetVersion() == version);
+
+    camera.SetPerspective(16.0f / 9.0f, ToRadian(60.0f), 0.1f, 100.0f);
+    CHECK(camera.GetVersion() == ++version);
+    camera.SetReverseZ(true, true);
+    CHECK(camera.GetVersion() == ++version);
+    camera.SetReverseZ(true, true);
+    CHECK(camera.GetVersion() == version);
+
+    camera.SetPosition(Vector3f(1.0f, 2.0f, 3.0f));
+    CHECK(camera.GetVersion() == ++version);
+    camera.SetPosition(Vector3f(1.0f, 2.0f, 3.0f));
+    CHECK(camera.GetVersion() == version);
+
+    camera.SetOrientation(Vector3f(1.0f, 0.0f, 0.0f), Vector3f(0.0f, 1.0f, 0.0f));
+    CHECK(camera.GetVersion() == ++version);
+    camera.SetOrientation(Vector3f(1.0f, 0.0f, 0.0f), Vector3f(0.0f, 1.0f, 0.0f));
+    CHECK(camera.GetVersion() == version);
+
+    // Reading matrices is not a change
+    camera.GetViewProjectionMatrix();
+    CHECK(camera.GetVersion() == version);
+}
+
+static void TestCaching() {
+    Camera camera;
+    camera.SetPosition(Vector3f(0.0f, 1.0f, -5.0f));
+    CHECK(camera.GetMatrixUpdates() == 0);
+
+    // Every getter, many times, with one rebuild
+    for(uint32 i = 0; i < 10; i++) {
+        camera.GetProjectionMatrix();
+        camera.GetViewMatrix();
+        camera.GetViewProjectionMatrix();
+        camera.GetInverseProjectionMatrix();
+        camera.GetInverseViewMatrix();
+        camera.GetInverseViewProjectionMatrix();
+    }
+    CHECK(camera.GetMatrixUpdates() == 1);
+
+    // Setters that change nothing leave the matrices alone
+    camera.SetPosition(Vector3f(0.0f, 1.0f, -5.0f));
+    camera.SetAspectRatio(1.0f);
+    camera.GetViewProjectionMatrix();
+    CHECK(camera.GetMatrixUpdates() == 1);
+
+    // Several changes between reads are one rebuild
+    camera.SetPosition(Vector3f(2.0f, 1.0f, -5.0f));
+    camera.SetAspectRatio(2.0f);
+    camera.SetPosition(Vector3f(3.0f, 1.0f, -5.0f));
+    camera.GetViewMatrix();
+    camera.GetProjectionMatrix();
+    CHECK(camera.GetMatrixUpdates() == 2);
+}
+
+static void CheckInverses(Camera& camera) {
+    CheckIdentity(camera.GetViewMatrix() * camera.GetInverseViewMatrix(), EPSILON);
+    CheckIdentity(camera.GetProjectionMatrix() * camera.GetInverseProjectionMatrix(), EPSILON);
+    CheckIdentity(camera.GetViewProjectionMatrix() * camera.GetInverseViewProjectionMatrix(), EPSILON);
+}
+
+static void TestInverses() {
+    Camera camera;
+    camera.SetPerspective(16.0f / 9.0f, ToRadian(60.0f), 0.5f, 200.0f);
+    camera.SetPosition(Vector3f(3.0f, -2.0f, 10.0f));
+    camera.SetOrientation(Vector3f(1.0f, 0.5f, -1.0f).Normalize(), Vector3f(0.0f, 1.0f, 0.0f));
+    CheckInverses(camera);
+
+    // Still consistent after the view alone and the projection alone changed
+    camera.SetPosition(Vector3f(-7.0f, 4.0f, 1.0f));
+    CheckInverses(camera);
+    camera.SetReverseZ(true, true);
+    CheckInverses(camera);
+    camera.SetReverseZ(true, false);
+    CheckInverses(camera);
+}
+
+int main() {
+    TestVersion();
+    TestCaching();
+    TestInverses();
+    return FinishTests("CameraTests");
+}
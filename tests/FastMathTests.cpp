@@ -0,0 +1,117 @@
+// FastMath.h against libm (in double) over the ranges its comments document:
+// the largest error of FastRsqrt, FastNormalize and FastSinCos, single and
+// batched, must stay within the stated bounds. Built once per backend.
+
+#include <cstdlib>
+#include <vector>
+#include "Test.h"
+#include "Types.h"
+#include "FastMath.h"
+
+// The documented bounds
+const double RSQRT_MAX_RELATIVE_ERROR = 2.5e-7;
+const double NORMALIZE_MAX_LENGTH_ERROR = 4e-7;
+const double SINCOS_MAX_ERROR = 2e-7;
+const float SINCOS_RANGE = 8192.0f;
+
+const uint32 SAMPLE_COUNT = 1 << 20;
+
+static float GetRandom(float low, float high) {
+    return low + rand() / (float)RAND_MAX * (high - low);
+}
+
+static void TestRsqrt() {
+    double maxError = 0.0;
+    // Every exponent from 2^-40 to 2^40, a few mantissas each
+    for(uint32 i = 0; i < SAMPLE_COUNT; i++) {
+        float x = ldexpf(GetRandom(1.0f, 2.0f), (int)(i % 81) - 40);
+        double expected = 1.0 / sqrt((double)x);
+        maxError = fmax(maxError, fabs(FastRsqrt(x) - expected) / expected);
+    }
+    printf("FastRsqrt: max relative error %.3g\n", maxError);
+    CHECK(maxError <= RSQRT_MAX_RELATIVE_ERROR);
+}
+
+static double GetLengthError(float x, float y, float z) {
+    return fabs(sqrt((double)x * x + (double)y * y + (double)z * z) - 1.0);
+}
+
+static void TestNormalize() {
+    // Lengths over many orders of magnitude, and an odd count for the tail
+    // of the batched version
+    const uint32 count = 100003;
+    std::vector<Vector3f> vectors(count);
+    Vector3fStream stream;
+    stream.Resize(count);
+    for(uint32 i = 0; i < count; i++) {
+        float scale = ldexpf(1.0f, (int)(i % 41) - 20);
+        vectors[i] = Vector3f(GetRandom(-1.0f, 1.0f), GetRandom(-1.0f, 1.0f), GetRandom(-1.0f, 1.0f)) * scale;
+        stream.Set(i, vectors[i]);
+    }
+    vectors[count - 1] = Vector3f();
+    stream.Set(count - 1, Vector3f());
+    vectors[7] = Vector3f();
+    stream.Set(7, Vector3f());
+
+    FastNormalize(stream.View(), stream.Size());
+    double maxError = 0.0, maxBatchedError = 0.0;
+    for(uint32 i = 0; i < count; i++) {
+        Vector3f n = FastNormalize(vectors[i]);
+        if(vectors[i].x == 0.0f && vectors[i].y == 0.0f && vectors[i].z == 0.0f) {
+            // Zero stays zero, in a vector lane and in the scalar tail
+            CHECK(n.x == 0.0f && n.y == 0.0f && n.z == 0.0f);
+            CHECK(stream.x[i] == 0.0f && stream.y[i] == 0.0f && stream.z[i] == 0.0f);
+            continue;
+        }
+        maxError = fmax(maxError, GetLengthError(n.x, n.y, n.z));
+        maxBatchedError = fmax(maxBatchedError, GetLengthError(stream.x[i], stream.y[i], stream.z[i]));
+    }
+    printf("FastNormalize: max length error %.3g, batched %.3g\n", maxError, maxBatchedError);
+    CHECK(maxError <= NORMALIZE_MAX_LENGTH_ERROR);
+    CHECK(maxBatchedError <= NORMALIZE_MAX_LENGTH_ERROR);
+}
+
+static void TestSinCos() {
+    std::vector<float> angles(SAMPLE_COUNT + 3), sines(angles.size()), cosines(angles.size());
+    for(size_t i = 0; i < angles.size(); i++) {
+        angles[i] = GetRandom(-SINCOS_RANGE, SINCOS_RANGE);
+    }
+    // Quadrant boundaries and the ends of the range
+    const float edges[] = { 0.0f, -0.0f, PI / 4.0f, PI / 2.0f, -PI / 2.0f, PI, 3.0f * PI / 4.0f, SINCOS_RANGE, -SINCOS_RANGE };
+    for(size_t i = 0; i < sizeof(edges) / sizeof(edges[0]); i++) {
+        angles[i] = edges[i];
+    }
+
+    FastSinCos(angles.data(), sines.data(), cosines.data(), angles.size());
+    double maxError = 0.0, maxBatchedError = 0.0;
+    for(size_t i = 0; i < angles.size(); i++) {
+        double expectedSin = sin((double)angles[i]), expectedCos = cos((double)angles[i]);
+        float s, c;
+        FastSinCos(angles[i], s, c);
+        maxError = fmax(maxError, fmax(fabs(s - expectedSin), fabs(c - expectedCos)));
+        maxError = fmax(maxError, fmax(fabs(FastSin(angles[i]) - expectedSin), fabs(FastCos(angles[i]) - expectedCos)));
+        maxBatchedError = fmax(maxBatchedError, fmax(fabs(sines[i] - expectedSin), fabs(cosines[i] - expectedCos)));
+    }
+    printf("FastSinCos: max absolute error %.3g, batched %.3g over [-%g, %g]\n", maxError, maxBatchedError,
+           SINCOS_RANGE, SINCOS_RANGE);
+    CHECK(maxError <= SINCOS_MAX_ERROR);
+    CHECK(maxBatchedError <= SINCOS_MAX_ERROR);
+
+    // The constexpr versions share the reduction and polynomials
+    constexpr float folded = ConstexprSin(1.0f);
+    CHECK_NEAR(folded, sin(1.0), SINCOS_MAX_ERROR);
+    CHECK_NEAR(ConstexprCos(-5.0f), cos(-5.0), SINCOS_MAX_ERROR);
+
+    Quaternion fast = GetAxisAngleQuaternionFast(Vector3f(0.0f, 1.0f, 0.0f), 1.0f);
+    Quaternion exact = GetAxisAngleQuaternion(Vector3f(0.0f, 1.0f, 0.0f), 1.0f);
+    CHECK_NEAR(fast.y, exact.y, SINCOS_MAX_ERROR);
+    CHECK_NEAR(fast.w, exact.w, SINCOS_MAX_ERROR);
+}
+
+int main() {
+    srand(1);
+    TestRsqrt();
+    TestNormalize();
+    TestSinCos();
+    return FinishTests("FastMathTests");
+}
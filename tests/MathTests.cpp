@@ -0,0 +1,340 @@
+// Checks the Matrix4f kernels of the configured backend (built once per
+// ENGINE_MATH_BACKEND) against the scalar references in math3d.h, stream
+// bounds, and the quaternion product, matrices, interpolation and hierarchy
+// composition.
+
+#include <algorithm>
+#include <cstdlib>
+#include "Test.h"
+#include "Types.h"
+#include "math3d.h"
+
+const float EPSILON = 1e-4f;
+const uint32 ITERATIONS = 1000;
+
+static float GetRandom() {
+    return rand() / (float)RAND_MAX * 2.0f - 1.0f;
+}
+
+static Matrix4f GetRandomMatrix() {
+    Matrix4f mat;
+    for(int i = 0; i < 4; i++) {
+        for(int j = 0; j < 4; j++) {
+            mat.m[i][j] = GetRandom() * 10.0f;
+        }
+    }
+    return mat;
+}
+
+static void CheckMatrixNear(const Matrix4f& actual, const Matrix4f& expected, float epsilon) {
+    for(int i = 0; i < 4; i++) {
+        for(int j = 0; j < 4; j++) {
+            CHECK_NEAR(actual.m[i][j], expected.m[i][j], epsilon);
+        }
+    }
+}
+
+static void CheckVectorNear(const Vector3f& actual, const Vector3f& expected, float epsilon) {
+    CHECK_NEAR(actual.x, expected.x, epsilon);
+    CHECK_NEAR(actual.y, expected.y, epsilon);
+    CHECK_NEAR(actual.z, expected.z, epsilon);
+}
+
+static void TestMultiply() {
+    for(uint32 n = 0; n < ITERATIONS; n++) {
+        Matrix4f left = GetRandomMatrix(), right = GetRandomMatrix(), expected;
+        MultiplyMatrix4fScalar(left, right, expected);
+        CheckMatrixNear(left * right, expected, EPSILON);
+    }
+
+    // The constexpr form folds to the same result
+    constexpr Matrix4f folded = MultiplyMatrix4fScalar(GetTranslationMatrix(1.0f, 2.0f, 3.0f), GetScaleMatrix(2.0f, 2.0f, 2.0f));
+    CheckMatrixNear(folded, GetTranslationMatrix(1.0f, 2.0f, 3.0f) * GetScaleMatrix(2.0f, 2.0f, 2.0f), 0.0f);
+}
+
+static void TestTransform() {
+    for(uint32 n = 0; n < ITERATIONS; n++) {
+        Matrix4f mat = GetRandomMatrix();
+        Vector4f v(GetRandom(), GetRandom(), GetRandom(), GetRandom());
+        Vector4f expected = TransformVector4fScalar(mat, v);
+
+        Vector4f actual = mat * v;
+        CHECK_NEAR(actual.x, expected.x, EPSILON);
+        CHECK_NEAR(actual.y, expected.y, EPSILON);
+        CHECK_NEAR(actual.z, expected.z, EPSILON);
+        CHECK_NEAR(actual.w, expected.w, EPSILON);
+
+        Vector3f p(v.x, v.y, v.z);
+        Vector4f point = TransformVector4fScalar(mat, Vector4f(p, 1.0f));
+        Vector3f transformed = TransformPoint(mat, p);
+        CHECK_NEAR(transformed.x, point.x, EPSILON);
+        CHECK_NEAR(transformed.y, point.y, EPSILON);
+        CHECK_NEAR(transformed.z, point.z, EPSILON);
+
+        Vector4f direction = TransformVector4fScalar(mat, Vector4f(p, 0.0f));
+        transformed = TransformDirection(mat, p);
+        CHECK_NEAR(transformed.x, direction.x, EPSILON);
+        CHECK_NEAR(transformed.y, direction.y, EPSILON);
+        CHECK_NEAR(transformed.z, direction.z, EPSILON);
+    }
+
+    // The batched path, with a count that leaves a scalar tail
+    const size_t COUNT = 37;
+    Matrix4f mat = GetRandomMatrix();
+    Vector3fStream in, out;
+    in.Resize(COUNT);
+    out.Resize(COUNT);
+    for(size_t i = 0; i < COUNT; i++) {
+        in.Set(i, Vector3f(GetRandom(), GetRandom(), GetRandom()));
+    }
+    TransformPoints(mat, in.View(), out.View(), COUNT);
+    for(size_t i = 0; i < COUNT; i++) {
+        Vector4f expected = TransformVector4fScalar(mat, Vector4f(in.Get(i), 1.0f));
+        CHECK_NEAR(out.x[i], expected.x, EPSILON);
+        CHECK_NEAR(out.y[i], expected.y, EPSILON);
+        CHECK_NEAR(out.z[i], expected.z, EPSILON);
+    }
+}
+
+static void TestBounds() {
+    // Every count up to a few vectors' worth, so each lane and each tail
+    // length holds the extremes at some point
+    for(size_t count = 1; count <= 37; count++) {
+        for(size_t extreme = 0; extreme < count; extreme++) {
+            Vector3fStream points;
+            points.Resize(count);
+            for(size_t i = 0; i < count; i++) {
+                points.Set(i, Vector3f(GetRandom(), GetRandom(), GetRandom()));
+            }
+            points.Set(extreme, Vector3f(-2.0f, 3.0f, -4.0f));
+            points.Set(count - 1 - extreme, Vector3f(5.0f, -6.0f, 7.0f));
+
+            Vector3f expectedMin = points.Get(0), expectedMax = points.Get(0);
+            for(size_t i = 1; i < count; i++) {
+                Vector3f p = points.Get(i);
+                expectedMin = Vector3f(std::min(expectedMin.x, p.x), std::min(expectedMin.y, p.y), std::min(expectedMin.z, p.z));
+                expectedMax = Vector3f(std::max(expectedMax.x, p.x), std::max(expectedMax.y, p.y), std::max(expectedMax.z, p.z));
+            }
+
+            Vector3f actualMin, actualMax;
+            ComputeBounds(points.View(), count, actualMin, actualMax);
+            CheckVectorNear(actualMin, expectedMin, 0.0f);
+            CheckVectorNear(actualMax, expectedMax, 0.0f);
+        }
+    }
+}
+
+static void TestInverse() {
+    for(uint32 n = 0; n < ITERATIONS; n++) {
+        Matrix4f mat = GetRandomMatrix();
+        // Keep the condition number reasonable so float precision is not the test
+        for(int i = 0; i < 4; i++) {
+            mat.m[i][i] += 40.0f;
+        }
+
+        Matrix4f expected, actual;
+        CHECK(InverseMatrix4fScalar(mat, expected));
+        CHECK(InverseMatrix4f(mat, actual));
+        CheckMatrixNear(actual, expected, EPSILON);
+        CheckMatrixNear(mat * mat.Inverse(), GetIdentityMatrix4f(), EPSILON);
+    }
+
+    // Singular matrices are reported and leave the output alone. A zero row
+    // makes the determinant exactly zero in every backend, nearly singular
+    // input is not detected.
+    Matrix4f singular = GetRandomMatrix();
+    for(int j = 0; j < 4; j++) {
+        singular.m[3][j] = 0.0f;
+    }
+    Matrix4f untouched = GetTranslationMatrix(1.0f, 2.0f, 3.0f), out = untouched;
+    CHECK(!InverseMatrix4f(singular, out));
+    CheckMatrixNear(out, untouched, 0.0f);
+    CheckMatrixNear(singular.Inverse(), GetIdentityMatrix4f(), 0.0f);
+}
+
+static void TestAffine() {
+    for(uint32 n = 0; n < ITERATIONS; n++) {
+        Matrix4f left = GetRandomMatrix(), right = GetRandomMatrix();
+        for(int j = 0; j < 4; j++) {
+            left.m[3][j] = right.m[3][j] = j == 3 ? 1.0f : 0.0f;
+        }
+
+        Matrix4f expected;
+        MultiplyMatrix4fScalar(left, right, expected);
+        CheckMatrixNear((GetMatrix3x4(left) * GetMatrix3x4(right)).ToMatrix4f(), expected, EPSILON);
+        CheckMatrixNear(left * GetMatrix3x4(right), expected, EPSILON);
+    }
+}
+
+static void TestAffineInverse() {
+    for(uint32 n = 0; n < ITERATIONS; n++) {
+        Matrix4f mat = GetRandomMatrix();
+        for(int i = 0; i < 3; i++) {
+            mat.m[i][i] += 40.0f;
+        }
+        Matrix3x4 affine = GetMatrix3x4(mat);
+
+        // M * inverse(M) and inverse(M) * M are identity, and the inverse
+        // matches the 4x4 one of the same transform
+        Matrix3x4 inverse;
+        CHECK(InverseMatrix3x4(affine, inverse));
+        CheckMatrixNear((affine * inverse).ToMatrix4f(), GetIdentityMatrix4f(), EPSILON);
+        CheckMatrixNear((inverse * affine).ToMatrix4f(), GetIdentityMatrix4f(), EPSILON);
+        CheckMatrixNear(affine.Inverse().ToMatrix4f(), affine.ToMatrix4f().Inverse(), EPSILON);
+    }
+
+    // Singular: reported, out untouched, Inverse() falls back to identity
+    Matrix3x4 singular = GetMatrix3x4(GetTranslationMatrix(1.0f, 2.0f, 3.0f));
+    for(int j = 0; j < 3; j++) {
+        singular.m[2][j] = 0.0f;
+    }
+    Matrix3x4 untouched = GetMatrix3x4(GetScaleMatrix(2.0f, 3.0f, 4.0f)), out = untouched;
+    CHECK(!InverseMatrix3x4(singular, out));
+    CheckMatrixNear(out.ToMatrix4f(), untouched.ToMatrix4f(), 0.0f);
+    CheckMatrixNear(singular.Inverse().ToMatrix4f(), GetIdentityMatrix4f(), 0.0f);
+}
+
+static void TestVector3f() {
+    Vector3f x(1.0f, 0.0f, 0.0f), y(0.0f, 1.0f, 0.0f), z(0.0f, 0.0f, 1.0f);
+    Vector3f cross = x.CrossProduct(y);
+    CHECK(cross.x == z.x && cross.y == z.y && cross.z == z.z);
+    cross = z.CrossProduct(x);
+    CHECK(cross.x == y.x && cross.y == y.y && cross.z == y.z);
+
+    Vector3f difference = Vector3f(3.0f, 2.0f, 1.0f) - Vector3f(1.0f, 1.0f, 1.0f);
+    CHECK(difference.x == 2.0f && difference.y == 1.0f && difference.z == 0.0f);
+
+    Vector3f zero = Vector3f().Normalize();
+    CHECK(zero.x == 0.0f && zero.y == 0.0f && zero.z == 0.0f);
+    CHECK_NEAR(Vector3f(3.0f, 4.0f, 0.0f).Normalize().y, 0.8f, EPSILON);
+}
+
+static Quaternion GetRandomQuaternion() {
+    return Quaternion(GetRandom(), GetRandom(), GetRandom(), GetRandom()).Normalize();
+}
+
+static void CheckQuaternionNear(const Quaternion& actual, const Quaternion& expected, float epsilon) {
+    CHECK_NEAR(actual.x, expected.x, epsilon);
+    CHECK_NEAR(actual.y, expected.y, epsilon);
+    CHECK_NEAR(actual.z, expected.z, epsilon);
+    CHECK_NEAR(actual.w, expected.w, epsilon);
+}
+
+static void TestQuaternionProduct() {
+    for(uint32 n = 0; n < ITERATIONS; n++) {
+        Quaternion a = GetRandomQuaternion(), b = GetRandomQuaternion();
+        Quaternion expected(a.w*b.x + a.x*b.w + a.y*b.z - a.z*b.y,
+                            a.w*b.y - a.x*b.z + a.y*b.w + a.z*b.x,
+                            a.w*b.z + a.x*b.y - a.y*b.x + a.z*b.w,
+                            a.w*b.w - a.x*b.x - a.y*b.y - a.z*b.z);
+        CheckQuaternionNear(a * b, expected, EPSILON);
+
+        // a * b applies b first
+        Vector3f v(GetRandom(), GetRandom(), GetRandom());
+        CheckVectorNear((a * b).Rotate(v), a.Rotate(b.Rotate(v)), EPSILON);
+        CheckVectorNear((a * a.Conjugate()).Rotate(v), v, EPSILON);
+    }
+}
+
+static void TestQuaternionMatrix() {
+    for(uint32 n = 0; n < ITERATIONS; n++) {
+        Quaternion q = GetRandomQuaternion();
+        Vector3f v(GetRandom(), GetRandom(), GetRandom());
+        Vector4f rotated = q.ToMatrix() * Vector4f(v, 0.0f);
+        CheckVectorNear(Vector3f(rotated.x, rotated.y, rotated.z), q.Rotate(v), EPSILON);
+        CheckMatrixNear(GetRotationMatrix(q), q.ToMatrix(), 0.0f);
+
+        // Euler angles are X, then Y, then Z
+        float x = GetRandom() * 180.0f, y = GetRandom() * 180.0f, z = GetRandom() * 180.0f;
+        CheckMatrixNear(GetRotationMatrix(x, y, z),
+                        GetRotationMatrix(0.0f, 0.0f, z) * GetRotationMatrix(0.0f, y, 0.0f) * GetRotationMatrix(x, 0.0f, 0.0f),
+                        EPSILON);
+    }
+
+    // Right handed: a quarter turn about Z takes X to Y
+    Quaternion quarter = GetAxisAngleQuaternion(Vector3f(0.0f, 0.0f, 1.0f), PI / 2.0f);
+    CheckVectorNear(quarter.Rotate(Vector3f(1.0f, 0.0f, 0.0f)), Vector3f(0.0f, 1.0f, 0.0f), EPSILON);
+    Matrix4f expected = GetIdentityMatrix4f();
+    expected.m[0][0] = expected.m[1][1] = 0.0f;
+    expected.m[0][1] = -1.0f;
+    expected.m[1][0] = 1.0f;
+    CheckMatrixNear(quarter.ToMatrix(), expected, EPSILON);
+}
+
+static void TestSlerp() {
+    Vector3f axis = Vector3f(1.0f, 2.0f, 3.0f).Normalize();
+    for(uint32 n = 0; n < ITERATIONS; n++) {
+        Quaternion a = GetRandomQuaternion(), b = GetRandomQuaternion();
+        CheckQuaternionNear(Slerp(a, b, 0.0f), a, EPSILON);
+        // Shortest path: b and -b are the same rotation, the end is
+        // whichever of them is in a's hemisphere and so is every step
+        Quaternion negated(-b.x, -b.y, -b.z, -b.w);
+        CheckQuaternionNear(Slerp(a, b, 1.0f), DotQuaternion(a, b) >= 0.0f ? b : negated, EPSILON);
+        float t = (GetRandom() + 1.0f) * 0.5f;
+        CheckQuaternionNear(Slerp(a, negated, t), Slerp(a, b, t), EPSILON);
+        CheckQuaternionNear(Nlerp(a, negated, t), Nlerp(a, b, t), EPSILON);
+        CHECK(DotQuaternion(Slerp(a, b, t), a) >= fabsf(DotQuaternion(a, b)) - EPSILON);
+
+        // Constant angular velocity from a rotation about one axis
+        float angle = (GetRandom() + 1.0f) * 1.5f + 0.1f;
+        Quaternion start = GetAxisAngleQuaternion(axis, 0.0f), end = GetAxisAngleQuaternion(axis, angle);
+        CheckQuaternionNear(Slerp(start, end, 0.5f), GetAxisAngleQuaternion(axis, angle * 0.5f), EPSILON);
+        CheckQuaternionNear(Slerp(start, end, t), GetAxisAngleQuaternion(axis, angle * t), EPSILON);
+    }
+
+    // Nearly parallel takes the Nlerp path and still hits the endpoints
+    Quaternion a = GetAxisAngleQuaternion(axis, 0.5f), b = GetAxisAngleQuaternion(axis, 0.51f);
+    CheckQuaternionNear(Slerp(a, b, 0.0f), a, EPSILON);
+    CheckQuaternionNear(Slerp(a, b, 1.0f), b, EPSILON);
+    CheckQuaternionNear(Slerp(a, b, 0.5f), GetAxisAngleQuaternion(axis, 0.505f), EPSILON);
+}
+
+static void TestQuaternionHierarchy() {
+    // Two chains, root 0 -> 1 -> 3 and root 2 -> 4
+    const int parents[] = { -1, 0, -1, 1, 2 };
+    const size_t COUNT = sizeof(parents) / sizeof(parents[0]);
+    Quaternion local[COUNT], world[COUNT];
+    for(size_t i = 0; i < COUNT; i++) {
+        local[i] = GetRandomQuaternion();
+    }
+    ComposeQuaternionHierarchy(parents, local, world, COUNT);
+
+    Vector3f v(GetRandom(), GetRandom(), GetRandom());
+    CheckQuaternionNear(world[0], local[0], 0.0f);
+    CheckQuaternionNear(world[2], local[2], 0.0f);
+    CheckVectorNear(world[3].Rotate(v), local[0].Rotate(local[1].Rotate(local[3].Rotate(v))), EPSILON);
+    CheckVectorNear(world[4].Rotate(v), local[2].Rotate(local[4].Rotate(v)), EPSILON);
+
+    // The batched product, with a count that leaves a scalar tail, and in place
+    const size_t BATCH = 11;
+    Quaternion lq[BATCH], rq[BATCH], out[BATCH];
+    for(size_t i = 0; i < BATCH; i++) {
+        lq[i] = GetRandomQuaternion();
+        rq[i] = GetRandomQuaternion();
+    }
+    ComposeQuaternions(lq, rq, out, BATCH);
+    for(size_t i = 0; i < BATCH; i++) {
+        CheckQuaternionNear(out[i], lq[i] * rq[i], EPSILON);
+    }
+    ComposeQuaternions(lq, rq, lq, BATCH);
+    for(size_t i = 0; i < BATCH; i++) {
+        CheckQuaternionNear(lq[i], out[i], 0.0f);
+    }
+}
+
+
+int main() {
+    srand(1);
+    TestMultiply();
+    TestTransform();
+    TestBounds();
+    TestInverse();
+    TestAffine();
+    TestAffineInverse();
+    TestVector3f();
+    TestQuaternionProduct();
+    TestQuaternionMatrix();
+    TestSlerp();
+    TestQuaternionHierarchy();
+    return FinishTests("MathTests");
+}
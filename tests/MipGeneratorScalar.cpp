@@ -0,0 +1,5 @@
+// MipGenerator.cpp again with MIPGENERATOR_NO_SIMD, renamed so
+// MipGeneratorTests can compare the scalar and SSE2 paths in one process
+#define MIPGENERATOR_NO_SIMD
+#define GenerateMipChain GenerateMipChainScalar
+#include "../source/src/MipGenerator.cpp"
@@ -0,0 +1,92 @@
+// GenerateMipChain: chain sizes, rounding of exact halves, gamma-correct
+// filtering of sRGB images, and the SSE2 path against the scalar one
+// (tests/MipGeneratorScalar.cpp).
+
+#include <cstdlib>
+#include <vector>
+#include "Test.h"
+#include "MipGenerator.h"
+
+std::vector<MipLevel> GenerateMipChainScalar(const uint8 *pixels, uint32 width, uint32 height, uint32 channels, bool srgb,
+                                             MipFilter filter);
+
+static void TestChainSizes() {
+    std::vector<uint8> pixels(5 * 3 * 4, 0x80);
+    std::vector<MipLevel> levels = GenerateMipChain(pixels.data(), 5, 3, 4, false, MIP_FILTER_BOX);
+    CHECK(levels.size() == 3);
+    CHECK(levels[0].pixels == pixels);
+    CHECK(levels[1].width == 2 && levels[1].height == 1);
+    CHECK(levels[2].width == 1 && levels[2].height == 1);
+    CHECK(levels[1].pixels.size() == 2 * 4);
+    CHECK(levels[2].pixels.size() == 4);
+}
+
+static void TestRoundHalfUp() {
+    // Columns of 0 and 1 average to exactly 0.5, which rounds up
+    const uint8 pixels[] = { 0, 0, 0, 1, 1, 1,
+                             0, 0, 0, 1, 1, 1 };
+    std::vector<MipLevel> levels = GenerateMipChain(pixels, 2, 2, 3, false, MIP_FILTER_BOX);
+    CHECK(levels.size() == 2);
+    CHECK(levels[1].pixels.size() == 3);
+    for(uint8 value : levels[1].pixels) {
+        CHECK(value == 1);
+    }
+}
+
+static void TestGammaCorrect() {
+    // A black and white checkerboard is half as bright in linear light,
+    // sRGB 188 rather than the 128 of averaging the encoded values
+    std::vector<uint8> pixels(4 * 4 * 4);
+    for(uint32 y = 0; y < 4; y++) {
+        for(uint32 x = 0; x < 4; x++) {
+            uint8 *texel = &pixels[(y * 4 + x) * 4];
+            texel[0] = texel[1] = texel[2] = (x + y) % 2 ? 255 : 0;
+            texel[3] = (x + y) % 2 ? 255 : 0;
+        }
+    }
+
+    std::vector<MipLevel> levels = GenerateMipChain(pixels.data(), 4, 4, 4, true, MIP_FILTER_BOX);
+    CHECK(levels.size() == 3);
+    for(uint32 level = 1; level < levels.size(); level++) {
+        for(size_t i = 0; i < levels[level].pixels.size(); i += 4) {
+            CHECK_NEAR(levels[level].pixels[i + 0], 188, 1);
+            CHECK_NEAR(levels[level].pixels[i + 1], 188, 1);
+            CHECK_NEAR(levels[level].pixels[i + 2], 188, 1);
+            // Alpha is linear either way
+            CHECK(levels[level].pixels[i + 3] == 128);
+        }
+    }
+
+    // Without srgb the same image averages the stored values
+    levels = GenerateMipChain(pixels.data(), 4, 4, 4, false, MIP_FILTER_BOX);
+    CHECK(levels[1].pixels[0] == 128);
+}
+
+static void TestScalarMatchesSIMD() {
+    srand(7);
+    std::vector<uint8> pixels(37 * 23 * 4);
+    for(uint8& value : pixels) {
+        value = (uint8)(rand() & 0xFF);
+    }
+
+    for(uint32 channels = 3; channels <= 4; channels++) {
+        for(bool srgb : { false, true }) {
+            for(MipFilter filter : { MIP_FILTER_BOX, MIP_FILTER_KAISER }) {
+                std::vector<MipLevel> simd = GenerateMipChain(pixels.data(), 37, 23, channels, srgb, filter);
+                std::vector<MipLevel> scalar = GenerateMipChainScalar(pixels.data(), 37, 23, channels, srgb, filter);
+                CHECK(simd.size() == scalar.size());
+                for(size_t level = 0; level < simd.size() && level < scalar.size(); level++) {
+                    CHECK(simd[level].pixels == scalar[level].pixels);
+                }
+            }
+        }
+    }
+}
+
+int main() {
+    TestChainSizes();
+    TestRoundHalfUp();
+    TestGammaCorrect();
+    TestScalarMatchesSIMD();
+    return FinishTests("MipGeneratorTests");
+}
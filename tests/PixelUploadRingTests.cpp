@@ -0,0 +1,128 @@
+// PixelUploadRing against the stub GL, with and without a persistent
+// mapping: rows streamed through the unpack buffer, rows that don't fit the
+// segment going up directly, the per-frame fences and mip chains uploaded
+// through Texture.
+
+#include <vector>
+#include "Test.h"
+#include "StubGL.h"
+#include "PixelUploadRing.h"
+#include "Texture.h"
+
+static std::vector<uint8> MakePixels(uint32 size) {
+    std::vector<uint8> pixels(size);
+    for(uint32 i = 0; i < size; i++) {
+        pixels[i] = (uint8)(i * 13 + 5);
+    }
+    return pixels;
+}
+
+// A bound texture with an empty RGBA level 0 of width x height
+static uint32 CreateLevel(int32 width, int32 height) {
+    uint32 texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    return texture;
+}
+
+static void TestUpload(bool bufferStorage) {
+    InstallStubGL(bufferStorage ? 4 : 3, bufferStorage ? 4 : 3);
+    CHECK(GLEXT_ARB_buffer_storage == (bufferStorage ? 1 : 0));
+
+    {
+        PixelUploadRing ring(4096, 3);
+        ring.BeginFrame();
+
+        uint32 texture = CreateLevel(16, 8);
+        std::vector<uint8> pixels = MakePixels(16 * 8 * 4);
+        ring.Upload(0, 16, 8, GL_RGBA, 4, pixels.data());
+        CHECK(ring.streamedBytes == pixels.size());
+        CHECK(ring.directBytes == 0);
+        CHECK(GetStubGL().textures[texture][0].pixels == pixels);
+        // Left unbound, later glTexImage2D pointers are pointers again
+        CHECK(GetStubGL().boundBuffers[GL_PIXEL_UNPACK_BUFFER] == 0);
+
+        // The rest of the segment takes the first 14 rows of the next image,
+        // the last 2 go up from client memory
+        std::vector<uint8> more = MakePixels(64 * 16 * 4);
+        CreateLevel(64, 16);
+        ring.Upload(0, 64, 16, GL_RGBA, 4, more.data());
+        CHECK(ring.streamedBytes == pixels.size() + 14 * 64 * 4);
+        CHECK(ring.directBytes == 2 * 64 * 4);
+        CHECK(GetStubGL().textures[GetStubGL().boundTexture][0].pixels == more);
+
+        // A full segment sends everything directly until the next frame
+        ring.Upload(0, 64, 16, GL_RGBA, 4, more.data());
+        CHECK(ring.directBytes == 18 * 64 * 4);
+        ring.EndFrame();
+
+        ring.BeginFrame();
+        uint64 streamed = ring.streamedBytes;
+        ring.Upload(0, 16, 8, GL_RGBA, 4, pixels.data());
+        CHECK(ring.streamedBytes == streamed + pixels.size());
+        ring.EndFrame();
+    }
+    CHECK(GetStubGL().liveFences == 0);
+    CHECK(GetStubGL().buffers.empty());
+}
+
+static void TestFences() {
+    InstallStubGL(4, 4);
+    {
+        PixelUploadRing ring(64, 3);
+        std::vector<uint8> pixels = MakePixels(64);
+        CreateLevel(4, 4);
+        for(uint32 frame = 0; frame < 6; frame++) {
+            ring.BeginFrame();
+            ring.Upload(0, 4, 4, GL_RGBA, 4, pixels.data());
+            ring.EndFrame();
+        }
+
+        // Only reusing a segment waits for its fence
+        CHECK(ring.streamedBytes == 6 * 64);
+        CHECK(GetStubGL().fences == 6);
+        CHECK(GetStubGL().fenceWaits == 3);
+        CHECK(GetStubGL().liveFences == 3);
+    }
+    CHECK(GetStubGL().liveFences == 0);
+}
+
+static void TestMipChain() {
+    InstallStubGL(4, 4);
+
+    std::vector<uint8> pixels = MakePixels(8 * 4 * 3);
+    std::vector<MipLevel> levels = GenerateMipChain(pixels.data(), 8, 4, 3, false, MIP_FILTER_BOX);
+
+    // Through the ring and from client memory, the levels come out the same
+    Texture direct;
+    direct.CreateTexture();
+    direct.UploadMipChain(levels, false);
+
+    PixelUploadRing ring(1024, 3);
+    ring.BeginFrame();
+    Texture streamed;
+    streamed.CreateTexture();
+    streamed.UploadMipChain(levels, false, &ring);
+    ring.EndFrame();
+
+    const std::vector<StubTextureLevel>& expected = GetStubGL().textures[direct.textureID];
+    const std::vector<StubTextureLevel>& actual = GetStubGL().textures[streamed.textureID];
+    CHECK(actual.size() == levels.size());
+    CHECK(expected.size() == levels.size());
+    for(size_t level = 0; level < actual.size() && level < expected.size(); level++) {
+        CHECK(actual[level].width == expected[level].width && actual[level].height == expected[level].height);
+        CHECK(actual[level].pixels == levels[level].pixels);
+        CHECK(expected[level].pixels == levels[level].pixels);
+    }
+    CHECK(ring.streamedBytes == (8 * 4 + 4 * 2 + 2 * 1 + 1) * 3);
+    CHECK(ring.directBytes == 0);
+}
+
+int main() {
+    TestUpload(false);
+    TestUpload(true);
+    TestFences();
+    TestMipChain();
+    return FinishTests("PixelUploadRingTests");
+}
@@ -0,0 +1,232 @@
+// ProgramBinaryCache on the stub GL, in a temporary directory: a cold start
+// that compiles and saves every program then a warm one that only loads
+// binaries, the fallback to compiling when the driver changed, and corrupt
+// or truncated entries.
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <unistd.h>
+#include "Test.h"
+#include "StubGL.h"
+#include "Shader.h"
+#include "ProgramBinaryCache.h"
+
+const uint32 PROGRAM_COUNT = 64;
+// Offset of ProgramBinaryHeader::length in an entry
+const long LENGTH_OFFSET = 20;
+
+static std::string directory;
+
+static std::string GetVertexShader(uint32 variant) {
+    return "#version 330\n// variant " + std::to_string(variant) + "\nvoid main() {}\n";
+}
+
+static const char *fragmentShader = "#version 330\nvoid main() {}\n";
+
+static std::string GetEntryPath(const ProgramBinaryCache& cache, uint32 variant) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", cache.GetKey(GetVertexShader(variant).c_str(), fragmentShader));
+    return directory + "/" + name;
+}
+
+static void RemoveEntries() {
+    DIR *entries = opendir(directory.c_str());
+    if(!entries) {
+        return;
+    }
+    while(dirent *entry = readdir(entries)) {
+        if(entry->d_name[0] != '.') {
+            remove((directory + "/" + entry->d_name).c_str());
+        }
+    }
+    closedir(entries);
+}
+
+// Builds the programs through cache, returns how many came up ready
+static uint32 BuildPrograms(ProgramBinaryCache& cache, uint32 count) {
+    std::vector<std::unique_ptr<Shader>> shaders;
+    for(uint32 i = 0; i < count; i++) {
+        shaders.emplace_back(new Shader(GetVertexShader(i).c_str(), fragmentShader, &cache));
+    }
+    uint32 ready = 0;
+    for(const auto& shader : shaders) {
+        ready += shader->Finalize();
+    }
+    return ready;
+}
+
+static void TestColdAndWarmStart() {
+    InstallStubGL(4, 1);
+    RemoveEntries();
+
+    // Every program compiles and is saved
+    {
+        ProgramBinaryCache cache(directory);
+        CHECK(cache.IsSupported());
+        CHECK(BuildPrograms(cache, PROGRAM_COUNT) == PROGRAM_COUNT);
+        CHECK(cache.misses == PROGRAM_COUNT);
+        CHECK(cache.hits == 0);
+        CHECK(GetStubGL().linkedPrograms == PROGRAM_COUNT);
+        printf("Cold start: ");
+        cache.PrintStats();
+    }
+
+    // A later run finds them all and links nothing
+    ProgramBinaryCache cache(directory);
+    CHECK(BuildPrograms(cache, PROGRAM_COUNT) == PROGRAM_COUNT);
+    CHECK(cache.hits == PROGRAM_COUNT);
+    CHECK(cache.misses == 0);
+    CHECK(GetStubGL().linkedPrograms == PROGRAM_COUNT);
+    CHECK(GetStubGL().binaryLoads == PROGRAM_COUNT);
+    printf("Warm start: ");
+    cache.PrintStats();
+}
+
+static void TestUnsupported() {
+    InstallStubGL(3, 3);
+    RemoveEntries();
+
+    ProgramBinaryCache cache(directory);
+    CHECK(!cache.IsSupported());
+    CHECK(BuildPrograms(cache, 1) == 1);
+    CHECK(BuildPrograms(cache, 1) == 1);
+    CHECK(cache.hits == 0);
+    CHECK(GetStubGL().binaryLoads == 0);
+}
+
+static void TestDriverChange() {
+    InstallStubGL(4, 1);
+    RemoveEntries();
+    {
+        ProgramBinaryCache cache(directory);
+        BuildPrograms(cache, 1);
+    }
+
+    // Another renderer hashes to other keys and doesn't even find the entry
+    GetStubGL().renderer = "Other";
+    {
+        ProgramBinaryCache cache(directory);
+        CHECK(BuildPrograms(cache, 1) == 1);
+        CHECK(cache.misses == 1);
+        CHECK(GetStubGL().binaryLoads == 0);
+    }
+
+    // Same strings but a binary the driver no longer takes: compiled again
+    // and saved over the stale entry
+    GetStubGL().binaryFormat = 2;
+    uint32 linked = GetStubGL().linkedPrograms;
+    {
+        ProgramBinaryCache cache(directory);
+        CHECK(BuildPrograms(cache, 1) == 1);
+        CHECK(cache.misses == 1);
+        CHECK(cache.hits == 0);
+        CHECK(GetStubGL().linkedPrograms == linked + 1);
+    }
+    {
+        ProgramBinaryCache cache(directory);
+        CHECK(BuildPrograms(cache, 1) == 1);
+        CHECK(cache.hits == 1);
+    }
+}
+
+// Saves a good entry for variant 0 and returns its contents
+static std::vector<uint8> SaveEntry(std::string& path) {
+    InstallStubGL(4, 1);
+    RemoveEntries();
+    ProgramBinaryCache cache(directory);
+    BuildPrograms(cache, 1);
+
+    path = GetEntryPath(cache, 0);
+    std::vector<uint8> contents;
+    FILE *file = fopen(path.c_str(), "rb");
+    CHECK(file != nullptr);
+    if(file) {
+        uint8 buffer[256];
+        size_t read;
+        while((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+            contents.insert(contents.end(), buffer, buffer + read);
+        }
+        fclose(file);
+    }
+    return contents;
+}
+
+static void WriteEntry(const std::string& path, const std::vector<uint8>& contents) {
+    FILE *file = fopen(path.c_str(), "wb");
+    CHECK(file != nullptr);
+    if(file) {
+        fwrite(contents.data(), 1, contents.size(), file);
+        fclose(file);
+    }
+}
+
+// Whether a cache over the damaged entry falls back to compiling
+static bool CompilesAgain() {
+    ProgramBinaryCache cache(directory);
+    uint32 ready = BuildPrograms(cache, 1);
+    return ready == 1 && cache.misses == 1 && cache.hits == 0 && GetStubGL().binaryLoads == 0;
+}
+
+static void TestCorruptEntries() {
+    std::string path;
+    std::vector<uint8> contents = SaveEntry(path);
+    CHECK(contents.size() > (size_t)LENGTH_OFFSET + 4);
+
+    // Truncated in the binary and in the header
+    std::vector<uint8> damaged(contents.begin(), contents.end() - 1);
+    WriteEntry(path, damaged);
+    CHECK(CompilesAgain());
+
+    contents = SaveEntry(path);
+    damaged.assign(contents.begin(), contents.begin() + 10);
+    WriteEntry(path, damaged);
+    CHECK(CompilesAgain());
+
+    // Trailing bytes
+    contents = SaveEntry(path);
+    damaged = contents;
+    damaged.push_back(0);
+    WriteEntry(path, damaged);
+    CHECK(CompilesAgain());
+
+    // A length far past the end of the file is rejected before allocating it
+    contents = SaveEntry(path);
+    damaged = contents;
+    damaged[LENGTH_OFFSET + 0] = damaged[LENGTH_OFFSET + 1] = damaged[LENGTH_OFFSET + 2] = 0xFF;
+    damaged[LENGTH_OFFSET + 3] = 0xFF;
+    WriteEntry(path, damaged);
+    CHECK(CompilesAgain());
+
+    // Wrong magic
+    contents = SaveEntry(path);
+    damaged = contents;
+    damaged[0] ^= 0xFF;
+    WriteEntry(path, damaged);
+    CHECK(CompilesAgain());
+
+    // The fallback saved a good entry again
+    ProgramBinaryCache cache(directory);
+    CHECK(BuildPrograms(cache, 1) == 1);
+    CHECK(cache.hits == 1);
+}
+
+int main() {
+    char root[] = "/tmp/ProgramBinaryCacheTests.XXXXXX";
+    if(!mkdtemp(root)) {
+        perror(root);
+        return 1;
+    }
+    directory = root;
+
+    TestColdAndWarmStart();
+    TestUnsupported();
+    TestDriverChange();
+    TestCorruptEntries();
+
+    RemoveEntries();
+    rmdir(root);
+    return FinishTests("ProgramBinaryCacheTests");
+}
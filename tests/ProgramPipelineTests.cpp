@@ -0,0 +1,112 @@
+// ProgramPipeline and ShaderStageCache against the stub GL: stage changes,
+// stalls on stages still compiling and stages whose Shader swapped in a new
+// program.
+
+#include "Test.h"
+#include "StubGL.h"
+#include "Shader.h"
+#include "ProgramPipeline.h"
+
+static uint32 AttachedProgram(const ProgramPipeline& pipeline, uint32 stageBit) {
+    return GetStubGL().pipelineStages[pipeline.ID][stageBit];
+}
+
+static void TestStages() {
+    InstallStubGL(3, 3, { "GL_ARB_separate_shader_objects" });
+    CHECK(GLEXT_ARB_separate_shader_objects);
+
+    ShaderStageCache stages;
+    Shader *vertex = stages.GetStage(GL_VERTEX_SHADER, "vertex");
+    Shader *fragment = stages.GetStage(GL_FRAGMENT_SHADER, "fragment");
+    CHECK(stages.GetStage(GL_VERTEX_SHADER, "vertex") == vertex);
+    CHECK(stages.GetStage(GL_FRAGMENT_SHADER, "vertex") != vertex);
+    CHECK(stages.GetStageCount() == 3);
+    CHECK(vertex->IsSeparable());
+
+    ProgramPipeline pipeline;
+    pipeline.SetVertexStage(vertex);
+    pipeline.SetFragmentStage(fragment);
+    CHECK(pipeline.stageChanges == 2);
+    CHECK(AttachedProgram(pipeline, GL_VERTEX_SHADER_BIT) == vertex->ID);
+    CHECK(AttachedProgram(pipeline, GL_FRAGMENT_SHADER_BIT) == fragment->ID);
+
+    // Setting what is already there issues nothing
+    pipeline.SetVertexStage(vertex);
+    pipeline.Bind();
+    CHECK(pipeline.stageChanges == 2);
+    CHECK(GetStubGL().boundPipeline == pipeline.ID);
+    CHECK(GetStubGL().usedProgram == 0);
+
+    pipeline.SetActiveStage(fragment);
+    CHECK(GetStubGL().activeProgram == fragment->ID);
+}
+
+static void TestStalls() {
+    InstallStubGL(3, 3, { "GL_ARB_separate_shader_objects", "GL_KHR_parallel_shader_compile" });
+    GetStubGL().compilesPending = true;
+
+    ShaderStageCache stages;
+    Shader *vertex = stages.GetStage(GL_VERTEX_SHADER, "vertex");
+    CHECK(vertex->GetState() == SHADER_COMPILING);
+
+    // Attaching a stage the driver hasn't finished blocks on it
+    uint32 stalls = GetShaderCompileStats().stalls;
+    ProgramPipeline pipeline;
+    pipeline.SetVertexStage(vertex);
+    CHECK(vertex->GetState() == SHADER_READY);
+    CHECK(GetShaderCompileStats().stalls == stalls + 1);
+
+    // Ready stages are not counted
+    Shader *fragment = stages.GetStage(GL_FRAGMENT_SHADER, "fragment");
+    GetStubGL().compilesPending = false;
+    CHECK(fragment->IsReady());
+    pipeline.SetFragmentStage(fragment);
+    CHECK(GetShaderCompileStats().stalls == stalls + 1);
+}
+
+static void TestSwappedStage() {
+    InstallStubGL(3, 3, { "GL_ARB_separate_shader_objects" });
+
+    ShaderStageCache stages;
+    Shader *vertex = stages.GetStage(GL_VERTEX_SHADER, "vertex");
+    Shader *fragment = stages.GetStage(GL_FRAGMENT_SHADER, "fragment");
+
+    ProgramPipeline pipeline;
+    pipeline.SetVertexStage(vertex);
+    pipeline.SetFragmentStage(fragment);
+    pipeline.SetActiveStage(fragment);
+    pipeline.Bind();
+    uint32 changes = pipeline.stageChanges;
+
+    // A hot reload swaps a rebuilt program into the same Shader
+    Shader rebuilt(GL_FRAGMENT_SHADER, "fragment v2");
+    CHECK(rebuilt.Finalize());
+    uint32 oldProgram = fragment->ID;
+    fragment->Swap(rebuilt);
+    CHECK(fragment->ID != oldProgram);
+    CHECK(AttachedProgram(pipeline, GL_FRAGMENT_SHADER_BIT) == oldProgram);
+
+    // Bind attaches the new program, the untouched stage stays
+    pipeline.Bind();
+    CHECK(AttachedProgram(pipeline, GL_FRAGMENT_SHADER_BIT) == fragment->ID);
+    CHECK(AttachedProgram(pipeline, GL_VERTEX_SHADER_BIT) == vertex->ID);
+    CHECK(pipeline.stageChanges == changes + 1);
+    CHECK(GetStubGL().activeProgram == fragment->ID);
+
+    pipeline.Bind();
+    CHECK(pipeline.stageChanges == changes + 1);
+
+    // Setting the same Shader after a swap attaches it as well
+    Shader rebuiltVertex(GL_VERTEX_SHADER, "vertex v2");
+    vertex->Swap(rebuiltVertex);
+    pipeline.SetVertexStage(vertex);
+    CHECK(AttachedProgram(pipeline, GL_VERTEX_SHADER_BIT) == vertex->ID);
+    CHECK(pipeline.stageChanges == changes + 2);
+}
+
+int main() {
+    TestStages();
+    TestStalls();
+    TestSwappedStage();
+    return FinishTests("ProgramPipelineTests");
+}
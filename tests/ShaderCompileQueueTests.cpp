@@ -0,0 +1,104 @@
+// ShaderCompileQueue and Shader's lazy finalization against the stub GL,
+// with the driver still compiling (KHR_parallel_shader_compile) and
+// without the extension.
+
+#include <memory>
+#include <vector>
+#include "Test.h"
+#include "StubGL.h"
+#include "Shader.h"
+#include "ShaderCompileQueue.h"
+
+static std::vector<std::unique_ptr<Shader>> CreateShaders(ShaderCompileQueue& queue, uint32 count) {
+    std::vector<std::unique_ptr<Shader>> shaders;
+    for(uint32 i=0; i<count; ++i) {
+        shaders.emplace_back(new Shader("vertex", "fragment"));
+        queue.Add(shaders.back().get());
+    }
+    return shaders;
+}
+
+static void TestWithoutExtension() {
+    InstallStubGL();
+    CHECK(!GLEXT_KHR_parallel_shader_compile);
+
+    ShaderCompileQueue queue;
+    std::vector<std::unique_ptr<Shader>> shaders = CreateShaders(queue, 3);
+    CHECK(queue.GetPendingCount() == 3);
+    CHECK(GetStubGL().linkedPrograms == 3);
+
+    // Without the extension there is no way to ask, Poll finishes them all
+    CHECK(queue.Poll() == 0);
+    for(const auto& shader : shaders) {
+        CHECK(shader->GetState() == SHADER_READY);
+    }
+}
+
+static void TestParallelCompile() {
+    InstallStubGL(3, 3, { "GL_KHR_parallel_shader_compile" });
+    CHECK(GLEXT_KHR_parallel_shader_compile);
+
+    ShaderCompileQueue queue;
+    CHECK(GetStubGL().maxCompilerThreads == 0xFFFFFFFF);
+
+    GetStubGL().compilesPending = true;
+    std::vector<std::unique_ptr<Shader>> shaders = CreateShaders(queue, 4);
+
+    // Polling while the driver is busy neither blocks nor finishes anything
+    CHECK(queue.Poll() == 4);
+    CHECK(!shaders[0]->IsReady());
+    CHECK(shaders[0]->GetState() == SHADER_COMPILING);
+
+    // Needing a program early finalizes it on the spot, counted as a stall
+    uint32 stalls = GetShaderCompileStats().stalls;
+    shaders[1]->UseShader();
+    CHECK(shaders[1]->GetState() == SHADER_READY);
+    CHECK(GetStubGL().usedProgram == shaders[1]->ID);
+    CHECK(GetShaderCompileStats().stalls == stalls + 1);
+    CHECK(queue.Poll() == 3);
+
+    GetStubGL().compilesPending = false;
+    CHECK(queue.Poll() == 0);
+    for(const auto& shader : shaders) {
+        CHECK(shader->GetState() == SHADER_READY);
+    }
+    // Finalized through the queue, not stalls
+    CHECK(GetShaderCompileStats().stalls == stalls + 1);
+
+    // Needed before the queue got to it, but the driver is done: no stall
+    std::vector<std::unique_ptr<Shader>> finished = CreateShaders(queue, 1);
+    CHECK(finished[0]->GetState() == SHADER_COMPILING);
+    CHECK(finished[0]->EnsureReady());
+    CHECK(GetShaderCompileStats().stalls == stalls + 1);
+    CHECK(queue.Poll() == 0);
+
+    // Ready programs are not queued again
+    queue.Add(shaders[0].get());
+    CHECK(queue.GetPendingCount() == 0);
+}
+
+static void TestFinishAll() {
+    InstallStubGL(3, 3, { "GL_KHR_parallel_shader_compile" });
+    GetStubGL().compilesPending = true;
+
+    ShaderCompileQueue queue;
+    std::vector<std::unique_ptr<Shader>> shaders = CreateShaders(queue, 2);
+    shaders.emplace_back(new Shader("vertex", "#error broken"));
+    queue.Add(shaders.back().get());
+    CHECK(queue.GetPendingCount() == 3);
+
+    // Failures leave the queue like successes do
+    queue.FinishAll();
+    CHECK(queue.GetPendingCount() == 0);
+    CHECK(shaders[0]->GetState() == SHADER_READY);
+    CHECK(shaders[2]->GetState() == SHADER_FAILED);
+    CHECK(!shaders[2]->IsReady());
+    CHECK(shaders[2]->GetUniform("color") == INVALID_UNIFORM);
+}
+
+int main() {
+    TestWithoutExtension();
+    TestParallelCompile();
+    TestFinishAll();
+    return FinishTests("ShaderCompileQueueTests");
+}
@@ -0,0 +1,137 @@
+// ShaderPreprocessor on in-memory files (UpdateFile): include resolution,
+// #pragma once, injected defines, #line numbering, dependencies and the
+// error cases.
+
+#include <string>
+#include "Test.h"
+#include "ShaderPreprocessor.h"
+
+static bool Contains(const std::string& source, const std::string& text) {
+    return source.find(text) != std::string::npos;
+}
+
+static void TestNormalizePath() {
+    CHECK(ShaderPreprocessor::NormalizePath("shaders/a.vs") == "shaders/a.vs");
+    CHECK(ShaderPreprocessor::NormalizePath("./shaders//a.vs") == "shaders/a.vs");
+    CHECK(ShaderPreprocessor::NormalizePath("shaders/lib/../a.vs") == "shaders/a.vs");
+    CHECK(ShaderPreprocessor::NormalizePath("../shaders/a.vs") == "../shaders/a.vs");
+    CHECK(ShaderPreprocessor::NormalizePath("/root/./shaders/a.vs") == "/root/shaders/a.vs");
+}
+
+static void TestIncludes() {
+    ShaderPreprocessor preprocessor;
+    preprocessor.AddIncludePath("lib");
+    preprocessor.UpdateFile("shaders/a.vs", "#version 330\n#include \"common.glsl\"\n#include <light.glsl>\nvoid main() {}\n");
+    preprocessor.UpdateFile("shaders/common.glsl", "#pragma once\nfloat common() { return 1.0; }\n");
+    preprocessor.UpdateFile("lib/light.glsl", "#include \"../shaders/common.glsl\"\nfloat light() { return 2.0; }\n");
+
+    PreprocessedShader out;
+    CHECK(preprocessor.Preprocess("./shaders/a.vs", "", out));
+    CHECK(out.dependencies.size() == 3);
+    CHECK(out.dependencies[0] == "shaders/a.vs");
+    CHECK(out.dependencies[1] == "shaders/common.glsl");
+    CHECK(out.dependencies[2] == "lib/light.glsl");
+
+    // #pragma once keeps the second include of common.glsl out
+    size_t first = out.source.find("float common()");
+    CHECK(first != std::string::npos);
+    CHECK(out.source.find("float common()", first + 1) == std::string::npos);
+    CHECK(Contains(out.source, "float light()"));
+
+    // #line numbers the source strings by dependency index
+    CHECK(Contains(out.source, "#line 1 1\n"));
+    CHECK(Contains(out.source, "#line 1 2\n"));
+    CHECK(Contains(out.source, "#line 3 0\n"));
+    CHECK(Contains(out.source, "#line 4 0\nvoid main() {}\n"));
+
+    // Only "once" itself is #pragma once, with any spacing around it
+    preprocessor.UpdateFile("b.vs", "#include \"once.glsl\"\n#include \"once.glsl\"\n"
+                                    "#include \"other.glsl\"\n#include \"other.glsl\"\n");
+    preprocessor.UpdateFile("once.glsl", "  #  pragma\tonce  \nfloat once;\n");
+    preprocessor.UpdateFile("other.glsl", "#pragma debug(once)\nfloat other;\n");
+    CHECK(preprocessor.Preprocess("b.vs", "", out));
+    first = out.source.find("float once;");
+    CHECK(first != std::string::npos);
+    CHECK(out.source.find("float once;", first + 1) == std::string::npos);
+    first = out.source.find("#pragma debug(once)\nfloat other;\n");
+    CHECK(first != std::string::npos);
+    CHECK(out.source.find("#pragma debug(once)\nfloat other;\n", first + 1) != std::string::npos);
+}
+
+static void TestDefines() {
+    ShaderPreprocessor preprocessor;
+    preprocessor.SetDefine("MAX_LIGHTS", "4");
+    preprocessor.SetDefine("MAX_LIGHTS", "8");
+    preprocessor.UpdateFile("a.fs", "// header\n#version 330 core\nvoid main() {}\n");
+    preprocessor.UpdateFile("b.fs", "void main() {}\n");
+
+    PreprocessedShader out;
+    CHECK(preprocessor.Preprocess("a.fs", "#define SKINNING 1\n", out));
+    CHECK(Contains(out.source, "// header\n#version 330 core\n#define MAX_LIGHTS 8\n#define SKINNING 1\n#line 3 0\n"));
+    CHECK(!Contains(out.source, "MAX_LIGHTS 4"));
+
+    // Without #version the defines go first
+    CHECK(preprocessor.Preprocess("b.fs", "", out));
+    CHECK(out.source.compare(0, 32, "#define MAX_LIGHTS 8\n#line 1 0\nv") == 0);
+
+    // A #version that is only mentioned in a comment doesn't count
+    preprocessor.UpdateFile("c.fs", "// needs #version 330\n/*\n#version 330\n*/\nvoid main() {}\n");
+    CHECK(preprocessor.Preprocess("c.fs", "", out));
+    CHECK(out.source.compare(0, 32, "#define MAX_LIGHTS 8\n#line 1 0\n/") == 0);
+    CHECK(Contains(out.source, "/*\n#version 330\n*/\n"));
+}
+
+static void TestComments() {
+    ShaderPreprocessor preprocessor;
+    preprocessor.UpdateFile("a.vs",
+        "#version 330\n"
+        "/* Usage:\n"
+        "#include \"missing.glsl\"\n"
+        "*/\n"
+        "// #include \"missing.glsl\"\n"
+        "/* one line */ float x;\n"
+        "#include \"b.glsl\" // after a closed comment\n"
+        "void main() {}\n");
+    preprocessor.UpdateFile("b.glsl", "float b;\n");
+
+    PreprocessedShader out;
+    CHECK(preprocessor.Preprocess("a.vs", "", out));
+    CHECK(out.dependencies.size() == 2);
+    CHECK(Contains(out.source, "#include \"missing.glsl\"\n*/\n"));
+    CHECK(Contains(out.source, "float b;\n"));
+}
+
+static void TestErrors() {
+    ShaderPreprocessor preprocessor;
+    PreprocessedShader out;
+
+    preprocessor.UpdateFile("missing.vs", "#version 330\n#include \"nowhere.glsl\"\n");
+    CHECK(!preprocessor.Preprocess("missing.vs", "", out));
+    CHECK(!preprocessor.Preprocess("no/such/file.vs", "", out));
+
+    preprocessor.UpdateFile("cycle.vs", "#include \"cycle_a.glsl\"\n");
+    preprocessor.UpdateFile("cycle_a.glsl", "#include \"cycle_b.glsl\"\n");
+    preprocessor.UpdateFile("cycle_b.glsl", "#include \"cycle_a.glsl\"\n");
+    CHECK(!preprocessor.Preprocess("cycle.vs", "", out));
+
+    preprocessor.UpdateFile("version.vs", "#version 330\n#include \"version.glsl\"\n");
+    preprocessor.UpdateFile("version.glsl", "#version 330\n");
+    CHECK(!preprocessor.Preprocess("version.vs", "", out));
+
+    preprocessor.UpdateFile("malformed.vs", "#include \"unterminated.glsl\n");
+    CHECK(!preprocessor.Preprocess("malformed.vs", "", out));
+
+    // UpdateFile replaces the cached contents
+    preprocessor.UpdateFile("nowhere.glsl", "float nowhere;\n");
+    CHECK(preprocessor.Preprocess("missing.vs", "", out));
+    CHECK(Contains(out.source, "float nowhere;"));
+}
+
+int main() {
+    TestNormalizePath();
+    TestIncludes();
+    TestDefines();
+    TestComments();
+    TestErrors();
+    return FinishTests("ShaderPreprocessorTests");
+}
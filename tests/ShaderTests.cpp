@@ -0,0 +1,135 @@
+// Shader's uniform table against the stub GL: array suffixes, lookups by
+// StringId and by name, the redundant upload filter and the uniform block
+// bindings from ShaderReflection.h.
+
+#include <cstring>
+#include <string>
+#include "Test.h"
+#include "StubGL.h"
+#include "Shader.h"
+#include "ShaderReflection.h"
+#include "UniformBuffer.h"
+
+static void SetStubUniforms() {
+    GetStubGL().uniforms = {
+        { "color", 0, GL_FLOAT_VEC4, 1 },
+        { "bones[0]", 1, GL_FLOAT_MAT4, 4 },
+        { "lights[0].color", 5, GL_FLOAT_VEC3, 1 },
+        { "lights[1].color", 6, GL_FLOAT_VEC3, 1 },
+        { "PerFrame.viewProjection", -1, GL_FLOAT_MAT4, 1 },
+    };
+}
+
+static void TestUniformTable() {
+    InstallStubGL();
+    SetStubUniforms();
+    Shader shader("vertex", "fragment");
+    CHECK(shader.Finalize());
+
+    // Block members have no location and are left out
+    CHECK(shader.GetUniforms().size() == 4);
+
+    // Only a trailing [0] is dropped
+    CHECK(shader.GetUniform("bones") != INVALID_UNIFORM);
+    CHECK(shader.GetUniform("bones[0]") == INVALID_UNIFORM);
+    CHECK(shader.GetUniform("lights[0].color") != INVALID_UNIFORM);
+    CHECK(shader.GetUniform("lights") == INVALID_UNIFORM);
+    CHECK(shader.GetUniform("lights[1].color") != INVALID_UNIFORM);
+    CHECK(shader.GetUniform("lights[0].color") != shader.GetUniform("lights[1].color"));
+
+    UniformHandle bones = shader.GetUniform("bones");
+    CHECK(shader.GetUniforms()[bones].size == 4);
+    CHECK(shader.GetUniforms()[bones].shadowSize == 4 * 64);
+    CHECK(shader.GetUniform(InternString("bones")) == bones);
+    CHECK(shader.GetUniform("missing") == INVALID_UNIFORM);
+}
+
+static void TestNameLookup() {
+    InstallStubGL();
+    SetStubUniforms();
+    Shader shader("vertex", "fragment");
+
+    UniformHandle color = shader.GetUniform("color");
+    CHECK(color != INVALID_UNIFORM);
+    uint32 queries = GetStubGL().uniformLocationQueries;
+    CHECK(shader.GetUniform("color") == color);
+    CHECK(GetStubGL().uniformLocationQueries == queries);
+
+    // One buffer holding different names in turn must not return a stale
+    // handle for its address
+    char name[32];
+    strcpy(name, "color");
+    CHECK(shader.GetUniform(name) == color);
+    strcpy(name, "bones");
+    CHECK(shader.GetUniform(name) == shader.GetUniform(InternString("bones")));
+    strcpy(name, "missing");
+    CHECK(shader.GetUniform(name) == INVALID_UNIFORM);
+    strcpy(name, "color");
+    CHECK(shader.GetUniform(name) == color);
+}
+
+static void TestRedundantUploads() {
+    InstallStubGL();
+    SetStubUniforms();
+    Shader shader("vertex", "fragment");
+    UniformHandle color = shader.GetUniform("color");
+
+    shader.SetVector4f(color, Vector4f(1.0f, 0.0f, 0.0f, 1.0f));
+    shader.SetVector4f(color, Vector4f(1.0f, 0.0f, 0.0f, 1.0f));
+    CHECK(GetStubGL().uniformUploads == 1);
+    shader.SetVector4f("color", Vector4f(0.0f, 1.0f, 0.0f, 1.0f));
+    CHECK(GetStubGL().uniformUploads == 2);
+
+    // Uploads to missing uniforms are dropped
+    shader.SetFloat("missing", 1.0f);
+    shader.SetFloat(INVALID_UNIFORM, 1.0f);
+    CHECK(GetStubGL().uniformUploads == 2);
+}
+
+static void TestSwap() {
+    InstallStubGL();
+    SetStubUniforms();
+    Shader shader("vertex", "fragment");
+    UniformHandle bones = shader.GetUniform("bones");
+
+    GetStubGL().uniforms = { { "bones[0]", 0, GL_FLOAT_MAT4, 2 }, { "tint", 2, GL_FLOAT_VEC3, 1 } };
+    Shader rebuilt("vertex", "fragment");
+    rebuilt.Finalize();
+
+    uint32 version = shader.GetVersion();
+    shader.Swap(rebuilt);
+    CHECK(shader.GetVersion() != version);
+    CHECK(shader.GetUniform("tint") != INVALID_UNIFORM);
+    CHECK(shader.GetUniform("color") == INVALID_UNIFORM);
+    CHECK(shader.GetUniform("bones") != bones);
+    CHECK(shader.GetUniforms()[shader.GetUniform("bones")].size == 2);
+    CHECK(rebuilt.GetUniform("color") != INVALID_UNIFORM);
+}
+
+static void TestUniformBlockBindings() {
+    InstallStubGL();
+    GetStubGL().uniformBlocks = { "PerObject", "PerFrame" };
+    Shader shader("vertex", "fragment");
+    CHECK(shader.Finalize());
+
+    CHECK(GetStubGL().uniformBlockBindings.size() == 2);
+    CHECK(GetStubGL().uniformBlockBindings["PerFrame"] == ShaderReflection::PerFrame::BINDING);
+    CHECK(GetStubGL().uniformBlockBindings["PerObject"] == ShaderReflection::PerObject::BINDING);
+    CHECK(ShaderReflection::PerObject::BINDING == PER_OBJECT_BLOCK_BINDING);
+
+    // Blocks a program doesn't use are skipped
+    InstallStubGL();
+    GetStubGL().uniformBlocks = { "PerObject" };
+    Shader vertexOnly("vertex", "fragment");
+    CHECK(vertexOnly.Finalize());
+    CHECK(GetStubGL().uniformBlockBindings.size() == 1);
+}
+
+int main() {
+    TestUniformTable();
+    TestNameLookup();
+    TestRedundantUploads();
+    TestSwap();
+    TestUniformBlockBindings();
+    return FinishTests("ShaderTests");
+}
@@ -0,0 +1,83 @@
+// ShaderVariantCache against the stub GL, with in-memory sources: feature
+// defines, variant keys and sharing of variants.
+
+#include <string>
+#include "Test.h"
+#include "StubGL.h"
+#include "Shader.h"
+#include "ShaderCompileQueue.h"
+#include "ShaderPreprocessor.h"
+#include "ShaderVariantCache.h"
+
+static void TestFeatureDefines() {
+    CHECK(ShaderVariantCache::GetFeatureDefines(0).empty());
+    CHECK(ShaderVariantCache::GetFeatureDefines(SHADER_FEATURE_NORMAL_MAP) == "#define NORMAL_MAP 1\n");
+    CHECK(ShaderVariantCache::GetFeatureDefines(SHADER_FEATURE_SKINNING | SHADER_FEATURE_INSTANCING) ==
+          "#define SKINNING 1\n#define INSTANCING 1\n");
+    // Bits past the known features are ignored
+    CHECK(ShaderVariantCache::GetFeatureDefines(1u << SHADER_FEATURE_COUNT).empty());
+
+    CHECK(std::string(ShaderVariantCache::GetFeatureName(0)) == "SKINNING");
+    CHECK(ShaderVariantCache::GetFeatureName(SHADER_FEATURE_COUNT) == nullptr);
+}
+
+static void TestVariantKey() {
+    uint64 key = ShaderVariantCache::GetVariantKey("shaders/a.vs", "shaders/a.fs", SHADER_FEATURE_SKINNING);
+    CHECK(ShaderVariantCache::GetVariantKey("./shaders/a.vs", "shaders/../shaders/a.fs", SHADER_FEATURE_SKINNING) == key);
+    CHECK(ShaderVariantCache::GetVariantKey("shaders/a.vs", "shaders/a.fs", 0) != key);
+    CHECK(ShaderVariantCache::GetVariantKey("shaders/a.vs", "shaders/a.fs", SHADER_FEATURE_NORMAL_MAP) != key);
+    CHECK(ShaderVariantCache::GetVariantKey("shaders/a.fs", "shaders/a.vs", SHADER_FEATURE_SKINNING) != key);
+}
+
+// Whether any shader source handed to the stub contains text
+static bool StubSourceContains(const std::string& text) {
+    for(const auto& entry : GetStubGL().shaderSources) {
+        if(entry.second.find(text) != std::string::npos) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void TestGetVariant() {
+    InstallStubGL(3, 3, { "GL_KHR_parallel_shader_compile" });
+    GetStubGL().compilesPending = true;
+
+    ShaderPreprocessor preprocessor;
+    preprocessor.UpdateFile("shaders/a.vs", "#version 330\nvoid main() {}\n");
+    preprocessor.UpdateFile("shaders/a.fs", "#version 330\n#ifdef NORMAL_MAP\n#endif\nvoid main() {}\n");
+
+    ShaderCompileQueue queue;
+    {
+        ShaderVariantCache cache(&preprocessor, nullptr, &queue);
+        Shader *plain = cache.GetVariant("shaders/a.vs", "shaders/a.fs", 0);
+        Shader *normalMapped = cache.GetVariant("shaders/a.vs", "shaders/a.fs", SHADER_FEATURE_NORMAL_MAP);
+        CHECK(plain != normalMapped);
+        CHECK(cache.GetVariantCount() == 2);
+        CHECK(GetStubGL().linkedPrograms == 2);
+
+        // Handed to the queue instead of being finished on the spot
+        CHECK(queue.GetPendingCount() == 2);
+        CHECK(plain->GetState() == SHADER_COMPILING);
+
+        // The define goes right after #version, in both stages
+        CHECK(StubSourceContains("#version 330\n#define NORMAL_MAP 1\n#line 2 0\n#ifdef NORMAL_MAP"));
+        CHECK(StubSourceContains("#version 330\n#define NORMAL_MAP 1\n#line 2 0\nvoid main"));
+
+        // Same files, however they are spelled, and features share the variant
+        CHECK(cache.GetVariant("./shaders/a.vs", "shaders/./a.fs", SHADER_FEATURE_NORMAL_MAP) == normalMapped);
+        CHECK(cache.GetVariantCount() == 2);
+        CHECK(GetStubGL().linkedPrograms == 2);
+
+        GetStubGL().compilesPending = false;
+        CHECK(queue.Poll() == 0);
+        CHECK(normalMapped->GetState() == SHADER_READY);
+    }
+}
+
+int main() {
+    TestFeatureDefines();
+    TestVariantKey();
+    TestGetVariant();
+    return FinishTests("ShaderVariantCacheTests");
+}
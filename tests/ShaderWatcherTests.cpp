@@ -0,0 +1,128 @@
+// ShaderWatcher hot reload on real files in a temporary directory, with
+// programs from the stub GL. The same directory is named three ways
+// ("shaders/", "./shaders/" and an absolute path), which share one inotify
+// watch.
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Test.h"
+#include "StubGL.h"
+#include "Shader.h"
+#include "ShaderPreprocessor.h"
+#include "ShaderWatcher.h"
+
+static void WriteFile(const std::string& path, const std::string& contents) {
+    FILE *file = fopen(path.c_str(), "w");
+    CHECK(file != nullptr);
+    if(file) {
+        fputs(contents.c_str(), file);
+        fclose(file);
+    }
+}
+
+// Runs Update until count programs were swapped in or a few seconds passed
+static uint32 UpdateUntilSwapped(ShaderWatcher& watcher, uint32 count) {
+    uint32 swapped = 0;
+    for(int i=0; i<300 && swapped < count; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        swapped += watcher.Update();
+    }
+    // Anything beyond count would show up right after
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    return swapped + watcher.Update();
+}
+
+static Shader *BuildShader(ShaderPreprocessor& preprocessor, const std::string& vertexPath, const std::string& fragmentPath) {
+    PreprocessedShader vertex, fragment;
+    CHECK(preprocessor.Preprocess(vertexPath, "", vertex));
+    CHECK(preprocessor.Preprocess(fragmentPath, "", fragment));
+    Shader *shader = new Shader(vertex.source.c_str(), fragment.source.c_str());
+    CHECK(shader->Finalize());
+    return shader;
+}
+
+static void TestReload(const std::string& root) {
+    InstallStubGL();
+    WriteFile("shaders/common.glsl", "#pragma once\nfloat common() { return 1.0; }\n");
+    WriteFile("shaders/a.vs", "#version 330\n#include \"common.glsl\"\nvoid main() {}\n");
+    WriteFile("shaders/a.fs", "#version 330\nvoid main() {}\n");
+    WriteFile("shaders/b.vs", "#version 330\n#include \"common.glsl\"\nvoid main() {}\n");
+    WriteFile("shaders/b.fs", "#version 330\nvoid main() {}\n");
+
+    ShaderPreprocessor preprocessor;
+    ShaderWatcher watcher(&preprocessor);
+    if(!watcher.IsSupported()) {
+        printf("inotify not available, skipping the reload checks\n");
+        return;
+    }
+
+    Shader *a = BuildShader(preprocessor, "shaders/a.vs", "shaders/a.fs");
+    Shader *b = BuildShader(preprocessor, root + "/shaders/b.vs", "./shaders/b.fs");
+    watcher.Watch(a, "shaders/a.vs", "shaders/a.fs");
+    watcher.Watch(b, root + "/shaders/b.vs", "./shaders/b.fs");
+    uint32 versionA = a->GetVersion(), versionB = b->GetVersion();
+
+    // Each spelling of the directory still maps events to its own program
+    WriteFile("shaders/a.vs", "#version 330\n#include \"common.glsl\"\nvoid main() { common(); }\n");
+    CHECK(UpdateUntilSwapped(watcher, 1) == 1);
+    CHECK(a->GetVersion() != versionA);
+    CHECK(b->GetVersion() == versionB);
+    CHECK(watcher.reloads == 1);
+
+    versionA = a->GetVersion();
+    WriteFile("shaders/b.fs", "#version 330\nout vec4 color;\nvoid main() {}\n");
+    CHECK(UpdateUntilSwapped(watcher, 1) == 1);
+    CHECK(a->GetVersion() == versionA);
+    CHECK(b->GetVersion() != versionB);
+
+    // A shared include, reached through two spellings, reloads both
+    versionA = a->GetVersion();
+    versionB = b->GetVersion();
+    WriteFile("shaders/common.glsl", "#pragma once\nfloat common() { return 2.0; }\n");
+    CHECK(UpdateUntilSwapped(watcher, 2) == 2);
+    CHECK(a->GetVersion() != versionA);
+    CHECK(b->GetVersion() != versionB);
+    CHECK(watcher.reloads == 4);
+    CHECK(watcher.failedReloads == 0);
+
+    // A broken edit keeps the previous program
+    versionA = a->GetVersion();
+    WriteFile("shaders/a.fs", "#version 330\n#error broken\n");
+    UpdateUntilSwapped(watcher, 1);
+    CHECK(a->GetVersion() == versionA);
+    CHECK(a->GetState() == SHADER_READY);
+    CHECK(watcher.reloads == 5);
+    CHECK(watcher.failedReloads == 1);
+
+    // Files nobody uses any more are ignored
+    watcher.Unwatch(a);
+    WriteFile("shaders/a.vs", "#version 330\nvoid main() {}\n");
+    CHECK(UpdateUntilSwapped(watcher, 0) == 0);
+    CHECK(a->GetVersion() == versionA);
+    CHECK(watcher.reloads == 5);
+
+    watcher.Unwatch(b);
+    delete a;
+    delete b;
+}
+
+int main() {
+    char root[] = "/tmp/ShaderWatcherTests.XXXXXX";
+    if(!mkdtemp(root) || chdir(root) != 0 || mkdir("shaders", 0755) != 0) {
+        perror(root);
+        return 1;
+    }
+
+    TestReload(root);
+
+    for(const char *file : { "common.glsl", "a.vs", "a.fs", "b.vs", "b.fs" }) {
+        remove((std::string("shaders/") + file).c_str());
+    }
+    rmdir("shaders");
+    rmdir(root);
+    return FinishTests("ShaderWatcherTests");
+}
@@ -0,0 +1,62 @@
+// InternString / GetInternedString, including interning from several
+// threads at once.
+
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Test.h"
+#include "StringId.h"
+
+static void TestIntern() {
+    StringId a = InternString("lightColor");
+    StringId b = InternString("lightPosition");
+    CHECK(a != b);
+
+    // Equal text maps to the same id, wherever the text lives
+    std::string copy = "lightColor";
+    CHECK(InternString(copy.c_str()) == a);
+    CHECK(strcmp(GetInternedString(a), "lightColor") == 0);
+    CHECK(strcmp(GetInternedString(b), "lightPosition") == 0);
+
+    // The returned text stays put while the table grows
+    const char *text = GetInternedString(a);
+    for(int i=0; i<1000; ++i) {
+        InternString(("grow" + std::to_string(i)).c_str());
+    }
+    CHECK(GetInternedString(a) == text);
+
+    CHECK(GetInternedString(1000000) == nullptr);
+    CHECK(strcmp(GetInternedString(InternString("")), "") == 0);
+}
+
+static void TestThreads() {
+    const int THREAD_COUNT = 4;
+    const int NAME_COUNT = 500;
+
+    std::vector<std::vector<StringId>> ids(THREAD_COUNT, std::vector<StringId>(NAME_COUNT));
+    std::vector<std::thread> threads;
+    for(int t=0; t<THREAD_COUNT; ++t) {
+        threads.emplace_back([&ids, t] {
+            for(int i=0; i<NAME_COUNT; ++i) {
+                ids[t][i] = InternString(("thread" + std::to_string(i)).c_str());
+            }
+        });
+    }
+    for(std::thread& thread : threads) {
+        thread.join();
+    }
+
+    for(int i=0; i<NAME_COUNT; ++i) {
+        for(int t=1; t<THREAD_COUNT; ++t) {
+            CHECK(ids[t][i] == ids[0][i]);
+        }
+        CHECK(GetInternedString(ids[0][i]) == "thread" + std::to_string(i));
+    }
+}
+
+int main() {
+    TestIntern();
+    TestThreads();
+    return FinishTests("StringIdTests");
+}
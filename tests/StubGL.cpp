@@ -0,0 +1,444 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "StubGL.h"
+
+static StubGL stub;
+static char versionString[32];
+
+StubGL& GetStubGL() {
+    return stub;
+}
+
+static const GLubyte *APIENTRY StubGetString(GLenum name) {
+    return (const GLubyte *)(name == GL_VERSION ? versionString : name == GL_RENDERER ? stub.renderer.c_str() : "Stub");
+}
+
+static const GLubyte *APIENTRY StubGetStringi(GLenum name, GLuint index) {
+    if(name != GL_EXTENSIONS || index >= stub.extensions.size()) {
+        return nullptr;
+    }
+    return (const GLubyte *)stub.extensions[index].c_str();
+}
+
+static void APIENTRY StubGetIntegerv(GLenum name, GLint *value) {
+    switch(name) {
+        case GL_MAJOR_VERSION: *value = stub.majorVersion; break;
+        case GL_MINOR_VERSION: *value = stub.minorVersion; break;
+        case GL_NUM_EXTENSIONS: *value = (GLint)stub.extensions.size(); break;
+        case GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT: *value = 256; break;
+        case GL_NUM_PROGRAM_BINARY_FORMATS: *value = 1; break;
+        default: *value = 0; break;
+    }
+}
+
+static GLuint APIENTRY StubCreateObject() {
+    return stub.nextName++;
+}
+
+static GLuint APIENTRY StubCreateShader(GLenum) {
+    return stub.nextName++;
+}
+
+static void APIENTRY StubShaderSource(GLuint shader, GLsizei count, const GLchar *const *sources, const GLint *lengths) {
+    std::string& source = stub.shaderSources[shader];
+    source.clear();
+    for(GLsizei i=0; i<count; ++i) {
+        source.append(sources[i], lengths && lengths[i] >= 0 ? (size_t)lengths[i] : strlen(sources[i]));
+    }
+}
+
+static void APIENTRY StubCompileShader(GLuint) {}
+static void APIENTRY StubDeleteObject(GLuint) {}
+static void APIENTRY StubAttachShader(GLuint, GLuint) {}
+static void APIENTRY StubProgramParameteri(GLuint, GLenum, GLint) {}
+
+static void APIENTRY StubGetShaderiv(GLuint shader, GLenum name, GLint *value) {
+    bool fails = stub.compileFails || stub.shaderSources[shader].find("#error") != std::string::npos;
+    *value = name == GL_COMPILE_STATUS ? !fails : 0;
+}
+
+static void APIENTRY StubGetInfoLog(GLuint, GLsizei size, GLsizei *length, GLchar *log) {
+    snprintf(log, size, "stub compile error");
+    if(length) {
+        *length = (GLsizei)strlen(log);
+    }
+}
+
+static void APIENTRY StubLinkProgram(GLuint program) {
+    stub.linkedPrograms++;
+    stub.linkStatus.erase(program);
+}
+
+// What glGetProgramBinary hands out, whatever the program
+static const char STUB_PROGRAM_BINARY[] = "stub program binary";
+
+static void APIENTRY StubGetProgramBinary(GLuint, GLsizei bufSize, GLsizei *length, GLenum *format, void *binary) {
+    GLsizei size = std::min(bufSize, (GLsizei)sizeof(STUB_PROGRAM_BINARY));
+    memcpy(binary, STUB_PROGRAM_BINARY, size);
+    if(length) {
+        *length = size;
+    }
+    *format = stub.binaryFormat;
+}
+
+static void APIENTRY StubProgramBinary(GLuint program, GLenum format, const void *binary, GLsizei length) {
+    bool accepted = format == stub.binaryFormat && length == (GLsizei)sizeof(STUB_PROGRAM_BINARY) &&
+                    memcmp(binary, STUB_PROGRAM_BINARY, length) == 0;
+    stub.linkStatus[program] = accepted;
+    stub.binaryLoads += accepted;
+}
+
+static void APIENTRY StubGetProgramiv(GLuint program, GLenum name, GLint *value) {
+    switch(name) {
+        case GL_LINK_STATUS:
+            *value = stub.linkStatus.count(program) ? stub.linkStatus[program] : 1;
+            break;
+        case GL_VALIDATE_STATUS:
+            *value = 1;
+            break;
+        case GL_PROGRAM_BINARY_LENGTH:
+            *value = (GLint)sizeof(STUB_PROGRAM_BINARY);
+            break;
+        case GL_COMPLETION_STATUS_KHR:
+            *value = !stub.compilesPending;
+            break;
+        case GL_ACTIVE_UNIFORMS:
+            *value = (GLint)stub.uniforms.size();
+            break;
+        case GL_ACTIVE_UNIFORM_MAX_LENGTH:
+            *value = 1;
+            for(const StubUniform& uniform : stub.uniforms) {
+                *value = std::max(*value, (GLint)uniform.name.size() + 1);
+            }
+            break;
+        default:
+            *value = 0;
+            break;
+    }
+}
+
+static void APIENTRY StubMaxShaderCompilerThreads(GLuint count) {
+    stub.maxCompilerThreads = count;
+}
+
+static void APIENTRY StubUseProgram(GLuint program) {
+    stub.usedProgram = program;
+}
+
+static void APIENTRY StubGetActiveUniform(GLuint, GLuint index, GLsizei bufSize, GLsizei *length, GLint *size,
+                                          GLenum *type, GLchar *name) {
+    const StubUniform& uniform = stub.uniforms[index];
+    *length = (GLsizei)snprintf(name, bufSize, "%s", uniform.name.c_str());
+    *size = uniform.size;
+    *type = uniform.type;
+}
+
+static GLint APIENTRY StubGetUniformLocation(GLuint, const GLchar *name) {
+    stub.uniformLocationQueries++;
+    for(const StubUniform& uniform : stub.uniforms) {
+        if(uniform.name == name) {
+            return uniform.location;
+        }
+    }
+    return -1;
+}
+
+static GLuint APIENTRY StubGetUniformBlockIndex(GLuint, const GLchar *name) {
+    for(size_t i = 0; i < stub.uniformBlocks.size(); i++) {
+        if(stub.uniformBlocks[i] == name) {
+            return (GLuint)i;
+        }
+    }
+    return GL_INVALID_INDEX;
+}
+
+static void APIENTRY StubUniformBlockBinding(GLuint, GLuint index, GLuint binding) {
+    stub.uniformBlockBindings[stub.uniformBlocks[index]] = binding;
+}
+
+static void APIENTRY StubGenBuffers(GLsizei count, GLuint *names) {
+    for(GLsizei i=0; i<count; ++i) {
+        names[i] = stub.nextName++;
+        stub.buffers[names[i]];
+    }
+}
+
+static void APIENTRY StubDeleteBuffers(GLsizei count, const GLuint *names) {
+    for(GLsizei i=0; i<count; ++i) {
+        stub.buffers.erase(names[i]);
+    }
+}
+
+static void APIENTRY StubBindBuffer(GLenum target, GLuint buffer) {
+    stub.boundBuffers[target] = buffer;
+}
+
+static void APIENTRY StubBufferData(GLenum target, GLsizeiptr size, const void *, GLenum) {
+    stub.buffers[stub.boundBuffers[target]].assign((size_t)size, 0);
+}
+
+static void APIENTRY StubBufferStorage(GLenum target, GLsizeiptr size, const void *, GLbitfield) {
+    stub.buffers[stub.boundBuffers[target]].assign((size_t)size, 0);
+}
+
+static void *APIENTRY StubMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr size, GLbitfield) {
+    std::vector<uint8>& storage = stub.buffers[stub.boundBuffers[target]];
+    stub.maps++;
+    if(offset < 0 || (size_t)(offset + size) > storage.size()) {
+        return nullptr;
+    }
+    return storage.data() + offset;
+}
+
+static GLboolean APIENTRY StubUnmapBuffer(GLenum) {
+    return GL_TRUE;
+}
+
+static void APIENTRY StubBindBufferRange(GLenum, GLuint, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+    stub.lastRangeBuffer = buffer;
+    stub.lastRangeOffset = (uint32)offset;
+    stub.lastRangeSize = (uint32)size;
+}
+
+// Fences only need to be distinct non-null handles
+static GLsync APIENTRY StubFenceSync(GLenum, GLbitfield) {
+    stub.fences++;
+    stub.liveFences++;
+    return (GLsync)(size_t)stub.fences;
+}
+
+static GLenum APIENTRY StubClientWaitSync(GLsync, GLbitfield, GLuint64) {
+    stub.fenceWaits++;
+    return GL_ALREADY_SIGNALED;
+}
+
+static void APIENTRY StubDeleteSync(GLsync) {
+    stub.liveFences--;
+}
+
+static void APIENTRY StubGenProgramPipelines(GLsizei count, GLuint *names) {
+    for(GLsizei i=0; i<count; ++i) {
+        names[i] = stub.nextName++;
+        stub.pipelineStages[names[i]];
+    }
+}
+
+static void APIENTRY StubDeleteProgramPipelines(GLsizei count, const GLuint *names) {
+    for(GLsizei i=0; i<count; ++i) {
+        stub.pipelineStages.erase(names[i]);
+    }
+}
+
+static void APIENTRY StubUseProgramStages(GLuint pipeline, GLbitfield stages, GLuint program) {
+    for(GLbitfield bit : { GL_VERTEX_SHADER_BIT, GL_FRAGMENT_SHADER_BIT }) {
+        if(stages & bit) {
+            stub.pipelineStages[pipeline][bit] = program;
+        }
+    }
+}
+
+static void APIENTRY StubActiveShaderProgram(GLuint, GLuint program) {
+    stub.activeProgram = program;
+}
+
+static void APIENTRY StubBindProgramPipeline(GLuint pipeline) {
+    stub.boundPipeline = pipeline;
+}
+
+static void APIENTRY StubGetProgramPipelineiv(GLuint, GLenum, GLint *value) {
+    *value = 1;
+}
+
+static void APIENTRY StubGenTextures(GLsizei count, GLuint *names) {
+    for(GLsizei i=0; i<count; ++i) {
+        names[i] = stub.nextName++;
+        stub.textures[names[i]];
+    }
+}
+
+static void APIENTRY StubDeleteTextures(GLsizei count, const GLuint *names) {
+    for(GLsizei i=0; i<count; ++i) {
+        stub.textures.erase(names[i]);
+        stub.textureParameters.erase(names[i]);
+    }
+}
+
+static void APIENTRY StubBindTexture(GLenum, GLuint texture) {
+    stub.boundTexture = texture;
+}
+
+static void APIENTRY StubTexParameteri(GLenum, GLenum name, GLint value) {
+    stub.textureParameters[stub.boundTexture][name] = value;
+}
+
+static void APIENTRY StubPixelStorei(GLenum name, GLint value) {
+    if(name == GL_UNPACK_ALIGNMENT) {
+        stub.unpackAlignment = value;
+    }
+}
+
+static StubTextureLevel& GetBoundLevel(GLint level) {
+    std::vector<StubTextureLevel>& levels = stub.textures[stub.boundTexture];
+    if(levels.size() <= (size_t)level) {
+        levels.resize((size_t)level + 1);
+    }
+    return levels[level];
+}
+
+// Copies rows of width pixels from data, whose rows are padded to the
+// unpack alignment, into pixels starting at row y
+static void UnpackRows(StubTextureLevel& level, GLint y, GLsizei width, GLsizei height, GLenum format, const void *data) {
+    size_t pixelSize = format == GL_RGB ? 3 : 4;
+    size_t rowSize = (size_t)width * pixelSize;
+    size_t alignment = (size_t)stub.unpackAlignment;
+    size_t stride = (rowSize + alignment - 1) / alignment * alignment;
+    for(GLsizei row = 0; row < height; row++) {
+        memcpy(level.pixels.data() + ((size_t)(y + row) * level.width) * pixelSize,
+               (const uint8 *)data + row * stride, rowSize);
+    }
+}
+
+// With an unpack buffer bound, data is an offset into it
+static const void *GetUnpackSource(const void *data) {
+    uint32 unpackBuffer = stub.boundBuffers[GL_PIXEL_UNPACK_BUFFER];
+    return unpackBuffer ? stub.buffers[unpackBuffer].data() + (size_t)data : data;
+}
+
+static void APIENTRY StubTexImage2D(GLenum, GLint level, GLint internalFormat, GLsizei width, GLsizei height, GLint,
+                                    GLenum format, GLenum, const void *data) {
+    StubTextureLevel& target = GetBoundLevel(level);
+    target.width = width;
+    target.height = height;
+    target.internalFormat = (uint32)internalFormat;
+    target.pixels.assign((size_t)width * height * (format == GL_RGB ? 3 : 4), 0);
+    if(data || stub.boundBuffers[GL_PIXEL_UNPACK_BUFFER]) {
+        UnpackRows(target, 0, width, height, format, GetUnpackSource(data));
+    }
+}
+
+static void APIENTRY StubTexSubImage2D(GLenum, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+                                       GLenum format, GLenum, const void *data) {
+    // Only whole rows, as PixelUploadRing sends them
+    StubTextureLevel& target = GetBoundLevel(level);
+    if(x == 0 && width == target.width && y + height <= target.height) {
+        UnpackRows(target, y, width, height, format, GetUnpackSource(data));
+    }
+}
+
+static void APIENTRY StubCompressedTexImage2D(GLenum, GLint level, GLenum internalFormat, GLsizei width, GLsizei height,
+                                              GLint, GLsizei size, const void *data) {
+    StubTextureLevel& target = GetBoundLevel(level);
+    target.width = width;
+    target.height = height;
+    target.internalFormat = internalFormat;
+    target.pixels.assign((const uint8 *)data, (const uint8 *)data + size);
+}
+
+static void APIENTRY StubUniform1i(GLint, GLint) { stub.uniformUploads++; }
+static void APIENTRY StubUniform1f(GLint, GLfloat) { stub.uniformUploads++; }
+static void APIENTRY StubUniformiv(GLint, GLsizei, const GLint *) { stub.uniformUploads++; }
+static void APIENTRY StubUniformfv(GLint, GLsizei, const GLfloat *) { stub.uniformUploads++; }
+static void APIENTRY StubUniformMatrixfv(GLint, GLsizei, GLboolean, const GLfloat *) { stub.uniformUploads++; }
+
+struct StubProc {
+    const char *name;
+    void *proc;
+};
+
+static const StubProc stubProcs[] = {
+    { "glGetString", (void *)StubGetString },
+    { "glGetStringi", (void *)StubGetStringi },
+    { "glGetIntegerv", (void *)StubGetIntegerv },
+    { "glCreateShader", (void *)StubCreateShader },
+    { "glShaderSource", (void *)StubShaderSource },
+    { "glCompileShader", (void *)StubCompileShader },
+    { "glGetShaderiv", (void *)StubGetShaderiv },
+    { "glGetShaderInfoLog", (void *)StubGetInfoLog },
+    { "glDeleteShader", (void *)StubDeleteObject },
+    { "glCreateProgram", (void *)StubCreateObject },
+    { "glAttachShader", (void *)StubAttachShader },
+    { "glDetachShader", (void *)StubAttachShader },
+    { "glLinkProgram", (void *)StubLinkProgram },
+    { "glValidateProgram", (void *)StubDeleteObject },
+    { "glGetProgramiv", (void *)StubGetProgramiv },
+    { "glGetProgramInfoLog", (void *)StubGetInfoLog },
+    { "glDeleteProgram", (void *)StubDeleteObject },
+    { "glProgramParameteri", (void *)StubProgramParameteri },
+    { "glGetProgramBinary", (void *)StubGetProgramBinary },
+    { "glProgramBinary", (void *)StubProgramBinary },
+    { "glUseProgram", (void *)StubUseProgram },
+    { "glMaxShaderCompilerThreadsKHR", (void *)StubMaxShaderCompilerThreads },
+    { "glGetActiveUniform", (void *)StubGetActiveUniform },
+    { "glGetUniformLocation", (void *)StubGetUniformLocation },
+    { "glGetUniformBlockIndex", (void *)StubGetUniformBlockIndex },
+    { "glUniformBlockBinding", (void *)StubUniformBlockBinding },
+    { "glUniform1i", (void *)StubUniform1i },
+    { "glUniform1f", (void *)StubUniform1f },
+    { "glUniform1iv", (void *)StubUniformiv },
+    { "glUniform1fv", (void *)StubUniformfv },
+    { "glUniform2fv", (void *)StubUniformfv },
+    { "glUniform3fv", (void *)StubUniformfv },
+    { "glUniform4fv", (void *)StubUniformfv },
+    { "glUniformMatrix3fv", (void *)StubUniformMatrixfv },
+    { "glUniformMatrix4fv", (void *)StubUniformMatrixfv },
+    { "glGenBuffers", (void *)StubGenBuffers },
+    { "glDeleteBuffers", (void *)StubDeleteBuffers },
+    { "glBindBuffer", (void *)StubBindBuffer },
+    { "glBufferData", (void *)StubBufferData },
+    { "glBufferStorage", (void *)StubBufferStorage },
+    { "glMapBufferRange", (void *)StubMapBufferRange },
+    { "glUnmapBuffer", (void *)StubUnmapBuffer },
+    { "glBindBufferRange", (void *)StubBindBufferRange },
+    { "glGenProgramPipelines", (void *)StubGenProgramPipelines },
+    { "glDeleteProgramPipelines", (void *)StubDeleteProgramPipelines },
+    { "glUseProgramStages", (void *)StubUseProgramStages },
+    { "glActiveShaderProgram", (void *)StubActiveShaderProgram },
+    { "glBindProgramPipeline", (void *)StubBindProgramPipeline },
+    { "glValidateProgramPipeline", (void *)StubDeleteObject },
+    { "glGetProgramPipelineiv", (void *)StubGetProgramPipelineiv },
+    { "glGetProgramPipelineInfoLog", (void *)StubGetInfoLog },
+    { "glGenTextures", (void *)StubGenTextures },
+    { "glDeleteTextures", (void *)StubDeleteTextures },
+    { "glBindTexture", (void *)StubBindTexture },
+    { "glTexParameteri", (void *)StubTexParameteri },
+    { "glPixelStorei", (void *)StubPixelStorei },
+    { "glTexImage2D", (void *)StubTexImage2D },
+    { "glCompressedTexImage2D", (void *)StubCompressedTexImage2D },
+    { "glTexSubImage2D", (void *)StubTexSubImage2D },
+    { "glFenceSync", (void *)StubFenceSync },
+    { "glClientWaitSync", (void *)StubClientWaitSync },
+    { "glDeleteSync", (void *)StubDeleteSync },
+};
+
+void *GetStubGLProc(const char *name) {
+    for(const StubProc& entry : stubProcs) {
+        if(strcmp(entry.name, name) == 0) {
+            return entry.proc;
+        }
+    }
+    return nullptr;
+}
+
+void InstallStubGL(int32 majorVersion, int32 minorVersion, const std::vector<std::string>& extensions) {
+    stub = StubGL();
+    stub.majorVersion = majorVersion;
+    stub.minorVersion = minorVersion;
+    stub.extensions = extensions;
+    stub.renderer = "Stub";
+    stub.binaryFormat = 1;
+    stub.nextName = 1;
+    stub.unpackAlignment = 4;
+    snprintf(versionString, sizeof(versionString), "%d.%d Stub", majorVersion, minorVersion);
+
+    // LoadGLExtensions only sets what it finds, clear what an earlier
+    // install found
+    GLEXT_ARB_clip_control = 0;
+    GLEXT_ARB_buffer_storage = 0;
+    GLEXT_ARB_get_program_binary = 0;
+    GLEXT_ARB_separate_shader_objects = 0;
+    glMaxShaderCompilerThreadsKHR = nullptr;
+
+    gladLoadGLLoader(GetStubGLProc);
+    LoadGLExtensions(GetStubGLProc);
+}
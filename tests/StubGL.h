@@ -0,0 +1,94 @@
+#ifndef INC_3DENGINE_STUBGL_H
+#define INC_3DENGINE_STUBGL_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "Types.h"
+#include "GLExtensions.h"
+
+// A fake GL context for tests of the engine's GL-facing classes. Its entry
+// points are handed out by GetStubGLProc and loaded the same way main does
+// (gladLoadGLLoader, then LoadGLExtensions). Objects are plain counters,
+// and the calls the tests look at are recorded in GetStubGL().
+
+struct StubUniform {
+    std::string name;   // as glGetActiveUniform reports it, "lights[0].color"
+    int32 location;     // -1 for uniform block members
+    uint32 type;
+    int32 size;
+};
+
+struct StubTextureLevel {
+    int32 width;
+    int32 height;
+    uint32 internalFormat;
+    std::vector<uint8> pixels;      // tightly packed, or the compressed blocks
+};
+
+struct StubGL {
+    int32 majorVersion;
+    int32 minorVersion;
+    std::vector<std::string> extensions;
+
+    // Reported by every program that is linked
+    std::vector<StubUniform> uniforms;
+    // Uniform block names, glGetUniformBlockIndex returns the position.
+    // glUniformBlockBinding records the binding by name.
+    std::vector<std::string> uniformBlocks;
+    std::map<std::string, uint32> uniformBlockBindings;
+    // Compiles fail when set, or for sources containing "#error"
+    bool compileFails;
+    std::map<uint32, std::string> shaderSources;
+    // GL_COMPLETION_STATUS_KHR reports 0 while set
+    bool compilesPending;
+    uint32 maxCompilerThreads;      // last glMaxShaderCompilerThreadsKHR
+
+    // Buffer contents by name, and the buffer bound to each target
+    std::map<uint32, std::vector<uint8>> buffers;
+    std::map<uint32, uint32> boundBuffers;
+    uint32 lastRangeBuffer;         // last glBindBufferRange
+    uint32 lastRangeOffset;
+    uint32 lastRangeSize;
+    uint32 maps;                    // glMapBufferRange calls
+    uint32 fences;                  // glFenceSync calls
+    uint32 fenceWaits;              // glClientWaitSync calls
+    int32 liveFences;               // created and not yet deleted
+
+    // GL_RENDERER, "Stub" after InstallStubGL. Program binaries are
+    // accepted back only in the binaryFormat they were retrieved in,
+    // glProgramBinary of anything else fails to link like a driver update.
+    std::string renderer;
+    uint32 binaryFormat;
+    std::map<uint32, int32> linkStatus;     // by program, 1 when absent
+    uint32 binaryLoads;             // accepted glProgramBinary calls
+
+    uint32 nextName;
+    uint32 uniformUploads;          // glUniform* calls
+    uint32 uniformLocationQueries;  // glGetUniformLocation calls
+    uint32 linkedPrograms;
+    uint32 usedProgram;
+
+    // The program attached to each stage bit, by pipeline
+    std::map<uint32, std::map<uint32, uint32>> pipelineStages;
+    uint32 boundPipeline;
+    uint32 activeProgram;           // last glActiveShaderProgram
+
+    // Levels and glTexParameteri values by texture name. Only
+    // GL_UNSIGNED_BYTE GL_RGB and GL_RGBA pixels are read, from the bound
+    // GL_PIXEL_UNPACK_BUFFER when there is one.
+    std::map<uint32, std::vector<StubTextureLevel>> textures;
+    std::map<uint32, std::map<uint32, int32>> textureParameters;
+    uint32 boundTexture;            // GL_TEXTURE_2D
+    int32 unpackAlignment;
+};
+
+StubGL& GetStubGL();
+void *GetStubGLProc(const char *name);
+// Resets the recorded state to a context of the given version and
+// extensions, then loads glad and GLExtensions from the stub
+void InstallStubGL(int32 majorVersion = 3, int32 minorVersion = 3,
+                   const std::vector<std::string>& extensions = std::vector<std::string>());
+
+
+#endif //INC_3DENGINE_STUBGL_H
@@ -0,0 +1,46 @@
+#ifndef INC_3DENGINE_TEST_H
+#define INC_3DENGINE_TEST_H
+
+#include <cmath>
+#include <cstdio>
+
+// Minimal checks for the test executables. A failed check is reported and
+// counted, and the test keeps going so one run shows every failure.
+// main returns FinishTests(), non-zero when anything failed, for ctest.
+
+inline int& GetTestFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition) \
+    do { \
+        if(!(condition)) { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            GetTestFailures()++; \
+        } \
+    } while(0)
+
+// |actual - expected| <= epsilon, relative to the magnitude above 1
+#define CHECK_NEAR(actual, expected, epsilon) \
+    do { \
+        double checkActual = (actual), checkExpected = (expected); \
+        double checkScale = fabs(checkExpected) > 1.0 ? fabs(checkExpected) : 1.0; \
+        if(!(fabs(checkActual - checkExpected) <= (epsilon) * checkScale)) { \
+            fprintf(stderr, "%s:%d: CHECK_NEAR(%s, %s) failed: %g vs %g\n", __FILE__, __LINE__, #actual, #expected, \
+                    checkActual, checkExpected); \
+            GetTestFailures()++; \
+        } \
+    } while(0)
+
+inline int FinishTests(const char *name) {
+    if(GetTestFailures()) {
+        fprintf(stderr, "%s: %d checks failed\n", name, GetTestFailures());
+        return 1;
+    }
+    printf("%s: all checks passed\n", name);
+    return 0;
+}
+
+
+#endif //INC_3DENGINE_TEST_H
@@ -0,0 +1,170 @@
+// CompressImage/DecompressImage round trips for every block format: a
+// gradient image held to minimum PSNRs, single-colour images held to a
+// maximum error, the sRGB variants and the BC7 modes the decoder rejects.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "Test.h"
+#include "TextureCompression.h"
+
+// Smooth colour and alpha gradients with a little deterministic noise, the
+// kind of content block compression is meant for
+static std::vector<uint8> MakeGradientImage(uint32 width, uint32 height) {
+    std::vector<uint8> rgba((size_t)width * height * 4);
+    uint32 seed = 12345;
+    for(uint32 y = 0; y < height; y++) {
+        for(uint32 x = 0; x < width; x++) {
+            seed = seed * 1664525u + 1013904223u;
+            int32 noise = (int32)(seed >> 29) - 4;
+            uint8 *texel = &rgba[((size_t)y * width + x) * 4];
+            float u = (float)x / (width - 1), v = (float)y / (height - 1);
+            float values[4] = { 255.0f * u, 255.0f * v, 128.0f + 100.0f * sinf(6.0f * u + 3.0f * v), 255.0f * (1.0f - u * v) };
+            for(uint32 c = 0; c < 4; c++) {
+                int32 value = (int32)(values[c] + 0.5f) + (c < 3 ? noise : 0);
+                texel[c] = (uint8)(value < 0 ? 0 : value > 255 ? 255 : value);
+            }
+        }
+    }
+    return rgba;
+}
+
+// Over the given channels, +inf for identical images
+static double GetPSNR(const std::vector<uint8>& a, const std::vector<uint8>& b, uint32 firstChannel, uint32 channels) {
+    double error = 0.0;
+    size_t count = 0;
+    for(size_t i = 0; i < a.size(); i += 4) {
+        for(uint32 c = firstChannel; c < firstChannel + channels; c++, count++) {
+            double d = (double)a[i + c] - b[i + c];
+            error += d * d;
+        }
+    }
+    return error == 0.0 ? INFINITY : 10.0 * log10(255.0 * 255.0 / (error / count));
+}
+
+struct FormatExpectation {
+    TextureContainerFormat format;
+    double minColorPSNR;    // on the gradient image
+    double minAlphaPSNR;    // 0 for formats without alpha, which decode to 255
+    int32 maxFlatError;     // per channel, on single-colour images
+};
+
+// A little below what the encoders reach today, so a regression shows
+static const FormatExpectation EXPECTATIONS[] = {
+    { TEXTURE_FORMAT_BC1,       29.5, 0.0,  4 },
+    { TEXTURE_FORMAT_BC3,       29.5, 45.0, 4 },
+    { TEXTURE_FORMAT_BC7,       31.0, 37.0, 1 },
+    { TEXTURE_FORMAT_ETC2_RGB8, 28.5, 0.0,  6 },
+};
+
+// Every texel's alpha is 255
+static bool IsOpaque(const std::vector<uint8>& rgba) {
+    for(size_t i = 3; i < rgba.size(); i += 4) {
+        if(rgba[i] != 255) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void TestRoundTrip() {
+    // Neither side a multiple of 4, the last blocks are partial
+    const uint32 width = 37, height = 23;
+    std::vector<uint8> image = MakeGradientImage(width, height);
+
+    for(const FormatExpectation& expected : EXPECTATIONS) {
+        std::vector<uint8> blocks = CompressImage(expected.format, image.data(), width, height);
+        CHECK(blocks.size() == GetTextureLevelSize(expected.format, width, height));
+
+        std::vector<uint8> decoded;
+        CHECK(DecompressImage(expected.format, blocks.data(), width, height, decoded));
+        CHECK(decoded.size() == image.size());
+
+        double colorPSNR = GetPSNR(image, decoded, 0, 3);
+        if(colorPSNR < expected.minColorPSNR) {
+            fprintf(stderr, "%s: %.2f dB colour\n", GetTextureFormatInfo(expected.format).name, colorPSNR);
+        }
+        CHECK(colorPSNR >= expected.minColorPSNR);
+        if(expected.minAlphaPSNR > 0.0) {
+            CHECK(GetPSNR(image, decoded, 3, 1) >= expected.minAlphaPSNR);
+        } else {
+            CHECK(IsOpaque(decoded));
+        }
+    }
+}
+
+static void TestSrgbFormats() {
+    // The sRGB formats only differ in how GL samples them
+    const uint32 width = 12, height = 8;
+    std::vector<uint8> image = MakeGradientImage(width, height);
+    const TextureContainerFormat pairs[][2] = {
+        { TEXTURE_FORMAT_BC1, TEXTURE_FORMAT_BC1_SRGB },
+        { TEXTURE_FORMAT_BC3, TEXTURE_FORMAT_BC3_SRGB },
+        { TEXTURE_FORMAT_BC7, TEXTURE_FORMAT_BC7_SRGB },
+        { TEXTURE_FORMAT_ETC2_RGB8, TEXTURE_FORMAT_ETC2_SRGB8 },
+    };
+    for(const auto& pair : pairs) {
+        std::vector<uint8> blocks = CompressImage(pair[0], image.data(), width, height);
+        CHECK(CompressImage(pair[1], image.data(), width, height) == blocks);
+
+        std::vector<uint8> linear, srgb;
+        CHECK(DecompressImage(pair[0], blocks.data(), width, height, linear));
+        CHECK(DecompressImage(pair[1], blocks.data(), width, height, srgb));
+        CHECK(linear == srgb);
+    }
+}
+
+static void TestFlatColors() {
+    // A 5x3 image is one whole and one partial block wide
+    const uint32 width = 5, height = 3;
+    std::vector<uint8> image(width * height * 4), decoded;
+    for(const FormatExpectation& expected : EXPECTATIONS) {
+        int32 worst = 0;
+        for(int32 r = 0; r < 256; r += 15) {
+            for(int32 g = 0; g < 256; g += 17) {
+                for(int32 b = 0; b < 256; b += 51) {
+                    for(size_t i = 0; i < image.size(); i += 4) {
+                        image[i] = (uint8)r;
+                        image[i + 1] = (uint8)g;
+                        image[i + 2] = (uint8)b;
+                        image[i + 3] = (uint8)((r + g) / 2);
+                    }
+                    std::vector<uint8> blocks = CompressImage(expected.format, image.data(), width, height);
+                    CHECK(DecompressImage(expected.format, blocks.data(), width, height, decoded));
+                    for(size_t i = 0; i < image.size(); i++) {
+                        if(i % 4 != 3 || expected.minAlphaPSNR > 0.0) {
+                            worst = std::max(worst, std::abs((int32)image[i] - (int32)decoded[i]));
+                        }
+                    }
+                }
+            }
+        }
+        if(worst > expected.maxFlatError) {
+            fprintf(stderr, "%s: flat colours off by %d\n", GetTextureFormatInfo(expected.format).name, worst);
+        }
+        CHECK(worst <= expected.maxFlatError);
+    }
+}
+
+static void TestUndecodableBC7() {
+    // Only mode 6 is decoded, an all-zero block has no mode bit at all
+    std::vector<uint8> blocks(16 * 4, 0), decoded;
+    CHECK(!DecompressImage(TEXTURE_FORMAT_BC7, blocks.data(), 8, 8, decoded));
+
+    uint8 texels[64];
+    uint8 block[16] = {};
+    block[0] = 1 << 5;   // mode 5
+    CHECK(!DecodeBC7Block(block, texels));
+    block[0] = 1 << 6;
+    CHECK(DecodeBC7Block(block, texels));
+}
+
+int main() {
+    TestRoundTrip();
+    TestSrgbFormats();
+    TestFlatColors();
+    TestUndecodableBC7();
+    return FinishTests("TextureCompressionTests");
+}
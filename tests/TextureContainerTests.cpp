@@ -0,0 +1,141 @@
+// ParseTextureContainer on containers built in memory: a valid chain, then
+// each way a file can be damaged or from another version.
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include "Test.h"
+#include "TextureContainer.h"
+
+// A container laid out like TextureCooker writes it, with the full mip
+// chain of width x height
+static std::vector<uint8> BuildContainer(TextureContainerFormat format, uint32 width, uint32 height) {
+    std::vector<TextureContainerMip> mips;
+    for(uint32 w = width, h = height;; w = w > 1 ? w / 2 : 1, h = h > 1 ? h / 2 : 1) {
+        mips.push_back({ w, h, 0, GetTextureLevelSize(format, w, h) });
+        if(w == 1 && h == 1) {
+            break;
+        }
+    }
+
+    TextureContainerHeader header = { TEXTURE_CONTAINER_MAGIC, TEXTURE_CONTAINER_VERSION, format, width, height,
+                                      (uint32)mips.size() };
+    uint64 offset = sizeof(header) + mips.size() * sizeof(TextureContainerMip);
+    for(TextureContainerMip& mip : mips) {
+        offset = (offset + TEXTURE_CONTAINER_ALIGNMENT - 1) / TEXTURE_CONTAINER_ALIGNMENT * TEXTURE_CONTAINER_ALIGNMENT;
+        mip.offset = offset;
+        offset += mip.size;
+    }
+
+    std::vector<uint8> data((size_t)offset, 0xAB);
+    memcpy(data.data(), &header, sizeof(header));
+    memcpy(data.data() + sizeof(header), mips.data(), mips.size() * sizeof(TextureContainerMip));
+    return data;
+}
+
+static TextureContainerHeader& GetHeader(std::vector<uint8>& data) {
+    return *(TextureContainerHeader *)data.data();
+}
+
+static TextureContainerMip& GetMip(std::vector<uint8>& data, uint32 level) {
+    return ((TextureContainerMip *)(data.data() + sizeof(TextureContainerHeader)))[level];
+}
+
+// Parses data, expecting a failure whose reason contains text
+static bool FailsWith(const std::vector<uint8>& data, const char *text) {
+    TextureContainerView view;
+    std::string error;
+    return !ParseTextureContainer(data.data(), data.size(), view, error) && error.find(text) != std::string::npos;
+}
+
+static void TestValid() {
+    std::vector<uint8> data = BuildContainer(TEXTURE_FORMAT_BC1, 16, 4);
+    TextureContainerView view;
+    std::string error;
+    CHECK(ParseTextureContainer(data.data(), data.size(), view, error));
+    CHECK(view.format == TEXTURE_FORMAT_BC1);
+    CHECK(view.header == (const TextureContainerHeader *)data.data());
+    CHECK(view.header->mipCount == 5);
+    CHECK(view.mips[0].width == 16 && view.mips[0].height == 4);
+    CHECK(view.mips[2].width == 4 && view.mips[2].height == 1);
+    CHECK(view.mips[4].width == 1 && view.mips[4].height == 1);
+    // Partial blocks are padded to whole ones
+    CHECK(view.mips[4].size == 8);
+    CHECK(view.mips[4].offset % TEXTURE_CONTAINER_ALIGNMENT == 0);
+
+    // A single level is fine, for --no-mips
+    data = BuildContainer(TEXTURE_FORMAT_RGB8, 3, 3);
+    GetHeader(data).mipCount = 1;
+    CHECK(ParseTextureContainer(data.data(), data.size(), view, error));
+    CHECK(view.header->mipCount == 1);
+}
+
+static void TestBadHeader() {
+    std::vector<uint8> valid = BuildContainer(TEXTURE_FORMAT_RGBA8, 8, 8);
+    std::vector<uint8> data;
+
+    CHECK(FailsWith(std::vector<uint8>(valid.begin(), valid.begin() + sizeof(TextureContainerHeader) - 1), "not a cooked texture"));
+    CHECK(FailsWith(std::vector<uint8>(), "not a cooked texture"));
+
+    data = valid;
+    GetHeader(data).magic = 0x474E5089;
+    CHECK(FailsWith(data, "not a cooked texture"));
+
+    data = valid;
+    GetHeader(data).version = TEXTURE_CONTAINER_VERSION + 1;
+    CHECK(FailsWith(data, "old version"));
+
+    data = valid;
+    GetHeader(data).format = TEXTURE_FORMAT_COUNT;
+    CHECK(FailsWith(data, "not a cooked texture"));
+
+    data = valid;
+    GetHeader(data).mipCount = 0;
+    CHECK(FailsWith(data, "mip table"));
+    GetHeader(data).mipCount = 33;
+    CHECK(FailsWith(data, "mip table"));
+
+    // The table runs past the end of the file
+    data = valid;
+    data.resize(sizeof(TextureContainerHeader) + 2 * sizeof(TextureContainerMip));
+    CHECK(FailsWith(data, "mip table"));
+}
+
+static void TestBadLevels() {
+    std::vector<uint8> valid = BuildContainer(TEXTURE_FORMAT_RGBA8, 8, 8);
+    std::vector<uint8> data;
+
+    // Level data cut off
+    data = valid;
+    data.pop_back();
+    CHECK(FailsWith(data, "truncated mip level 3"));
+
+    data = valid;
+    GetMip(data, 1).size -= 1;
+    CHECK(FailsWith(data, "truncated mip level 1"));
+
+    data = valid;
+    GetMip(data, 2).offset = data.size() + 16;
+    CHECK(FailsWith(data, "truncated mip level 2"));
+
+    // An offset + size that wraps around
+    data = valid;
+    GetMip(data, 1).offset = 16;
+    GetMip(data, 1).size = ~(uint64)0;
+    CHECK(FailsWith(data, "truncated mip level 1"));
+
+    // Level sizes that don't halve
+    data = valid;
+    GetMip(data, 1).width = 8;
+    CHECK(FailsWith(data, "mip level 1 is not half"));
+    data = valid;
+    GetHeader(data).height = 16;
+    CHECK(FailsWith(data, "mip level 0 is not half"));
+}
+
+int main() {
+    TestValid();
+    TestBadHeader();
+    TestBadLevels();
+    return FinishTests("TextureContainerTests");
+}
@@ -0,0 +1,185 @@
+// TextureLoader against the stub GL, with small TGA files in a temporary
+// directory: the placeholder, uploaded mip chains, the per-frame budget and
+// failed decodes.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "Test.h"
+#include "StubGL.h"
+#include "Texture.h"
+#include "TextureLoader.h"
+
+static std::string directory;
+
+// Uncompressed TGA, rows top to bottom, RGB or RGBA
+static std::string WriteTGA(const char *name, uint32 width, uint32 height, uint32 channels, const std::vector<uint8>& pixels) {
+    std::string path = directory + "/" + name;
+    uint8 header[18] = {};
+    header[2] = 2;
+    header[12] = (uint8)width;
+    header[13] = (uint8)(width >> 8);
+    header[14] = (uint8)height;
+    header[15] = (uint8)(height >> 8);
+    header[16] = (uint8)(channels * 8);
+    header[17] = (uint8)(0x20 | (channels == 4 ? 8 : 0));
+
+    FILE *file = fopen(path.c_str(), "wb");
+    CHECK(file != nullptr);
+    if(file) {
+        fwrite(header, 1, sizeof(header), file);
+        for(size_t i = 0; i < pixels.size(); i += channels) {
+            uint8 bgra[4] = { pixels[i + 2], pixels[i + 1], pixels[i], channels == 4 ? pixels[i + 3] : (uint8)0 };
+            fwrite(bgra, 1, channels, file);
+        }
+        fclose(file);
+    }
+    return path;
+}
+
+// Distinct values per texel, RGB or RGBA
+static std::vector<uint8> MakePixels(uint32 width, uint32 height, uint32 channels) {
+    std::vector<uint8> pixels(width * height * channels);
+    for(size_t i = 0; i < pixels.size(); i++) {
+        pixels[i] = (uint8)(i * 7 + 3);
+    }
+    return pixels;
+}
+
+// Runs Update until nothing is pending or a few seconds passed, returns the
+// textures uploaded and the most uploaded by one call
+static uint32 UpdateUntilDone(TextureLoader& loader, uint32& mostPerUpdate) {
+    uint32 ready = 0;
+    mostPerUpdate = 0;
+    for(uint32 i = 0; i < 500 && loader.GetPendingCount() > 0; i++) {
+        uint32 count = loader.Update();
+        ready += count;
+        mostPerUpdate = std::max(mostPerUpdate, count);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return ready;
+}
+
+static void TestLoad() {
+    InstallStubGL();
+    std::vector<uint8> pixels = MakePixels(4, 2, 3);
+    std::string path = WriteTGA("rgb.tga", 4, 2, 3, pixels);
+
+    Texture texture;
+    texture.fileName = &path[0];
+    texture.mipFilter = MIP_FILTER_BOX;
+
+    TextureLoader loader(1);
+    loader.Load(&texture, false);
+    CHECK(loader.GetPendingCount() == 1);
+    CHECK(texture.textureID != 0);
+    CHECK(!texture.ready);
+
+    // Until the upload the texture is the 1x1 placeholder, without mips
+    std::vector<StubTextureLevel>& levels = GetStubGL().textures[texture.textureID];
+    CHECK(levels.size() == 1);
+    CHECK(levels[0].width == 1 && levels[0].height == 1);
+    CHECK(GetStubGL().textureParameters[texture.textureID][GL_TEXTURE_MAX_LEVEL] == 0);
+
+    uint32 mostPerUpdate;
+    CHECK(UpdateUntilDone(loader, mostPerUpdate) == 1);
+    CHECK(texture.ready);
+    CHECK(loader.failedLoads == 0);
+
+    // 4x2, 2x1 and 1x1, flipped so the last row comes first
+    CHECK(levels.size() == 3);
+    CHECK(GetStubGL().textureParameters[texture.textureID][GL_TEXTURE_MAX_LEVEL] == 2);
+    CHECK(levels[0].width == 4 && levels[0].height == 2);
+    CHECK(levels[0].internalFormat == GL_RGB8);
+    CHECK(std::vector<uint8>(levels[0].pixels.begin(), levels[0].pixels.begin() + 12) ==
+          std::vector<uint8>(pixels.begin() + 12, pixels.end()));
+    CHECK(std::vector<uint8>(levels[0].pixels.begin() + 12, levels[0].pixels.end()) ==
+          std::vector<uint8>(pixels.begin(), pixels.begin() + 12));
+    CHECK(levels[1].width == 2 && levels[1].height == 1);
+    CHECK(levels[2].width == 1 && levels[2].height == 1);
+    CHECK(loader.uploadedBytes == 24 + 6 + 3);
+}
+
+static void TestAlphaAndSrgb() {
+    InstallStubGL();
+    std::string path = WriteTGA("rgba.tga", 2, 2, 4, MakePixels(2, 2, 4));
+
+    Texture texture;
+    texture.fileName = &path[0];
+    texture.srgb = true;
+
+    TextureLoader loader(1);
+    loader.Load(&texture, true);
+    uint32 mostPerUpdate;
+    CHECK(UpdateUntilDone(loader, mostPerUpdate) == 1);
+
+    const std::vector<StubTextureLevel>& levels = GetStubGL().textures[texture.textureID];
+    CHECK(levels.size() == 2);
+    CHECK(levels[0].internalFormat == GL_SRGB8_ALPHA8);
+    CHECK(levels[0].pixels.size() == 16);
+}
+
+static void TestBudget() {
+    InstallStubGL();
+    std::string path = WriteTGA("budget.tga", 8, 8, 3, MakePixels(8, 8, 3));
+
+    // A one byte budget still uploads one texture per Update
+    const uint32 count = 4;
+    std::unique_ptr<Texture[]> textures(new Texture[count]);
+    TextureLoader loader(2, 1);
+    for(uint32 i = 0; i < count; i++) {
+        textures[i].fileName = &path[0];
+        loader.Load(&textures[i], false);
+    }
+    CHECK(loader.GetPendingCount() == count);
+
+    uint32 mostPerUpdate;
+    CHECK(UpdateUntilDone(loader, mostPerUpdate) == count);
+    CHECK(mostPerUpdate == 1);
+    for(uint32 i = 0; i < count; i++) {
+        CHECK(textures[i].ready);
+    }
+}
+
+static void TestFailure() {
+    InstallStubGL();
+    std::string path = directory + "/missing.tga";
+
+    Texture texture;
+    texture.fileName = &path[0];
+    TextureLoader loader(1);
+    loader.Load(&texture, false);
+
+    // Reported and counted, the texture keeps its placeholder
+    uint32 mostPerUpdate;
+    CHECK(UpdateUntilDone(loader, mostPerUpdate) == 0);
+    CHECK(loader.GetPendingCount() == 0);
+    CHECK(loader.failedLoads == 1);
+    CHECK(!texture.ready);
+    CHECK(GetStubGL().textures[texture.textureID].size() == 1);
+}
+
+int main() {
+    char root[] = "/tmp/TextureLoaderTests.XXXXXX";
+    if(!mkdtemp(root)) {
+        perror(root);
+        return 1;
+    }
+    directory = root;
+
+    TestLoad();
+    TestAlphaAndSrgb();
+    TestBudget();
+    TestFailure();
+
+    for(const char *file : { "rgb.tga", "rgba.tga", "budget.tga" }) {
+        remove((directory + "/" + file).c_str());
+    }
+    rmdir(root);
+    return FinishTests("TextureLoaderTests");
+}
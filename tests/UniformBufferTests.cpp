@@ -0,0 +1,89 @@
+// UniformBufferRing against the stub GL, with and without a persistent
+// mapping: aligned sub-allocation, overflow accounting and the per-frame
+// fences.
+
+#include <cstring>
+#include "Test.h"
+#include "StubGL.h"
+#include "UniformBuffer.h"
+
+static PerObjectData GetObjectData(float value) {
+    PerObjectData data;
+    data.model = GetTranslationMatrix(value, 0.0f, 0.0f);
+    data.modelViewProjection = GetScaleMatrix(value, value, value);
+    return data;
+}
+
+static void TestPush(bool bufferStorage) {
+    InstallStubGL(bufferStorage ? 4 : 3, bufferStorage ? 4 : 3);
+    CHECK(GLEXT_ARB_buffer_storage == (bufferStorage ? 1 : 0));
+
+    {
+        // Rounded up to the stub's 256 byte offset alignment
+        UniformBufferRing ring(1000, 3);
+        ring.BeginFrame();
+
+        for(uint32 i=0; i<4; ++i) {
+            PerObjectData data = GetObjectData((float)i);
+            UniformBufferRange range = ring.Push(data);
+            CHECK(range.buffer != 0);
+            CHECK(range.offset % 256 == 0);
+            CHECK(range.size == sizeof(PerObjectData));
+            CHECK(memcmp(&GetStubGL().buffers[range.buffer][range.offset], &data, sizeof(data)) == 0);
+
+            UniformBufferRing::Bind(PER_OBJECT_BLOCK_BINDING, range);
+            CHECK(GetStubGL().lastRangeOffset == range.offset);
+        }
+        CHECK(ring.pushedBytes == 4 * sizeof(PerObjectData));
+        CHECK(ring.overflows == 0);
+
+        // The segment is full: the push is dropped, counted, and its range
+        // is not bound
+        uint32 boundOffset = GetStubGL().lastRangeOffset;
+        UniformBufferRange range = ring.Push(GetObjectData(4.0f));
+        CHECK(range.buffer == 0);
+        CHECK(ring.overflows == 1);
+        CHECK(ring.pushedBytes == 4 * sizeof(PerObjectData));
+        GetStubGL().lastRangeOffset = boundOffset + 1;
+        UniformBufferRing::Bind(PER_OBJECT_BLOCK_BINDING, range);
+        CHECK(GetStubGL().lastRangeOffset == boundOffset + 1);
+
+        // The next frame starts a fresh segment
+        ring.EndFrame();
+        ring.BeginFrame();
+        CHECK(ring.Push(GetObjectData(5.0f)).buffer != 0);
+        ring.EndFrame();
+    }
+    CHECK(GetStubGL().liveFences == 0);
+    CHECK(GetStubGL().buffers.empty());
+}
+
+static void TestFences() {
+    InstallStubGL(4, 4);
+    {
+        UniformBufferRing ring(256, 3);
+        uint32 segments[6];
+        for(uint32 frame=0; frame<6; ++frame) {
+            ring.BeginFrame();
+            segments[frame] = ring.Push(GetObjectData((float)frame)).offset / 256;
+            ring.EndFrame();
+        }
+
+        // Segments cycle, and only reusing one waits for its fence
+        for(uint32 frame=3; frame<6; ++frame) {
+            CHECK(segments[frame] == segments[frame - 3]);
+        }
+        CHECK(segments[0] != segments[1] && segments[1] != segments[2] && segments[0] != segments[2]);
+        CHECK(GetStubGL().fences == 6);
+        CHECK(GetStubGL().fenceWaits == 3);
+        CHECK(GetStubGL().liveFences == 3);
+    }
+    CHECK(GetStubGL().liveFences == 0);
+}
+
+int main() {
+    TestPush(false);
+    TestPush(true);
+    TestFences();
+    return FinishTests("UniformBufferTests");
+}
@@ -0,0 +1,557 @@
+// Offline shader pass run by the ShaderReflection build target.
+//
+// ShaderReflect <output dir> [-I include dir]... shaders...
+//   Preprocesses every shader and generates ShaderReflection.h with the
+//   attribute and output locations, uniform and block names, block binding
+//   points and std140 block layouts, so the engine can use constants instead
+//   of querying them at runtime. The header is only rewritten when it
+//   changes.
+//
+// ShaderReflect --validate <glslangValidator> <output dir> [-I include dir]... shaders...
+//   Expands every combination of the ShaderVariantCache features a shader
+//   tests into <output dir>/shaders/<name>[.<feature mask>] and runs
+//   glslangValidator on each of them.
+//
+// The declaration parser is deliberately small: it reads top-level
+// in/out/uniform declarations and uniform blocks of scalars, vectors,
+// square matrices and arrays of those. Declarations inside #if sections are
+// all reported. Blocks without layout(binding = N) get the lowest free
+// binding points in the order they are first declared.
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+#include "ShaderPreprocessor.h"
+#include "ShaderVariantCache.h"
+
+struct Declaration {
+    std::string storage;   // in, out or uniform
+    std::string type;
+    std::string name;
+    int32 location;        // -1 without layout(location = N)
+    uint32 arraySize;      // 0 for non-arrays
+};
+
+struct BlockMember {
+    std::string type;
+    std::string name;
+    uint32 offset;
+    uint32 arraySize;
+};
+
+struct Block {
+    std::string name;
+    std::string source;    // first shader that declared it
+    std::vector<BlockMember> members;
+    uint32 size;
+    int32 binding;         // -1 without layout(binding = N) until one is assigned
+};
+
+static bool errors = false;
+
+static std::vector<std::string> Tokenize(const std::string& source) {
+    std::vector<std::string> tokens;
+    size_t i = 0;
+    while(i < source.size()) {
+        char c = source[i];
+        if(c == '/' && i + 1 < source.size() && source[i + 1] == '/') {
+            i = source.find('\n', i);
+        } else if(c == '/' && i + 1 < source.size() && source[i + 1] == '*') {
+            i = source.find("*/", i + 2);
+            i = i == std::string::npos ? i : i + 2;
+        } else if(c == '#') {
+            // Directives left by the preprocessor: #version, #define, #line, #if...
+            i = source.find('\n', i);
+        } else if(isalnum((unsigned char)c) || c == '_' || c == '.') {
+            size_t start = i;
+            while(i < source.size() && (isalnum((unsigned char)source[i]) || source[i] == '_' || source[i] == '.')) {
+                i++;
+            }
+            tokens.push_back(source.substr(start, i - start));
+        } else {
+            if(!isspace((unsigned char)c)) {
+                tokens.push_back(std::string(1, c));
+            }
+            i++;
+        }
+    }
+
+    return tokens;
+}
+
+// std140 base alignment and size of a non-array member, false if unsupported
+static bool GetStd140Layout(const std::string& type, uint32& alignment, uint32& size) {
+    static const char *SCALARS[] = { "float", "int", "uint", "bool" };
+    for(const char *scalar : SCALARS) {
+        if(type == scalar) {
+            alignment = size = 4;
+            return true;
+        }
+    }
+
+    // vecN, ivecN, uvecN, bvecN
+    size_t vec = type.find("vec");
+    if(vec != std::string::npos && vec <= 1 && type.size() == vec + 4) {
+        uint32 components = type[vec + 3] - '0';
+        if(components < 2 || components > 4) {
+            return false;
+        }
+        size = 4 * components;
+        alignment = components == 2 ? 8 : 16;
+        return true;
+    }
+
+    // Square matrices: N vec4-aligned columns (or rows with row_major)
+    if(type == "mat2" || type == "mat3" || type == "mat4") {
+        alignment = 16;
+        size = 16 * (type[3] - '0');
+        return true;
+    }
+
+    return false;
+}
+
+static uint32 AlignUp(uint32 value, uint32 alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+// Parses "name", "name[N]" from tokens[i], advancing i
+static bool ParseName(const std::vector<std::string>& tokens, size_t& i, std::string& name, uint32& arraySize) {
+    if(i >= tokens.size()) {
+        return false;
+    }
+    name = tokens[i++];
+    arraySize = 0;
+    if(i + 2 < tokens.size() && tokens[i] == "[" && tokens[i + 2] == "]") {
+        arraySize = (uint32)std::stoul(tokens[i + 1]);
+        i += 3;
+    }
+    return true;
+}
+
+// Reads an optional layout(...) qualifier into key/value pairs
+static std::map<std::string, std::string> ParseLayout(const std::vector<std::string>& tokens, size_t& i) {
+    std::map<std::string, std::string> layout;
+    if(i >= tokens.size() || tokens[i] != "layout") {
+        return layout;
+    }
+
+    i += 2;   // layout (
+    while(i < tokens.size() && tokens[i] != ")") {
+        std::string key = tokens[i++];
+        if(i + 1 < tokens.size() && tokens[i] == "=") {
+            layout[key] = tokens[i + 1];
+            i += 2;
+        } else {
+            layout[key] = "";
+        }
+        if(i < tokens.size() && tokens[i] == ",") {
+            i++;
+        }
+    }
+    i++;
+
+    return layout;
+}
+
+static bool IsQualifier(const std::string& token) {
+    static const char *QUALIFIERS[] = { "flat", "smooth", "noperspective", "centroid", "invariant",
+                                        "highp", "mediump", "lowp" };
+    for(const char *qualifier : QUALIFIERS) {
+        if(token == qualifier) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void ParseDeclaration(const std::vector<std::string>& statement, std::vector<Declaration>& declarations) {
+    size_t i = 0;
+    std::map<std::string, std::string> layout = ParseLayout(statement, i);
+
+    std::string storage;
+    while(i < statement.size()) {
+        if(statement[i] == "in" || statement[i] == "out" || statement[i] == "uniform") {
+            storage = statement[i++];
+        } else if(IsQualifier(statement[i])) {
+            i++;
+        } else {
+            break;
+        }
+    }
+    if(storage.empty() || i >= statement.size()) {
+        return;
+    }
+
+    Declaration declaration;
+    declaration.storage = storage;
+    declaration.type = statement[i++];
+    declaration.location = layout.count("location") ? std::stoi(layout["location"]) : -1;
+    while(ParseName(statement, i, declaration.name, declaration.arraySize)) {
+        declarations.push_back(declaration);
+        if(i >= statement.size() || statement[i] != ",") {
+            break;
+        }
+        i++;
+    }
+}
+
+// statement holds the tokens before the opening brace at tokens[i]
+static bool ParseBlock(const std::string& path, const std::vector<std::string>& statement, const std::vector<std::string>& tokens,
+                       size_t& i, Block& block) {
+    const std::string& name = statement.back();
+    size_t layoutStart = 0;
+    std::map<std::string, std::string> layout = ParseLayout(statement, layoutStart);
+    block.name = name;
+    block.source = path;
+    block.size = 0;
+    block.binding = layout.count("binding") ? std::stoi(layout["binding"]) : -1;
+
+    i++;
+    while(i < tokens.size() && tokens[i] != "}") {
+        size_t memberStart = i;
+        while(i < tokens.size() && IsQualifier(tokens[i])) {
+            i++;
+        }
+        if(i < tokens.size() && tokens[i] == "layout") {
+            ParseLayout(tokens, i);   // row_major/column_major don't change square matrix sizes
+        }
+        if(i >= tokens.size()) {
+            break;
+        }
+
+        BlockMember member;
+        member.type = tokens[i++];
+        uint32 baseAlignment, baseSize;
+        if(!GetStd140Layout(member.type, baseAlignment, baseSize)) {
+            fprintf(stderr, "%s: block %s: unsupported member type %s\n", path.c_str(), name.c_str(), member.type.c_str());
+            return false;
+        }
+
+        while(ParseName(tokens, i, member.name, member.arraySize)) {
+            uint32 alignment = baseAlignment, size = baseSize;
+            if(member.arraySize > 0) {
+                // Array elements are padded to vec4
+                alignment = 16;
+                size = AlignUp(baseSize, 16) * member.arraySize;
+            }
+            member.offset = AlignUp(block.size, alignment);
+            block.size = member.offset + size;
+            block.members.push_back(member);
+
+            if(i >= tokens.size() || tokens[i] != ",") {
+                break;
+            }
+            i++;
+        }
+        if(i >= tokens.size() || tokens[i] != ";" || i == memberStart) {
+            fprintf(stderr, "%s: block %s: can't parse member %s\n", path.c_str(), name.c_str(), tokens[memberStart].c_str());
+            return false;
+        }
+        i++;
+    }
+    if(i >= tokens.size()) {
+        fprintf(stderr, "%s: block %s is not closed\n", path.c_str(), name.c_str());
+        return false;
+    }
+    block.size = AlignUp(block.size, 16);
+
+    // Skip the optional instance name up to the semicolon
+    while(i < tokens.size() && tokens[i] != ";") {
+        i++;
+    }
+    return true;
+}
+
+static void SkipBraces(const std::vector<std::string>& tokens, size_t& i) {
+    uint32 depth = 0;
+    for(; i < tokens.size(); i++) {
+        if(tokens[i] == "{") {
+            depth++;
+        } else if(tokens[i] == "}" && --depth == 0) {
+            return;
+        }
+    }
+}
+
+static void Parse(const std::string& path, const std::string& source, std::vector<Declaration>& declarations,
+                  std::vector<Block>& blocks) {
+    std::vector<std::string> tokens = Tokenize(source);
+    std::vector<std::string> statement;
+
+    for(size_t i = 0; i < tokens.size(); i++) {
+        if(tokens[i] == "{") {
+            bool isBlock = false;
+            for(const std::string& token : statement) {
+                isBlock = isBlock || token == "uniform";
+            }
+
+            if(isBlock) {
+                Block block;
+                if(!ParseBlock(path, statement, tokens, i, block)) {
+                    errors = true;
+                    return;
+                }
+                blocks.push_back(block);
+            } else {
+                // Function bodies and struct definitions
+                SkipBraces(tokens, i);
+            }
+            statement.clear();
+        } else if(tokens[i] == ";") {
+            ParseDeclaration(statement, declarations);
+            statement.clear();
+        } else {
+            statement.push_back(tokens[i]);
+        }
+    }
+}
+
+// viewProjection -> VIEW_PROJECTION, gSampler -> G_SAMPLER. The header adds
+// the kind: VIEW_PROJECTION_OFFSET, G_SAMPLER_UNIFORM, PER_FRAME_BLOCK.
+static std::string ToConstantName(const std::string& name) {
+    std::string result;
+    for(size_t i = 0; i < name.size(); i++) {
+        char c = name[i];
+        if(isupper((unsigned char)c) && i > 0 && !isupper((unsigned char)name[i - 1]) && name[i - 1] != '_') {
+            result += '_';
+        }
+        result += (char)toupper((unsigned char)c);
+    }
+    return result;
+}
+
+// shaders/shader.vs -> shader_vs
+static std::string ToNamespace(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+    for(char& c : name) {
+        if(!isalnum((unsigned char)c)) {
+            c = '_';
+        }
+    }
+    return name;
+}
+
+static bool SameLayout(const Block& a, const Block& b) {
+    if(a.size != b.size || a.members.size() != b.members.size()) {
+        return false;
+    }
+    if(a.binding >= 0 && b.binding >= 0 && a.binding != b.binding) {
+        return false;
+    }
+    for(size_t i = 0; i < a.members.size(); i++) {
+        if(a.members[i].name != b.members[i].name || a.members[i].offset != b.members[i].offset) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static std::string FileName(const std::string& path) {
+    return path.substr(path.find_last_of('/') + 1);
+}
+
+// Whether source mentions name as a whole identifier, #ifdef lines included
+static bool MentionsIdentifier(const std::string& source, const std::string& name) {
+    for(size_t i = source.find(name); i != std::string::npos; i = source.find(name, i + 1)) {
+        bool startsWord = i == 0 || !(isalnum((unsigned char)source[i - 1]) || source[i - 1] == '_');
+        size_t end = i + name.size();
+        bool endsWord = end == source.size() || !(isalnum((unsigned char)source[end]) || source[end] == '_');
+        if(startsWord && endsWord) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Runs glslangValidator on every feature combination the shader tests
+static bool Validate(ShaderPreprocessor& preprocessor, const std::string& validator, const std::string& outputDirectory,
+                     const std::string& path) {
+    PreprocessedShader shader;
+    if(!preprocessor.Preprocess(path, "", shader)) {
+        return false;
+    }
+
+    ShaderFeatures used = 0;
+    for(uint32 i = 0; i < SHADER_FEATURE_COUNT; i++) {
+        if(MentionsIdentifier(shader.source, ShaderVariantCache::GetFeatureName(i))) {
+            used |= 1u << i;
+        }
+    }
+
+    bool isVertex = path.size() > 3 && path.compare(path.size() - 3, 3, ".vs") == 0;
+    bool success = true;
+    // Walks the subsets of used, the empty one last
+    ShaderFeatures features = used;
+    do {
+        std::string defines = ShaderVariantCache::GetFeatureDefines(features);
+        if(!preprocessor.Preprocess(path, defines, shader)) {
+            return false;
+        }
+
+        std::string expandedPath = outputDirectory + "/shaders/" + FileName(path);
+        if(features != 0) {
+            expandedPath += "." + std::to_string(features);
+        }
+        std::ofstream(expandedPath) << shader.source;
+
+        std::string command = "\"" + validator + "\" -S " + (isVertex ? "vert" : "frag") + " \"" + expandedPath + "\"";
+        if(system(command.c_str()) != 0) {
+            fprintf(stderr, "%s: fails to validate with\n%s", path.c_str(), defines.empty() ? "no features\n" : defines.c_str());
+            success = false;
+        }
+
+        features = (features - 1) & used;
+    } while(features != used);
+
+    return success;
+}
+
+int main(int argc, char *argv[]) {
+    int first = 1;
+    std::string validator;
+    if(argc > 2 && std::string(argv[1]) == "--validate") {
+        validator = argv[2];
+        first = 3;
+    }
+    if(argc < first + 2) {
+        fprintf(stderr, "Usage: %s [--validate <glslangValidator>] <output dir> [-I include dir]... shaders...\n", argv[0]);
+        return 1;
+    }
+
+    std::string outputDirectory = argv[first];
+    ShaderPreprocessor preprocessor;
+    std::vector<std::string> shaders;
+    for(int i = first + 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if(arg == "-I" && i + 1 < argc) {
+            preprocessor.AddIncludePath(argv[++i]);
+        } else {
+            shaders.push_back(arg);
+        }
+    }
+
+    if(!validator.empty()) {
+        for(const std::string& path : shaders) {
+            errors = !Validate(preprocessor, validator, outputDirectory, path) || errors;
+        }
+        return errors ? 1 : 0;
+    }
+
+    std::string header;
+    header += "// Generated by ShaderReflect from the shaders/ directory, do not edit\n";
+    header += "#ifndef INC_3DENGINE_SHADERREFLECTION_H\n";
+    header += "#define INC_3DENGINE_SHADERREFLECTION_H\n\n";
+    header += "#include \"Types.h\"\n\n";
+    header += "namespace ShaderReflection {\n";
+
+    std::vector<Block> allBlocks;
+    for(const std::string& path : shaders) {
+        PreprocessedShader shader;
+        if(!preprocessor.Preprocess(path, "", shader)) {
+            errors = true;
+            continue;
+        }
+
+        std::vector<Declaration> declarations;
+        std::vector<Block> blocks;
+        Parse(path, shader.source, declarations, blocks);
+
+        bool isVertex = path.size() > 3 && path.compare(path.size() - 3, 3, ".vs") == 0;
+        header += "\n// " + FileName(path) + "\n";
+        header += "namespace " + ToNamespace(path) + " {\n";
+        for(const Declaration& declaration : declarations) {
+            std::string constant = ToConstantName(declaration.name);
+            if(declaration.storage == "uniform") {
+                header += "    const char * const " + constant + "_UNIFORM = \"" + declaration.name + "\";\n";
+            } else if(declaration.location >= 0 && (declaration.storage == "in") == isVertex) {
+                // Vertex attributes and fragment outputs, the interface between stages has no fixed numbers
+                const char *kind = declaration.storage == "in" ? "_ATTRIBUTE" : "_OUTPUT";
+                header += "    const uint32 " + constant + kind + " = " + std::to_string(declaration.location) + ";\n";
+            }
+        }
+        for(const Block& block : blocks) {
+            header += "    const char * const " + ToConstantName(block.name) + "_BLOCK = \"" + block.name + "\";\n";
+        }
+        header += "}\n";
+
+        for(const Block& block : blocks) {
+            bool found = false;
+            for(Block& existing : allBlocks) {
+                if(existing.name != block.name) {
+                    continue;
+                }
+                found = true;
+                if(!SameLayout(existing, block)) {
+                    fprintf(stderr, "%s: block %s has a different layout than in %s\n", path.c_str(),
+                            block.name.c_str(), existing.source.c_str());
+                    errors = true;
+                }
+                existing.binding = existing.binding >= 0 ? existing.binding : block.binding;
+            }
+            if(!found) {
+                allBlocks.push_back(block);
+            }
+        }
+    }
+
+    if(errors) {
+        return 1;
+    }
+
+    // Blocks without an explicit binding take the lowest free ones, in order
+    for(Block& block : allBlocks) {
+        for(int32 binding = 0; block.binding < 0; binding++) {
+            bool taken = false;
+            for(const Block& other : allBlocks) {
+                taken = taken || other.binding == binding;
+            }
+            block.binding = taken ? -1 : binding;
+        }
+    }
+
+    header += "\n// std140 uniform blocks, identical in every shader that declares them\n";
+    for(const Block& block : allBlocks) {
+        header += "namespace " + block.name + " {\n";
+        header += "    const char * const NAME = \"" + block.name + "\";\n";
+        header += "    const uint32 BINDING = " + std::to_string(block.binding) + ";\n";
+        header += "    const uint32 SIZE = " + std::to_string(block.size) + ";\n";
+        for(const BlockMember& member : block.members) {
+            header += "    const uint32 " + ToConstantName(member.name) + "_OFFSET = " + std::to_string(member.offset) + ";\n";
+        }
+        header += "}\n";
+    }
+
+    // Every block with its binding point, for Shader::BindUniformBlocks
+    header += "\nstruct UniformBlock {\n    const char *name;\n    uint32 binding;\n};\n";
+    header += "const uint32 UNIFORM_BLOCK_COUNT = " + std::to_string(allBlocks.size()) + ";\n";
+    header += "const UniformBlock UNIFORM_BLOCKS[] = {\n";
+    for(const Block& block : allBlocks) {
+        header += "    { " + block.name + "::NAME, " + block.name + "::BINDING },\n";
+    }
+    if(allBlocks.empty()) {
+        header += "    { nullptr, 0 },\n";
+    }
+    header += "};\n";
+    header += "\n}\n\n#endif //INC_3DENGINE_SHADERREFLECTION_H\n";
+
+    // Only touch the header when it changes so the engine doesn't rebuild,
+    // the build tracks this step with its own stamp
+    std::string headerPath = outputDirectory + "/ShaderReflection.h";
+    std::string previous;
+    std::ifstream previousFile(headerPath);
+    if(previousFile) {
+        previous.assign(std::istreambuf_iterator<char>(previousFile), std::istreambuf_iterator<char>());
+    }
+    if(previous != header) {
+        std::ofstream(headerPath) << header;
+    }
+
+    return 0;
+}
@@ -0,0 +1,230 @@
+// Converts source images (PNG, JPEG, TGA... anything stb_image reads) into
+// the cooked container of TextureContainer.h with the full mip chain
+// precomputed, so the engine loads them with a memory mapping and no
+// decoding or glGenerateMipmap at runtime.
+//
+// Usage: TextureCooker [--srgb] [--alpha | --no-alpha] [--no-mips] [--filter box|kaiser]
+//                       [--format rgb|bc1|bc3|bc7|etc2] input output
+//        TextureCooker --benchmark inputs...
+//
+// --format picks the storage per texture: rgb keeps RGB8/RGBA8, the others
+// block compress every level on the CPU (see TextureCompression.h). With
+// --srgb the sRGB variant of the format is written. --benchmark encodes
+// each input in every compressed format and prints speed, size and PSNR.
+// Mips come from MipGenerator, in linear space with --srgb, with the Kaiser
+// filter unless --filter box is given.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "stb_image.h"
+#include "MipGenerator.h"
+#include "TextureCompression.h"
+#include "TextureContainer.h"
+
+static uint64 AlignOffset(uint64 offset) {
+    return (offset + TEXTURE_CONTAINER_ALIGNMENT - 1) / TEXTURE_CONTAINER_ALIGNMENT * TEXTURE_CONTAINER_ALIGNMENT;
+}
+
+static bool WriteContainer(const std::string& path, TextureContainerFormat format, const std::vector<MipLevel>& levels) {
+    TextureContainerHeader header = { TEXTURE_CONTAINER_MAGIC, TEXTURE_CONTAINER_VERSION, format,
+                                      levels[0].width, levels[0].height, (uint32)levels.size() };
+
+    std::vector<TextureContainerMip> mips;
+    uint64 offset = AlignOffset(sizeof(header) + sizeof(TextureContainerMip) * levels.size());
+    for(const MipLevel& level : levels) {
+        TextureContainerMip mip = { level.width, level.height, offset, level.pixels.size() };
+        mips.push_back(mip);
+        offset = AlignOffset(offset + mip.size);
+    }
+
+    FILE *file = fopen(path.c_str(), "wb");
+    if(!file) {
+        perror(path.c_str());
+        return false;
+    }
+
+    static const uint8 PADDING[TEXTURE_CONTAINER_ALIGNMENT] = {};
+    bool success = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   fwrite(mips.data(), sizeof(TextureContainerMip), mips.size(), file) == mips.size();
+    uint64 written = sizeof(header) + sizeof(TextureContainerMip) * mips.size();
+    for(size_t i = 0; i < levels.size() && success; i++) {
+        success = fwrite(PADDING, 1, mips[i].offset - written, file) == mips[i].offset - written &&
+                  fwrite(levels[i].pixels.data(), 1, mips[i].size, file) == mips[i].size;
+        written = mips[i].offset + mips[i].size;
+    }
+
+    if(fclose(file) != 0 || !success) {
+        fprintf(stderr, "%s: write failed\n", path.c_str());
+        remove(path.c_str());
+        return false;
+    }
+    return true;
+}
+
+static const TextureContainerFormat COMPRESSED_FORMATS[] = {
+    TEXTURE_FORMAT_BC1, TEXTURE_FORMAT_BC3, TEXTURE_FORMAT_BC7, TEXTURE_FORMAT_ETC2_RGB8,
+};
+
+// Linear format for a --format name, TEXTURE_FORMAT_COUNT if unknown
+static TextureContainerFormat ParseFormat(const char *name) {
+    if(strcmp(name, "rgb") == 0) {
+        return TEXTURE_FORMAT_RGB8;
+    }
+    for(TextureContainerFormat format : COMPRESSED_FORMATS) {
+        if(strcmp(name, GetTextureFormatInfo(format).name) == 0) {
+            return format;
+        }
+    }
+    return TEXTURE_FORMAT_COUNT;
+}
+
+// Peak signal to noise ratio over the first `channels` channels of two RGBA images
+static double GetPSNR(const std::vector<uint8>& a, const std::vector<uint8>& b, uint32 channels) {
+    double error = 0.0;
+    size_t count = 0;
+    for(size_t i = 0; i < a.size(); i += 4) {
+        for(uint32 c = 0; c < channels; c++, count++) {
+            double d = (double)a[i + c] - b[i + c];
+            error += d * d;
+        }
+    }
+    if(error == 0.0) {
+        return INFINITY;
+    }
+    return 10.0 * log10(255.0 * 255.0 / (error / count));
+}
+
+static int Benchmark(const std::vector<std::string>& paths) {
+    printf("%-32s %-6s %10s %8s %8s %8s\n", "texture", "format", "encode ms", "bpp", "rgb dB", "a dB");
+    for(const std::string& path : paths) {
+        int32 width, height, channels;
+        uint8 *data = stbi_load(path.c_str(), &width, &height, &channels, 4);
+        if(!data) {
+            fprintf(stderr, "%s: %s\n", path.c_str(), stbi_failure_reason());
+            return 1;
+        }
+        std::vector<uint8> source(data, data + (size_t)width * height * 4);
+        stbi_image_free(data);
+
+        for(TextureContainerFormat format : COMPRESSED_FORMATS) {
+            auto start = std::chrono::steady_clock::now();
+            std::vector<uint8> blocks = CompressImage(format, source.data(), (uint32)width, (uint32)height);
+            double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            std::vector<uint8> decoded;
+            DecompressImage(format, blocks.data(), (uint32)width, (uint32)height, decoded);
+            std::vector<uint8> alphaSource(source.size()), alphaDecoded(source.size());
+            for(size_t i = 0; i < source.size(); i += 4) {
+                alphaSource[i] = source[i + 3];
+                alphaDecoded[i] = decoded[i + 3];
+            }
+            printf("%-32s %-6s %10.2f %8.2f %8.2f ", path.c_str(), GetTextureFormatInfo(format).name, milliseconds,
+                   blocks.size() * 8.0 / ((double)width * height), GetPSNR(source, decoded, 3));
+            // The 8 byte formats don't store alpha
+            if(GetTextureFormatInfo(format).blockBytes == 8) {
+                printf("%8s\n", "-");
+            } else {
+                printf("%8.2f\n", GetPSNR(alphaSource, alphaDecoded, 1));
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    bool srgb = false, mips = true, benchmark = false;
+    int alpha = -1;   // -1 keeps the source's alpha channel if it has one
+    TextureContainerFormat storage = TEXTURE_FORMAT_RGB8;
+    MipFilter filter = MIP_FILTER_KAISER;
+    std::vector<std::string> paths;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--srgb") == 0) {
+            srgb = true;
+        } else if(strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+            storage = ParseFormat(argv[++i]);
+            if(storage == TEXTURE_FORMAT_COUNT) {
+                fprintf(stderr, "Unknown format %s\n", argv[i]);
+                return 1;
+            }
+        } else if(strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            i++;
+            if(strcmp(argv[i], "box") == 0) {
+                filter = MIP_FILTER_BOX;
+            } else if(strcmp(argv[i], "kaiser") == 0) {
+                filter = MIP_FILTER_KAISER;
+            } else {
+                fprintf(stderr, "Unknown filter %s\n", argv[i]);
+                return 1;
+            }
+        } else if(strcmp(argv[i], "--benchmark") == 0) {
+            benchmark = true;
+        } else if(strcmp(argv[i], "--alpha") == 0) {
+            alpha = 1;
+        } else if(strcmp(argv[i], "--no-alpha") == 0) {
+            alpha = 0;
+        } else if(strcmp(argv[i], "--no-mips") == 0) {
+            mips = false;
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+    if(benchmark && !paths.empty()) {
+        return Benchmark(paths);
+    }
+    if(paths.size() != 2) {
+        fprintf(stderr, "Usage: %s [--srgb] [--alpha | --no-alpha] [--no-mips] [--filter box|kaiser] "
+                        "[--format rgb|bc1|bc3|bc7|etc2] input output\n       %s --benchmark inputs...\n", argv[0], argv[0]);
+        return 1;
+    }
+
+    int32 width, height, sourceChannels;
+    if(!stbi_info(paths[0].c_str(), &width, &height, &sourceChannels)) {
+        fprintf(stderr, "%s: %s\n", paths[0].c_str(), stbi_failure_reason());
+        return 1;
+    }
+    bool hasAlpha = alpha < 0 ? sourceChannels == 2 || sourceChannels == 4 : alpha == 1;
+    bool compressed = GetTextureFormatInfo(storage).blockBytes != 0;
+    if(storage == TEXTURE_FORMAT_ETC2_RGB8 && hasAlpha) {
+        fprintf(stderr, "%s: etc2 has no alpha, use --no-alpha or another format\n", paths[0].c_str());
+        return 1;
+    }
+    if(storage == TEXTURE_FORMAT_BC1 && hasAlpha) {
+        fprintf(stderr, "%s: warning: bc1 drops the alpha channel\n", paths[0].c_str());
+    }
+
+    // Same orientation as Texture::LoadTexture
+    stbi_set_flip_vertically_on_load(true);
+    // The block encoders always take RGBA
+    uint32 channels = hasAlpha || compressed ? 4 : 3;
+    uint8 *data = stbi_load(paths[0].c_str(), &width, &height, &sourceChannels, (int)channels);
+    if(!data) {
+        fprintf(stderr, "%s: %s\n", paths[0].c_str(), stbi_failure_reason());
+        return 1;
+    }
+    std::vector<MipLevel> levels = GenerateMipChain(data, (uint32)width, (uint32)height, channels, srgb, filter);
+    stbi_image_free(data);
+    if(!mips) {
+        levels.resize(1);
+    }
+
+    TextureContainerFormat format = hasAlpha ? (srgb ? TEXTURE_FORMAT_SRGB8_ALPHA8 : TEXTURE_FORMAT_RGBA8)
+                                             : (srgb ? TEXTURE_FORMAT_SRGB8 : TEXTURE_FORMAT_RGB8);
+    if(compressed) {
+        // Each compressed format is followed by its sRGB variant
+        format = (TextureContainerFormat)(storage + (srgb ? 1 : 0));
+        for(MipLevel& level : levels) {
+            level.pixels = CompressImage(format, level.pixels.data(), level.width, level.height);
+        }
+    }
+    if(!WriteContainer(paths[1], format, levels)) {
+        return 1;
+    }
+
+    printf("%s: %ux%u %s, %zu levels\n", paths[1].c_str(), levels[0].width, levels[0].height,
+           GetTextureFormatInfo(format).name, levels.size());
+    return 0;
+}